@@ -561,32 +561,39 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 	idToken token;
 	idLexer *src;
 	unsigned int crc;
+	const void *buffer;
+	int length;
 
 	// load it
 	fileName = name;
 	fileName.SetFileExtension( CM_FILE_EXT );
-	src = new idLexer( fileName );
-	src->SetFlags( LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
-	if ( !src->IsLoaded() ) {
-		delete src;
+	length = fileSystem->MapFile( fileName, &buffer );
+	if ( length < 0 ) {
 		return false;
 	}
 
+	// parse straight from the mapped file
+	src = new idLexer( LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
+	src->LoadMemory( (const char *)buffer, length, fileName );
+
 	if ( !src->ExpectTokenString( CM_FILEID ) ) {
 		common->Warning( "%s is not an CM file.", fileName.c_str() );
 		delete src;
+		fileSystem->UnmapFile( buffer );
 		return false;
 	}
 
 	if ( !src->ReadToken( &token ) || token != CM_FILEVERSION ) {
 		common->Warning( "%s has version %s instead of %s", fileName.c_str(), token.c_str(), CM_FILEVERSION );
 		delete src;
+		fileSystem->UnmapFile( buffer );
 		return false;
 	}
 
 	if ( !src->ExpectTokenType( TT_NUMBER, TT_INTEGER, &token ) ) {
 		common->Warning( "%s has no map file CRC", fileName.c_str() );
 		delete src;
+		fileSystem->UnmapFile( buffer );
 		return false;
 	}
 
@@ -594,6 +601,7 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 	if ( mapFileCRC && crc != mapFileCRC ) {
 		common->Printf( "%s is out of date\n", fileName.c_str() );
 		delete src;
+		fileSystem->UnmapFile( buffer );
 		return false;
 	}
 
@@ -606,6 +614,7 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 		if ( token == "collisionModel" ) {
 			if ( !ParseCollisionModel( src ) ) {
 				delete src;
+				fileSystem->UnmapFile( buffer );
 				return false;
 			}
 			continue;
@@ -615,6 +624,7 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 	}
 
 	delete src;
+	fileSystem->UnmapFile( buffer );
 
 	return true;
 }
@@ -2450,6 +2450,8 @@ idCommonLocal::Frame
 */
 void idCommonLocal::Frame( void ) {
 	try {
+		frameProfiler->BeginFrame();
+		idProfileScope profile( "Frame" );
 
 		// pump all the events
 		Sys_GenerateEvents();
@@ -3078,6 +3080,11 @@ void idCommonLocal::Init( int argc, char **argv ) {
 		// init commands
 		InitCommands();
 
+		// start the worker threads for parallel jobs
+		parallelJobManager->Init();
+
+		frameProfiler->Init();
+
 #ifdef ID_WRITE_VERSION
 		config_compressor = idCompressor::AllocArithmetic();
 #endif
@@ -3136,6 +3143,11 @@ void idCommonLocal::Shutdown( void ) {
 	// game specific shut down
 	ShutdownGame( false );
 
+	// stop the parallel job worker threads
+	parallelJobManager->Shutdown();
+
+	frameProfiler->Shutdown();
+
 	// shut down non-portable system services
 	Sys_Shutdown();
 
@@ -295,6 +295,12 @@ typedef struct searchpath_s {
 	struct searchpath_s *next;
 } searchpath_t;
 
+typedef struct {
+	const void *		buffer;
+	int					length;
+	bool				mapped;						// false if read with ReadFile
+} mappedFile_t;
+
 // search flags when opening a file
 #define FSFLAG_SEARCH_DIRS		( 1 << 0 )
 #define FSFLAG_SEARCH_PAKS		( 1 << 1 )
@@ -350,6 +356,8 @@ public:
 	virtual	void			ClearPureChecksums( void );
 	virtual int				ReadFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp );
 	virtual void			FreeFile( void *buffer );
+	virtual int				MapFile( const char *relativePath, const void **buffer, ID_TIME_T *timestamp );
+	virtual void			UnmapFile( const void *buffer );
 	virtual int				WriteFile( const char *relativePath, const void *buffer, int size, const char *basePath = "fs_savepath" );
 	virtual void			RemoveFile( const char *relativePath );
 	virtual idFile *		OpenFileReadFlags( const char *relativePath, int searchFlags, pack_t **foundInPak = NULL, bool allowCopyFiles = true, const char* gamedir = NULL );
@@ -391,6 +399,7 @@ private:
 	int						readCount;			// total bytes read
 	int						loadCount;			// total files read
 	int						loadStack;			// total files in memory
+	idList<mappedFile_t>	mappedFiles;		// views returned by MapFile
 	idStr					gameFolder;			// this will be a single name without separators
 
 	searchpath_t			*addonPaks;			// not loaded up, but we saw them
@@ -409,6 +418,7 @@ private:
 	static idCVar			fs_game_base;
 	static idCVar			fs_caseSensitiveOS;
 	static idCVar			fs_searchAddons;
+	static idCVar			fs_mapFiles;
 
 	backgroundDownload_t *	backgroundDownloads;
 	backgroundDownload_t	defaultBackgroundDownload;
@@ -476,6 +486,7 @@ idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "0", CVAR_SY
 idCVar	idFileSystemLocal::fs_caseSensitiveOS( "fs_caseSensitiveOS", "1", CVAR_SYSTEM | CVAR_BOOL, "" );
 #endif
 idCVar	idFileSystemLocal::fs_searchAddons( "fs_searchAddons", "0", CVAR_SYSTEM | CVAR_BOOL, "search all addon pk4s ( disables addon functionality )" );
+idCVar	idFileSystemLocal::fs_mapFiles( "fs_mapFiles", "1", CVAR_SYSTEM | CVAR_BOOL, "memory map files read with MapFile instead of copying them into the heap" );
 
 idFileSystemLocal	fileSystemLocal;
 idFileSystem *		fileSystem = &fileSystemLocal;
@@ -1134,6 +1145,102 @@ void idFileSystemLocal::FreeFile( void *buffer ) {
 	Mem_Free( buffer );
 }
 
+/*
+============
+idFileSystemLocal::MapFile
+
+Files in the directory tree are mapped read-only, which doesn't copy them
+and lets the OS drop the pages again under memory pressure.  Files in pak
+archives are compressed or at least not page aligned, so they are read
+into a buffer with ReadFile instead.
+============
+*/
+int idFileSystemLocal::MapFile( const char *relativePath, const void **buffer, ID_TIME_T *timestamp ) {
+	mappedFile_t	mapping;
+	idFile *		f;
+	void *			buf;
+	int				len;
+
+	*buffer = NULL;
+
+	if ( timestamp ) {
+		*timestamp = FILE_NOT_FOUND_TIMESTAMP;
+	}
+
+	if ( fs_mapFiles.GetBool() ) {
+		f = OpenFileRead( relativePath, false );
+		if ( f == NULL ) {
+			return -1;
+		}
+
+		idFile_Permanent *file = dynamic_cast<idFile_Permanent *>( f );
+		if ( file != NULL ) {
+			len = file->Length();
+			mapping.buffer = Sys_MapFile( file->GetFilePtr(), len );
+			if ( mapping.buffer != NULL ) {
+				if ( timestamp ) {
+					*timestamp = file->Timestamp();
+				}
+				CloseFile( f );
+
+				loadCount++;
+				loadStack++;
+
+				mapping.length = len;
+				mapping.mapped = true;
+				mappedFiles.Append( mapping );
+
+				*buffer = mapping.buffer;
+				return len;
+			}
+		}
+		CloseFile( f );
+	}
+
+	len = ReadFile( relativePath, &buf, timestamp );
+	if ( len < 0 ) {
+		return -1;
+	}
+
+	mapping.buffer = buf;
+	mapping.length = len;
+	mapping.mapped = false;
+	mappedFiles.Append( mapping );
+
+	*buffer = buf;
+	return len;
+}
+
+/*
+============
+idFileSystemLocal::UnmapFile
+============
+*/
+void idFileSystemLocal::UnmapFile( const void *buffer ) {
+	int i;
+
+	if ( !buffer ) {
+		common->FatalError( "idFileSystemLocal::UnmapFile( NULL )" );
+	}
+
+	for ( i = 0; i < mappedFiles.Num(); i++ ) {
+		if ( mappedFiles[i].buffer == buffer ) {
+			break;
+		}
+	}
+	if ( i == mappedFiles.Num() ) {
+		common->FatalError( "idFileSystemLocal::UnmapFile: buffer was not returned by MapFile" );
+	}
+
+	if ( mappedFiles[i].mapped ) {
+		Sys_UnmapFile( buffer, mappedFiles[i].length );
+		loadStack--;
+	} else {
+		FreeFile( const_cast<void *>( buffer ) );
+	}
+	mappedFiles.RemoveIndex( i );
+}
+
 /*
 ============
 idFileSystemLocal::WriteFile
@@ -220,6 +220,14 @@ public:
 	virtual int				ReadFile( const char *relativePath, void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
 							// Frees the memory allocated by ReadFile.
 	virtual void			FreeFile( void *buffer ) = 0;
+							// Maps a complete file read-only into memory without copying it.
+							// Returns the length of the file, or -1 on failure.
+							// Files in pak archives are read into a buffer instead.
+							// Like ReadFile there is always a 0 byte after the end of the file.
+							// The view must not be written and stays valid until UnmapFile.
+	virtual int				MapFile( const char *relativePath, const void **buffer, ID_TIME_T *timestamp = NULL ) = 0;
+							// Releases a view returned by MapFile.
+	virtual void			UnmapFile( const void *buffer ) = 0;
 							// Writes a complete file, will create any needed subdirectories.
 							// Returns the length of the file, or -1 on failure.
 	virtual int				WriteFile( const char *relativePath, const void *buffer, int size, const char *basePath = "fs_savepath" ) = 0;
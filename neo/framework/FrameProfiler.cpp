@@ -0,0 +1,250 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+#include <chrono>
+
+idCVar com_profileFrames( "com_profileFrames", "0", CVAR_SYSTEM | CVAR_BOOL, "record hierarchical frame timings, write them out with profileDump" );
+
+/*
+===============================================================================
+
+	idFrameProfilerLocal
+
+===============================================================================
+*/
+
+typedef struct {
+	const char *			name;
+	int64_t					start;			// microseconds
+	int						duration;		// microseconds
+	int						frameNum;
+	short					threadNum;
+	short					depth;
+} profileSample_t;
+
+class idFrameProfilerLocal : public idFrameProfiler {
+public:
+							idFrameProfilerLocal( void );
+
+	virtual void			Init( void );
+	virtual void			Shutdown( void );
+	virtual void			BeginFrame( void );
+	virtual int64_t			BeginScope( void );
+	virtual void			EndScope( const char *name, int64_t startMicroseconds );
+	virtual int64_t			Microseconds( void ) const;
+
+	void					WriteChromeTrace( const char *fileName );
+
+private:
+	profileSample_t *		samples;
+	std::atomic<unsigned int>	nextSample;
+	std::atomic<int>		numThreads;
+	int						frameNum;
+
+	int						GetThreadNum( void );
+
+	static void				ProfileDump_f( const idCmdArgs &args );
+};
+
+idFrameProfilerLocal	frameProfilerLocal;
+idFrameProfiler *		frameProfiler = &frameProfilerLocal;
+
+// depth of the open scopes and trace thread number of the calling thread
+static thread_local int	profileDepth = 0;
+static thread_local int	profileThreadNum = -1;
+
+/*
+================
+idFrameProfilerLocal::idFrameProfilerLocal
+================
+*/
+idFrameProfilerLocal::idFrameProfilerLocal( void ) :
+	samples( NULL ),
+	nextSample( 0 ),
+	numThreads( 1 ),
+	frameNum( 0 ) {
+	recording = false;
+}
+
+/*
+================
+idFrameProfilerLocal::Init
+================
+*/
+void idFrameProfilerLocal::Init( void ) {
+	samples = (profileSample_t *)Mem_ClearedAlloc( MAX_PROFILE_SAMPLES * sizeof( samples[0] ) );
+	nextSample = 0;
+	frameNum = 0;
+	recording = false;
+
+	cmdSystem->AddCommand( "profileDump", ProfileDump_f, CMD_FL_SYSTEM, "writes the frames recorded with com_profileFrames to a Chrome trace file" );
+}
+
+/*
+================
+idFrameProfilerLocal::Shutdown
+================
+*/
+void idFrameProfilerLocal::Shutdown( void ) {
+	recording = false;
+	Mem_Free( samples );
+	samples = NULL;
+}
+
+/*
+================
+idFrameProfilerLocal::BeginFrame
+
+The recording state only changes here, so a frame is always recorded completely.
+================
+*/
+void idFrameProfilerLocal::BeginFrame( void ) {
+	frameNum++;
+	recording = ( samples != NULL && com_profileFrames.GetBool() );
+}
+
+/*
+================
+idFrameProfilerLocal::Microseconds
+================
+*/
+int64_t idFrameProfilerLocal::Microseconds( void ) const {
+	return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+/*
+================
+idFrameProfilerLocal::GetThreadNum
+
+The main thread is always 0, other threads are numbered in the order they record their first sample.
+================
+*/
+int idFrameProfilerLocal::GetThreadNum( void ) {
+	if ( profileThreadNum < 0 ) {
+		profileThreadNum = Sys_IsMainThread() ? 0 : numThreads.fetch_add( 1 );
+	}
+	return profileThreadNum;
+}
+
+/*
+================
+idFrameProfilerLocal::BeginScope
+================
+*/
+int64_t idFrameProfilerLocal::BeginScope( void ) {
+	profileDepth++;
+	return Microseconds();
+}
+
+/*
+================
+idFrameProfilerLocal::EndScope
+================
+*/
+void idFrameProfilerLocal::EndScope( const char *name, int64_t startMicroseconds ) {
+	int64_t end = Microseconds();
+
+	profileDepth--;
+
+	// the oldest samples are overwritten
+	unsigned int index = nextSample.fetch_add( 1 ) & ( MAX_PROFILE_SAMPLES - 1 );
+	profileSample_t &sample = samples[index];
+	sample.name = name;
+	sample.start = startMicroseconds;
+	sample.duration = (int)( end - startMicroseconds );
+	sample.frameNum = frameNum;
+	sample.threadNum = GetThreadNum();
+	sample.depth = profileDepth;
+}
+
+/*
+================
+idFrameProfilerLocal::WriteChromeTrace
+
+Writes the samples in the Chrome trace event format, the nesting of the
+scopes is reconstructed by the viewer from the start times and durations.
+================
+*/
+void idFrameProfilerLocal::WriteChromeTrace( const char *fileName ) {
+	unsigned int last = nextSample.load();
+	unsigned int first = ( last > MAX_PROFILE_SAMPLES ) ? last - MAX_PROFILE_SAMPLES : 0;
+
+	if ( first == last ) {
+		common->Printf( "no frames recorded, set com_profileFrames 1 first\n" );
+		return;
+	}
+
+	idFile *f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		common->Warning( "couldn't open %s", fileName );
+		return;
+	}
+
+	// make the times relative to the oldest sample to keep the numbers short
+	int64_t base = samples[first & ( MAX_PROFILE_SAMPLES - 1 )].start;
+	for ( unsigned int i = first; i < last; i++ ) {
+		base = Min( base, samples[i & ( MAX_PROFILE_SAMPLES - 1 )].start );
+	}
+
+	f->Printf( "{\"traceEvents\":[\n" );
+	f->Printf( "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"main\"}}" );
+	for ( int i = 1; i < numThreads.load(); i++ ) {
+		f->Printf( ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"worker %d\"}}", i, i );
+	}
+	for ( unsigned int i = first; i < last; i++ ) {
+		const profileSample_t &sample = samples[i & ( MAX_PROFILE_SAMPLES - 1 )];
+		f->Printf( ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%lld,\"dur\":%d,\"args\":{\"frame\":%d,\"depth\":%d}}",
+			sample.name, sample.threadNum, (long long)( sample.start - base ), sample.duration, sample.frameNum, sample.depth );
+	}
+	f->Printf( "\n],\"displayTimeUnit\":\"ms\"}\n" );
+
+	common->Printf( "wrote %u samples to %s\n", last - first, f->GetFullPath() );
+
+	fileSystem->CloseFile( f );
+}
+
+/*
+================
+idFrameProfilerLocal::ProfileDump_f
+================
+*/
+void idFrameProfilerLocal::ProfileDump_f( const idCmdArgs &args ) {
+	idStr fileName;
+
+	if ( args.Argc() > 1 ) {
+		fileName = args.Argv( 1 );
+	} else {
+		fileName = "profile";
+	}
+	fileName.SetFileExtension( ".json" );
+
+	frameProfilerLocal.WriteChromeTrace( fileName );
+}
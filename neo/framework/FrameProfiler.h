@@ -0,0 +1,100 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __FRAMEPROFILER_H__
+#define __FRAMEPROFILER_H__
+
+/*
+===============================================================================
+
+	Frame profiler
+
+	Records the start and duration of named scopes into a ring buffer while
+	com_profileFrames is set.  Scopes may nest and may be opened on any
+	thread, so the samples of parallel jobs show up next to the main thread.
+	The "profileDump" command writes the recorded samples as a Chrome trace
+	(chrome://tracing or ui.perfetto.dev).
+
+	A scope is recorded by putting an idProfileScope on the stack:
+
+		idProfileScope profile( "R_AddModelSurfaces" );
+
+	The name must be a string literal or otherwise outlive the samples.
+
+===============================================================================
+*/
+
+static const int		MAX_PROFILE_SAMPLES			= 1 << 16;
+
+class idFrameProfiler {
+public:
+	virtual					~idFrameProfiler( void ) {}
+
+	virtual void			Init( void ) = 0;
+	virtual void			Shutdown( void ) = 0;
+
+							// starts a new frame, called at the start of idCommon::Frame
+	virtual void			BeginFrame( void ) = 0;
+
+							// used by idProfileScope
+	virtual int64_t			BeginScope( void ) = 0;
+	virtual void			EndScope( const char *name, int64_t startMicroseconds ) = 0;
+
+							// steady clock the scopes are timed with, also used by the benchmark commands
+	virtual int64_t			Microseconds( void ) const = 0;
+
+	bool					IsRecording( void ) const { return recording; }
+
+protected:
+	bool					recording;
+};
+
+extern idFrameProfiler *	frameProfiler;
+
+class idProfileScope {
+public:
+							idProfileScope( const char *name ) {
+								if ( frameProfiler->IsRecording() ) {
+									this->name = name;
+									startMicroseconds = frameProfiler->BeginScope();
+								} else {
+									this->name = NULL;
+								}
+							}
+							~idProfileScope( void ) {
+								if ( name ) {
+									frameProfiler->EndScope( name, startMicroseconds );
+								}
+							}
+
+private:
+	const char *			name;
+	int64_t					startMicroseconds;
+};
+
+#endif /* !__FRAMEPROFILER_H__ */
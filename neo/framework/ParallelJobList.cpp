@@ -0,0 +1,340 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+#include <mutex>
+#include <condition_variable>
+
+idCVar com_numJobThreads( "com_numJobThreads", "-1", CVAR_SYSTEM | CVAR_INTEGER | CVAR_ARCHIVE, "number of worker threads for parallel jobs, -1 = number of cores minus one, 0 = run all jobs on the main thread, requires restart", -1, MAX_JOB_THREADS );
+
+/*
+===============================================================================
+
+	idParallelJobList
+
+===============================================================================
+*/
+
+/*
+================
+idParallelJobList::idParallelJobList
+================
+*/
+idParallelJobList::idParallelJobList( const char *name ) :
+	name( name ),
+	submitted( false ),
+	nextJob( 0 ),
+	doneJobs( 0 ),
+	numWorkers( 0 ) {
+	jobs.SetGranularity( 64 );
+}
+
+/*
+================
+idParallelJobList::~idParallelJobList
+================
+*/
+idParallelJobList::~idParallelJobList( void ) {
+	assert( !submitted );
+}
+
+/*
+================
+idParallelJobList::AddJob
+================
+*/
+void idParallelJobList::AddJob( jobRun_t function, void *data ) {
+	assert( !submitted );
+	job_t &job = jobs.Alloc();
+	job.function = function;
+	job.data = data;
+}
+
+/*
+================
+idParallelJobList::Submit
+================
+*/
+void idParallelJobList::Submit( void ) {
+	assert( !submitted );
+	submitted = true;
+	nextJob = 0;
+	doneJobs = 0;
+	if ( jobs.Num() > 1 ) {
+		parallelJobManager->Submit( this );
+	}
+}
+
+/*
+================
+idParallelJobList::RunNextJob
+================
+*/
+bool idParallelJobList::RunNextJob( void ) {
+	int index = nextJob.fetch_add( 1 );
+	if ( index >= jobs.Num() ) {
+		return false;
+	}
+	idProfileScope profile( name );
+	jobs[index].function( jobs[index].data );
+	doneJobs.fetch_add( 1 );
+	return true;
+}
+
+/*
+================
+idParallelJobList::Wait
+================
+*/
+void idParallelJobList::Wait( void ) {
+	if ( !submitted ) {
+		return;
+	}
+
+	// help out with the jobs nobody picked up yet
+	while ( RunNextJob() ) {
+	}
+
+	// wait for the jobs still running on the workers
+	while ( doneJobs.load() < jobs.Num() ) {
+		std::this_thread::yield();
+	}
+
+	if ( jobs.Num() > 1 ) {
+		parallelJobManager->Retire( this );
+	}
+
+	jobs.SetNum( 0, false );
+	submitted = false;
+}
+
+/*
+================
+idParallelJobList::Run
+================
+*/
+void idParallelJobList::Run( void ) {
+	Submit();
+	Wait();
+}
+
+/*
+===============================================================================
+
+	idParallelJobManagerLocal
+
+===============================================================================
+*/
+
+class idParallelJobManagerLocal : public idParallelJobManager {
+public:
+							idParallelJobManagerLocal( void );
+							~idParallelJobManagerLocal( void );
+
+	virtual void			Init( void );
+	virtual void			Shutdown( void );
+	virtual int				GetNumWorkers( void ) const { return numThreads; }
+	virtual void			Submit( idParallelJobList *list );
+	virtual void			Retire( idParallelJobList *list );
+
+private:
+	std::thread				threads[MAX_JOB_THREADS];
+	int						numThreads;
+
+	std::mutex				mutex;
+	std::condition_variable	wakeUp;
+	bool					quit;
+	idParallelJobList *		activeLists[MAX_ACTIVE_JOBLISTS];
+	int						numActiveLists;
+
+	idParallelJobList *		FindWork( void );
+	void					WorkerLoop( void );
+	static void				WorkerThread( idParallelJobManagerLocal *manager );
+};
+
+idParallelJobManagerLocal	parallelJobManagerLocal;
+idParallelJobManager *		parallelJobManager = &parallelJobManagerLocal;
+
+/*
+================
+idParallelJobManagerLocal::idParallelJobManagerLocal
+================
+*/
+idParallelJobManagerLocal::idParallelJobManagerLocal( void ) {
+	numThreads = 0;
+	quit = false;
+	numActiveLists = 0;
+}
+
+/*
+================
+idParallelJobManagerLocal::~idParallelJobManagerLocal
+
+Exiting through an error doesn't call Shutdown(), and destroying
+a running std::thread would terminate the process.
+================
+*/
+idParallelJobManagerLocal::~idParallelJobManagerLocal( void ) {
+	for ( int i = 0; i < numThreads; i++ ) {
+		threads[i].detach();
+	}
+}
+
+/*
+================
+idParallelJobManagerLocal::Init
+================
+*/
+void idParallelJobManagerLocal::Init( void ) {
+	int num = com_numJobThreads.GetInteger();
+	if ( num < 0 ) {
+		num = (int)std::thread::hardware_concurrency() - 1;
+	}
+	num = idMath::ClampInt( 0, MAX_JOB_THREADS, num );
+
+	quit = false;
+	numActiveLists = 0;
+	for ( numThreads = 0; numThreads < num; numThreads++ ) {
+		threads[numThreads] = std::thread( WorkerThread, this );
+	}
+
+	common->Printf( "%d parallel job worker threads\n", numThreads );
+}
+
+/*
+================
+idParallelJobManagerLocal::Shutdown
+================
+*/
+void idParallelJobManagerLocal::Shutdown( void ) {
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		quit = true;
+	}
+	wakeUp.notify_all();
+
+	for ( int i = 0; i < numThreads; i++ ) {
+		threads[i].join();
+	}
+	numThreads = 0;
+}
+
+/*
+================
+idParallelJobManagerLocal::Submit
+================
+*/
+void idParallelJobManagerLocal::Submit( idParallelJobList *list ) {
+	if ( numThreads == 0 ) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		if ( numActiveLists >= MAX_ACTIVE_JOBLISTS ) {
+			// the list will simply be executed by the thread waiting on it
+			return;
+		}
+		activeLists[numActiveLists++] = list;
+	}
+	wakeUp.notify_all();
+}
+
+/*
+================
+idParallelJobManagerLocal::Retire
+
+All jobs of the list are done, make sure no worker still references it.
+================
+*/
+void idParallelJobManagerLocal::Retire( idParallelJobList *list ) {
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		for ( int i = 0; i < numActiveLists; i++ ) {
+			if ( activeLists[i] == list ) {
+				activeLists[i] = activeLists[--numActiveLists];
+				break;
+			}
+		}
+	}
+	while ( list->numWorkers.load() > 0 ) {
+		std::this_thread::yield();
+	}
+}
+
+/*
+================
+idParallelJobManagerLocal::FindWork
+
+The mutex must be held.
+================
+*/
+idParallelJobList *idParallelJobManagerLocal::FindWork( void ) {
+	for ( int i = 0; i < numActiveLists; i++ ) {
+		if ( activeLists[i]->HasJobsLeft() ) {
+			return activeLists[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+================
+idParallelJobManagerLocal::WorkerLoop
+================
+*/
+void idParallelJobManagerLocal::WorkerLoop( void ) {
+	while ( 1 ) {
+		idParallelJobList *list;
+		{
+			std::unique_lock<std::mutex> lock( mutex );
+			while ( !quit && ( list = FindWork() ) == NULL ) {
+				wakeUp.wait( lock );
+			}
+			if ( quit ) {
+				return;
+			}
+			list->numWorkers.fetch_add( 1 );
+		}
+
+		while ( list->RunNextJob() ) {
+		}
+
+		list->numWorkers.fetch_sub( 1 );
+	}
+}
+
+/*
+================
+idParallelJobManagerLocal::WorkerThread
+================
+*/
+void idParallelJobManagerLocal::WorkerThread( idParallelJobManagerLocal *manager ) {
+	manager->WorkerLoop();
+}
@@ -0,0 +1,108 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __PARALLELJOBLIST_H__
+#define __PARALLELJOBLIST_H__
+
+/*
+===============================================================================
+
+	Parallel jobs
+
+	A job list is filled on the main thread, submitted to the worker threads
+	and then waited on. While waiting, the calling thread executes any jobs
+	that have not been picked up by a worker yet, so a list always completes,
+	even when no worker threads are running.
+
+	Jobs of a list can run in any order, on any thread and concurrently with
+	each other. A job must only write data that no other job of the list
+	touches, and it must not allocate from the idHeap, use idStr, print, raise
+	errors or call into the game. Everything a job needs should be allocated
+	before the list is submitted.
+
+===============================================================================
+*/
+
+static const int		MAX_JOB_THREADS				= 8;
+static const int		MAX_ACTIVE_JOBLISTS			= 16;
+
+typedef void ( *jobRun_t )( void *data );
+
+class idParallelJobList {
+	friend class idParallelJobManagerLocal;
+public:
+							idParallelJobList( const char *name );
+							~idParallelJobList( void );
+
+	void					AddJob( jobRun_t function, void *data );
+							// hands the jobs to the worker threads, the list may not be changed until Wait() returns
+	void					Submit( void );
+							// executes the jobs not picked up by a worker and returns when all jobs are done, then clears the list
+	void					Wait( void );
+							// Submit() and Wait() in one go
+	void					Run( void );
+
+	int						NumJobs( void ) const { return jobs.Num(); }
+	bool					IsSubmitted( void ) const { return submitted; }
+	const char *			GetName( void ) const { return name; }
+
+private:
+	typedef struct {
+		jobRun_t			function;
+		void *				data;
+	} job_t;
+
+	const char *			name;
+	idList<job_t>			jobs;
+	bool					submitted;
+	std::atomic<int>		nextJob;		// index of the next job to hand out
+	std::atomic<int>		doneJobs;		// number of completed jobs
+	std::atomic<int>		numWorkers;		// worker threads currently executing jobs of this list
+
+	bool					HasJobsLeft( void ) const { return nextJob.load() < jobs.Num(); }
+	bool					RunNextJob( void );
+};
+
+class idParallelJobManager {
+public:
+	virtual					~idParallelJobManager( void ) {}
+
+	virtual void			Init( void ) = 0;
+	virtual void			Shutdown( void ) = 0;
+
+							// number of worker threads, the main thread is not included
+	virtual int				GetNumWorkers( void ) const = 0;
+
+							// used by idParallelJobList
+	virtual void			Submit( idParallelJobList *list ) = 0;
+	virtual void			Retire( idParallelJobList *list ) = 0;
+};
+
+extern idParallelJobManager *	parallelJobManager;
+
+#endif /* !__PARALLELJOBLIST_H__ */
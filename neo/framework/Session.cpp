@@ -46,6 +46,7 @@ idCVar	idSessionLocal::com_aviDemoHeight( "com_aviDemoHeight", "256", CVAR_SYSTE
 idCVar	idSessionLocal::com_aviDemoTics( "com_aviDemoTics", "2", CVAR_SYSTEM | CVAR_INTEGER, "", 1, 60 );
 idCVar	idSessionLocal::com_wipeSeconds( "com_wipeSeconds", "1", CVAR_SYSTEM, "" );
 idCVar	idSessionLocal::com_guid( "com_guid", "", CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_ROM, "" );
+idCVar	idSessionLocal::com_showLoadTimes( "com_showLoadTimes", "0", CVAR_SYSTEM | CVAR_BOOL, "print how long each phase of a map load took" );
 
 idCVar	idSessionLocal::com_numQuicksaves( "com_numQuicksaves", "4", CVAR_SYSTEM|CVAR_ARCHIVE|CVAR_INTEGER,
 										   "number of quicksaves to keep before overwriting the oldest", 1, 99 );
@@ -1522,6 +1523,40 @@ void idSessionLocal::SetBytesNeededForMapLoad( const char *mapName, int bytesNee
 	}
 }
 
+/*
+===============
+Level load phases
+
+Times the parts of ExecuteMapChange for the com_showLoadTimes report.
+===============
+*/
+typedef enum {
+	LOAD_PHASE_GEOMETRY,
+	LOAD_PHASE_ENTITIES,
+	LOAD_PHASE_RENDER_MEDIA,
+	LOAD_PHASE_SOUNDS,
+	LOAD_PHASE_GUIS,
+	LOAD_PHASE_SETTLE,
+	LOAD_PHASE_INTERACTIONS,
+	LOAD_PHASE_COUNT
+} loadPhase_t;
+
+static const char *loadPhaseNames[LOAD_PHASE_COUNT] = {
+	"map geometry",
+	"entities",
+	"models and images",
+	"sounds and decls",
+	"guis",
+	"settle frames",
+	"interactions"
+};
+
+static void EndLoadPhase( int loadTimes[LOAD_PHASE_COUNT], loadPhase_t phase, int &phaseStart ) {
+	int now = Sys_Milliseconds();
+	loadTimes[phase] += now - phaseStart;
+	phaseStart = now;
+}
+
 /*
 ===============
 idSessionLocal::ExecuteMapChange
@@ -1628,6 +1663,10 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 	}
 
 	int start = Sys_Milliseconds();
+	int phaseStart = start;
+	int loadTimes[LOAD_PHASE_COUNT];
+
+	memset( loadTimes, 0, sizeof( loadTimes ) );
 
 	common->Printf( "----- Map Initialization -----\n" );
 	common->Printf( "Map: %s\n", mapString.c_str() );
@@ -1636,6 +1675,7 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 	if ( !rw->InitFromMap( fullMapName ) ) {
 		common->Error( "couldn't load %s", fullMapName.c_str() );
 	}
+	EndLoadPhase( loadTimes, LOAD_PHASE_GEOMETRY, phaseStart );
 
 	// for the synchronous networking we needed to roll the angles over from
 	// level to level, but now we can just clear everything
@@ -1673,14 +1713,20 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 		}
 	}
 
-	// actually purge/load the media
+	EndLoadPhase( loadTimes, LOAD_PHASE_ENTITIES, phaseStart );
+
+	// actually purge/load the media, the images referenced by the map and
+	// the entities have been decoding in jobs since they were first found
 	if ( !reloadingSameMap ) {
 		renderSystem->EndLevelLoad();
+		EndLoadPhase( loadTimes, LOAD_PHASE_RENDER_MEDIA, phaseStart );
 		soundSystem->EndLevelLoad( mapString.c_str() );
 		declManager->EndLevelLoad();
 		SetBytesNeededForMapLoad( mapString.c_str(), fileSystem->GetReadCount() );
+		EndLoadPhase( loadTimes, LOAD_PHASE_SOUNDS, phaseStart );
 	}
 	uiManager->EndLevelLoad();
+	EndLoadPhase( loadTimes, LOAD_PHASE_GUIS, phaseStart );
 
 	if ( !idAsyncNetwork::IsActive() && !loadingSaveGame ) {
 		// run a few frames to allow everything to settle
@@ -1688,12 +1734,24 @@ void idSessionLocal::ExecuteMapChange( bool noFadeWipe ) {
 			game->RunFrame( mapSpawnData.mapSpawnUsercmd );
 		}
 	}
+	EndLoadPhase( loadTimes, LOAD_PHASE_SETTLE, phaseStart );
 
 	int	msec = Sys_Milliseconds() - start;
 	common->Printf( "%6d msec to load %s\n", msec, mapString.c_str() );
 
 	// let the renderSystem generate interactions now that everything is spawned
 	rw->GenerateAllInteractions();
+	EndLoadPhase( loadTimes, LOAD_PHASE_INTERACTIONS, phaseStart );
+
+	if ( com_showLoadTimes.GetBool() ) {
+		int total = phaseStart - start;
+
+		common->Printf( "----- Load Times -----\n" );
+		for ( i = 0; i < LOAD_PHASE_COUNT; i++ ) {
+			common->Printf( "%6d msec %3d%% %s\n", loadTimes[i], total > 0 ? loadTimes[i] * 100 / total : 0, loadPhaseNames[i] );
+		}
+		common->Printf( "%6d msec total\n", total );
+	}
 
 	common->PrintWarnings();
 
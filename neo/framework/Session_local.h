@@ -175,6 +175,7 @@ public:
 	static idCVar		com_aviDemoTics;
 	static idCVar		com_wipeSeconds;
 	static idCVar		com_guid;
+	static idCVar		com_showLoadTimes;
 	static idCVar		com_numQuicksaves;
 
 	static idCVar		gui_configServerRate;
@@ -42,6 +42,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "Simd_SSE.h"
 #include "Simd_SSE2.h"
 #include "Simd_SSE3.h"
+#include "Simd_AVX2.h"
 
 idSIMDProcessor	*	processor = NULL;			// pointer to SIMD processor
 idSIMDProcessor *	generic = NULL;				// pointer to generic SIMD implementation
@@ -77,7 +78,9 @@ void idSIMD::InitProcessor( const char *module, bool forceGeneric ) {
 	} else {
 
 		if ( !processor ) {
-			if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) && ( cpuid & CPUID_SSE3 ) ) {
+			if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) && ( cpuid & CPUID_SSE3 ) && ( cpuid & CPUID_AVX2 ) ) {
+				processor = new idSIMD_AVX2;
+			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) && ( cpuid & CPUID_SSE3 ) ) {
 				processor = new idSIMD_SSE3;
 			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) ) {
 				processor = new idSIMD_SSE2;
@@ -2718,6 +2721,82 @@ void TestOverlayPointCull( void ) {
 	PrintClocks( va( "   simd->OverlayPointCull() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
 }
 
+/*
+============
+TestShadowPointCull
+============
+*/
+void TestShadowPointCull( void ) {
+	int i, j;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( idPlane planes[6] );
+	ALIGN16( idDrawVert drawVerts[COUNT] );
+	ALIGN16( unsigned short pointCull1[COUNT] );
+	ALIGN16( unsigned short pointCull2[COUNT] );
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	planes[0].SetNormal( idVec3(  1,  0,  0 ) );
+	planes[1].SetNormal( idVec3( -1,  0,  0 ) );
+	planes[2].SetNormal( idVec3(  0,  1,  0 ) );
+	planes[3].SetNormal( idVec3(  0, -1,  0 ) );
+	planes[4].SetNormal( idVec3(  0,  0,  1 ) );
+	planes[5].SetNormal( idVec3(  0,  0, -1 ) );
+	planes[0][3] = 5.3f;
+	planes[1][3] = 5.3f;
+	planes[2][3] = 4.4f;
+	planes[3][3] = 4.4f;
+	planes[4][3] = 3.5f;
+	planes[5][3] = 3.5f;
+
+	for ( i = 0; i < COUNT; i++ ) {
+		for ( j = 0; j < 3; j++ ) {
+			drawVerts[i].xyz[j] = srnd.CRandomFloat() * 10.0f;
+		}
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->ShadowPointCull( pointCull1, 0, 0.1f, planes, drawVerts, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->ShadowPointCull()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->ShadowPointCull( pointCull2, 0, 0.1f, planes, drawVerts, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( pointCull1[i] != pointCull2[i] ) {
+			break;
+		}
+	}
+
+	// also check a partially inside surface with an odd vertex count
+	if ( i >= COUNT ) {
+		const int frontBits = ( 1 << 6 ) | ( 1 << 9 );
+		p_generic->ShadowPointCull( pointCull1, frontBits, 0.1f, planes, drawVerts, COUNT - 3 );
+		p_simd->ShadowPointCull( pointCull2, frontBits, 0.1f, planes, drawVerts, COUNT - 3 );
+		for ( i = 0; i < COUNT - 3; i++ ) {
+			if ( pointCull1[i] != pointCull2[i] ) {
+				break;
+			}
+		}
+		if ( i >= COUNT - 3 ) {
+			i = COUNT;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" :  S_COLOR_RED "X";
+	PrintClocks( va( "   simd->ShadowPointCull() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestDeriveTriPlanes
@@ -4019,8 +4098,14 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 				return;
 			}
 			p_simd = new idSIMD_SSE3();
+		} else if ( idStr::Icmp( argString, "AVX2" ) == 0 ) {
+			if ( !( cpuid & CPUID_MMX ) || !( cpuid & CPUID_SSE ) || !( cpuid & CPUID_SSE2 ) || !( cpuid & CPUID_SSE3 ) || !( cpuid & CPUID_AVX2 ) ) {
+				common->Printf( "CPU does not support MMX & SSE & SSE2 & SSE3 & AVX2\n" );
+				return;
+			}
+			p_simd = new idSIMD_AVX2();
 		} else {
-			common->Printf( "invalid argument, use: MMX, SSE, SSE2, SSE3\n" );
+			common->Printf( "invalid argument, use: MMX, SSE, SSE2, SSE3, AVX2\n" );
 			return;
 		}
 	}
@@ -4067,6 +4152,7 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 	TestTracePointCull();
 	TestDecalPointCull();
 	TestOverlayPointCull();
+	TestShadowPointCull();
 	TestDeriveTriPlanes();
 	TestDeriveTangents();
 	TestDeriveUnsmoothedTangents();
@@ -180,6 +180,7 @@ public:
 	virtual void VPCALL TracePointCull( byte *cullBits, byte &totalOr, const float radius, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual void VPCALL DecalPointCull( byte *cullBits, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual void VPCALL OverlayPointCull( byte *cullBits, idVec2 *texCoords, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
+	virtual void VPCALL ShadowPointCull( unsigned short *pointCull, const int frontBits, const float epsilon, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual void VPCALL DeriveTriPlanes( idPlane *planes, const idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) = 0;
 	virtual void VPCALL DeriveTangents( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) = 0;
 	virtual void VPCALL DeriveUnsmoothedTangents( idDrawVert *verts, const dominantTri_s *dominantTris, const int numVerts ) = 0;
@@ -189,6 +190,13 @@ public:
 	virtual int  VPCALL CreateShadowCache( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual int  VPCALL CreateVertexProgramShadowCache( idVec4 *vertexCache, const idDrawVert *verts, const int numVerts ) = 0;
 
+	// image processing on RGBA images, the normal map images wrap and have a power of two size
+	virtual void VPCALL MipMapImage( byte *dst, const byte *src, const int width, const int height ) = 0;
+	virtual void VPCALL ResampleImageRow( byte *dst, const byte *row1, const byte *row2, const unsigned int *offsets1, const unsigned int *offsets2, const int numPixels ) = 0;
+	virtual void VPCALL HeightmapToNormalMap( byte *dst, const byte *heights, const int width, const int height, const float scale ) = 0;
+	virtual void VPCALL AddNormalMaps( byte *dst, const byte *src, const int numPixels ) = 0;
+	virtual void VPCALL SmoothNormalMap( byte *dst, const byte *src, const int width, const int height ) = 0;
+
 	// sound mixing
 	virtual void VPCALL UpSamplePCMTo44kHz( float *dest, const short *pcm, const int numSamples, const int kHz, const int numChannels ) = 0;
 	virtual void VPCALL UpSampleOGGTo44kHz( float *dest, const float * const *ogg, const int numSamples, const int kHz, const int numChannels ) = 0;
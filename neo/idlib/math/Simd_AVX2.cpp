@@ -0,0 +1,659 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+#include "Simd_Generic.h"
+#include "Simd_MMX.h"
+#include "Simd_SSE.h"
+#include "Simd_SSE2.h"
+#include "Simd_SSE3.h"
+#include "Simd_AVX2.h"
+
+
+//===============================================================
+//
+//	AVX2 implementation of idSIMDProcessor
+//
+//===============================================================
+
+#if defined(__GNUC__) && defined(__x86_64__)
+
+#include <immintrin.h>
+
+// the kernels are compiled for AVX2 + FMA without changing the flags of the whole build,
+// they are only ever called when Sys_GetProcessorId() reported CPUID_AVX2
+#define AVX2_TARGET		__attribute__((target("avx2,fma")))
+
+// without FMA the compiler cannot contract a multiply and add, keeps results bit identical to the generic code
+#define AVX2_TARGET_NOFMA	__attribute__((target("avx2")))
+
+/*
+============
+AVX2_Transpose4x8
+
+  Transposes four vectors of eight components into eight vectors of four components.
+============
+*/
+static AVX2_TARGET inline void AVX2_Transpose4x8( __m128 out[8], const __m256 a, const __m256 b, const __m256 c, const __m256 d ) {
+	__m256 t0 = _mm256_unpacklo_ps( a, b );
+	__m256 t1 = _mm256_unpackhi_ps( a, b );
+	__m256 t2 = _mm256_unpacklo_ps( c, d );
+	__m256 t3 = _mm256_unpackhi_ps( c, d );
+	__m256 r0 = _mm256_shuffle_ps( t0, t2, 0x44 );
+	__m256 r1 = _mm256_shuffle_ps( t0, t2, 0xEE );
+	__m256 r2 = _mm256_shuffle_ps( t1, t3, 0x44 );
+	__m256 r3 = _mm256_shuffle_ps( t1, t3, 0xEE );
+
+	out[0] = _mm256_castps256_ps128( r0 );
+	out[1] = _mm256_castps256_ps128( r1 );
+	out[2] = _mm256_castps256_ps128( r2 );
+	out[3] = _mm256_castps256_ps128( r3 );
+	out[4] = _mm256_extractf128_ps( r0, 1 );
+	out[5] = _mm256_extractf128_ps( r1, 1 );
+	out[6] = _mm256_extractf128_ps( r2, 1 );
+	out[7] = _mm256_extractf128_ps( r3, 1 );
+}
+
+/*
+============
+AVX2_ATanPositive
+
+  idMath::ATan16 for eight pairs of non-negative y and x.
+============
+*/
+static AVX2_TARGET inline __m256 AVX2_ATanPositive( const __m256 y, const __m256 x ) {
+	__m256 swap = _mm256_cmp_ps( y, x, _CMP_GT_OQ );
+	__m256 a = _mm256_div_ps( _mm256_min_ps( x, y ), _mm256_max_ps( x, y ) );
+	__m256 s = _mm256_mul_ps( a, a );
+	__m256 p = _mm256_set1_ps( 0.0028662257f );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( -0.0161657367f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( 0.0429096138f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( -0.0752896400f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( 0.1065626393f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( -0.1420889944f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( 0.1999355085f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( -0.3333314528f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( 1.0f ) );
+	p = _mm256_mul_ps( p, a );
+	return _mm256_blendv_ps( p, _mm256_sub_ps( _mm256_set1_ps( idMath::HALF_PI ), p ), swap );
+}
+
+/*
+============
+AVX2_SinZeroHalfPI
+
+  idMath::Sin16 for eight angles in the range [0, PI/2].
+============
+*/
+static AVX2_TARGET inline __m256 AVX2_SinZeroHalfPI( const __m256 a ) {
+	__m256 s = _mm256_mul_ps( a, a );
+	__m256 p = _mm256_set1_ps( -2.39e-08f );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( 2.7526e-06f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( -1.98409e-04f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( 8.3333315e-03f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( -1.666666664e-01f ) );
+	p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( 1.0f ) );
+	return _mm256_mul_ps( p, a );
+}
+
+/*
+============
+AVX2_BlendJoints
+============
+*/
+static AVX2_TARGET void AVX2_BlendJoints( idJointQuat *joints, const idJointQuat *blendJoints, const float lerp, const int *index, const int numJoints ) {
+	float *jointsPtr = joints[0].q.ToFloatPtr();
+	const float *blendPtr = blendJoints[0].q.ToFloatPtr();
+	const __m256 one = _mm256_set1_ps( 1.0f );
+	const __m256 signBit = _mm256_set1_ps( -0.0f );
+	const __m256 vlerp = _mm256_set1_ps( lerp );
+	const __m256 vlerp1 = _mm256_set1_ps( 1.0f - lerp );
+	const __m256i stride = _mm256_set1_epi32( sizeof( idJointQuat ) / sizeof( float ) );
+	__m128 q[8], t[8];
+	int i;
+
+	for ( i = 0; i + 8 <= numJoints; i += 8 ) {
+		__m256i offset = _mm256_mullo_epi32( _mm256_loadu_si256( (const __m256i *) ( index + i ) ), stride );
+
+		__m256 jqx = _mm256_i32gather_ps( jointsPtr + 0, offset, 4 );
+		__m256 jqy = _mm256_i32gather_ps( jointsPtr + 1, offset, 4 );
+		__m256 jqz = _mm256_i32gather_ps( jointsPtr + 2, offset, 4 );
+		__m256 jqw = _mm256_i32gather_ps( jointsPtr + 3, offset, 4 );
+		__m256 jtx = _mm256_i32gather_ps( jointsPtr + 4, offset, 4 );
+		__m256 jty = _mm256_i32gather_ps( jointsPtr + 5, offset, 4 );
+		__m256 jtz = _mm256_i32gather_ps( jointsPtr + 6, offset, 4 );
+
+		__m256 bqx = _mm256_i32gather_ps( blendPtr + 0, offset, 4 );
+		__m256 bqy = _mm256_i32gather_ps( blendPtr + 1, offset, 4 );
+		__m256 bqz = _mm256_i32gather_ps( blendPtr + 2, offset, 4 );
+		__m256 bqw = _mm256_i32gather_ps( blendPtr + 3, offset, 4 );
+		__m256 btx = _mm256_i32gather_ps( blendPtr + 4, offset, 4 );
+		__m256 bty = _mm256_i32gather_ps( blendPtr + 5, offset, 4 );
+		__m256 btz = _mm256_i32gather_ps( blendPtr + 6, offset, 4 );
+
+		__m256 cosom = _mm256_mul_ps( jqx, bqx );
+		cosom = _mm256_fmadd_ps( jqy, bqy, cosom );
+		cosom = _mm256_fmadd_ps( jqz, bqz, cosom );
+		cosom = _mm256_fmadd_ps( jqw, bqw, cosom );
+
+		// take the shortest path by flipping the blend quaternion when the cosine is negative
+		__m256 sign = _mm256_and_ps( cosom, signBit );
+		cosom = _mm256_xor_ps( cosom, sign );
+		bqx = _mm256_xor_ps( bqx, sign );
+		bqy = _mm256_xor_ps( bqy, sign );
+		bqz = _mm256_xor_ps( bqz, sign );
+		bqw = _mm256_xor_ps( bqw, sign );
+
+		// fall back to a linear blend when the quaternions are nearly the same
+		__m256 spherical = _mm256_cmp_ps( _mm256_sub_ps( one, cosom ), _mm256_set1_ps( 1e-6f ), _CMP_GT_OQ );
+
+		__m256 sinSqr = _mm256_fnmadd_ps( cosom, cosom, one );
+		__m256 sinom = _mm256_div_ps( one, _mm256_sqrt_ps( sinSqr ) );
+		__m256 omega = AVX2_ATanPositive( _mm256_mul_ps( sinSqr, sinom ), cosom );
+		__m256 scale0 = _mm256_mul_ps( AVX2_SinZeroHalfPI( _mm256_mul_ps( vlerp1, omega ) ), sinom );
+		__m256 scale1 = _mm256_mul_ps( AVX2_SinZeroHalfPI( _mm256_mul_ps( vlerp, omega ) ), sinom );
+
+		scale0 = _mm256_blendv_ps( vlerp1, scale0, spherical );
+		scale1 = _mm256_blendv_ps( vlerp, scale1, spherical );
+
+		jqx = _mm256_fmadd_ps( scale0, jqx, _mm256_mul_ps( scale1, bqx ) );
+		jqy = _mm256_fmadd_ps( scale0, jqy, _mm256_mul_ps( scale1, bqy ) );
+		jqz = _mm256_fmadd_ps( scale0, jqz, _mm256_mul_ps( scale1, bqz ) );
+		jqw = _mm256_fmadd_ps( scale0, jqw, _mm256_mul_ps( scale1, bqw ) );
+
+		jtx = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( btx, jtx ), jtx );
+		jty = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( bty, jty ), jty );
+		jtz = _mm256_fmadd_ps( vlerp, _mm256_sub_ps( btz, jtz ), jtz );
+
+		AVX2_Transpose4x8( q, jqx, jqy, jqz, jqw );
+		AVX2_Transpose4x8( t, jtx, jty, jtz, jtz );
+
+		for ( int j = 0; j < 8; j++ ) {
+			idJointQuat &joint = joints[index[i + j]];
+			_mm_storeu_ps( joint.q.ToFloatPtr(), q[j] );
+			_mm_storel_pi( (__m64 *) joint.t.ToFloatPtr(), t[j] );
+			_mm_store_ss( joint.t.ToFloatPtr() + 2, _mm_movehl_ps( t[j], t[j] ) );
+		}
+	}
+
+	for ( ; i < numJoints; i++ ) {
+		int j = index[i];
+		joints[j].q.Slerp( joints[j].q, blendJoints[j].q, lerp );
+		joints[j].t.Lerp( joints[j].t, blendJoints[j].t, lerp );
+	}
+}
+
+/*
+============
+AVX2_ConvertJointQuatsToJointMats
+============
+*/
+static AVX2_TARGET void AVX2_ConvertJointQuatsToJointMats( idJointMat *jointMats, const idJointQuat *jointQuats, const int numJoints ) {
+	const __m256 one = _mm256_set1_ps( 1.0f );
+	const __m256i offset = _mm256_mullo_epi32( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm256_set1_epi32( sizeof( idJointQuat ) / sizeof( float ) ) );
+	__m128 rows[8];
+	int i;
+
+	for ( i = 0; i + 8 <= numJoints; i += 8 ) {
+		const float *quatPtr = jointQuats[i].q.ToFloatPtr();
+
+		__m256 x = _mm256_i32gather_ps( quatPtr + 0, offset, 4 );
+		__m256 y = _mm256_i32gather_ps( quatPtr + 1, offset, 4 );
+		__m256 z = _mm256_i32gather_ps( quatPtr + 2, offset, 4 );
+		__m256 w = _mm256_i32gather_ps( quatPtr + 3, offset, 4 );
+		__m256 tx = _mm256_i32gather_ps( quatPtr + 4, offset, 4 );
+		__m256 ty = _mm256_i32gather_ps( quatPtr + 5, offset, 4 );
+		__m256 tz = _mm256_i32gather_ps( quatPtr + 6, offset, 4 );
+
+		__m256 x2 = _mm256_add_ps( x, x );
+		__m256 y2 = _mm256_add_ps( y, y );
+		__m256 z2 = _mm256_add_ps( z, z );
+
+		__m256 xx = _mm256_mul_ps( x, x2 );
+		__m256 xy = _mm256_mul_ps( x, y2 );
+		__m256 xz = _mm256_mul_ps( x, z2 );
+		__m256 yy = _mm256_mul_ps( y, y2 );
+		__m256 yz = _mm256_mul_ps( y, z2 );
+		__m256 zz = _mm256_mul_ps( z, z2 );
+		__m256 wx = _mm256_mul_ps( w, x2 );
+		__m256 wy = _mm256_mul_ps( w, y2 );
+		__m256 wz = _mm256_mul_ps( w, z2 );
+
+		// the joint matrix holds the transpose of idQuat::ToMat3()
+		AVX2_Transpose4x8( rows,
+							_mm256_sub_ps( one, _mm256_add_ps( yy, zz ) ),
+							_mm256_add_ps( xy, wz ),
+							_mm256_sub_ps( xz, wy ),
+							tx );
+		for ( int j = 0; j < 8; j++ ) {
+			_mm_storeu_ps( jointMats[i + j].ToFloatPtr() + 0 * 4, rows[j] );
+		}
+
+		AVX2_Transpose4x8( rows,
+							_mm256_sub_ps( xy, wz ),
+							_mm256_sub_ps( one, _mm256_add_ps( xx, zz ) ),
+							_mm256_add_ps( yz, wx ),
+							ty );
+		for ( int j = 0; j < 8; j++ ) {
+			_mm_storeu_ps( jointMats[i + j].ToFloatPtr() + 1 * 4, rows[j] );
+		}
+
+		AVX2_Transpose4x8( rows,
+							_mm256_add_ps( xz, wy ),
+							_mm256_sub_ps( yz, wx ),
+							_mm256_sub_ps( one, _mm256_add_ps( xx, yy ) ),
+							tz );
+		for ( int j = 0; j < 8; j++ ) {
+			_mm_storeu_ps( jointMats[i + j].ToFloatPtr() + 2 * 4, rows[j] );
+		}
+	}
+
+	for ( ; i < numJoints; i++ ) {
+		jointMats[i].SetRotation( jointQuats[i].q.ToMat3() );
+		jointMats[i].SetTranslation( jointQuats[i].t );
+	}
+}
+
+/*
+============
+AVX2_TransformJoints
+
+  The first two rows of the result are calculated together in a 256 bit register.
+  Every joint is transformed by its already transformed parent so rounding differences
+  would add up along the hierarchy, the products are summed in the same order as the
+  generic code and are not fused.
+============
+*/
+static AVX2_TARGET_NOFMA void AVX2_TransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) {
+	const __m256 zero = _mm256_setzero_ps();
+	int i;
+
+	for ( i = firstJoint; i <= lastJoint; i++ ) {
+		assert( parents[i] < i );
+		float *m = jointMats[i].ToFloatPtr();
+		const float *p = jointMats[parents[i]].ToFloatPtr();
+
+		__m256 m0 = _mm256_broadcast_ps( (const __m128 *) ( m + 0 * 4 ) );
+		__m256 m1 = _mm256_broadcast_ps( (const __m128 *) ( m + 1 * 4 ) );
+		__m256 m2 = _mm256_broadcast_ps( (const __m128 *) ( m + 2 * 4 ) );
+		__m256 p01 = _mm256_loadu_ps( p + 0 * 4 );
+		__m128 p2 = _mm_loadu_ps( p + 2 * 4 );
+
+		__m256 r01 = _mm256_mul_ps( _mm256_permute_ps( p01, 0x00 ), m0 );
+		r01 = _mm256_add_ps( r01, _mm256_mul_ps( _mm256_permute_ps( p01, 0x55 ), m1 ) );
+		r01 = _mm256_add_ps( r01, _mm256_mul_ps( _mm256_permute_ps( p01, 0xAA ), m2 ) );
+		r01 = _mm256_add_ps( r01, _mm256_blend_ps( zero, p01, 0x88 ) );
+
+		__m128 r2 = _mm_mul_ps( _mm_permute_ps( p2, 0x00 ), _mm256_castps256_ps128( m0 ) );
+		r2 = _mm_add_ps( r2, _mm_mul_ps( _mm_permute_ps( p2, 0x55 ), _mm256_castps256_ps128( m1 ) ) );
+		r2 = _mm_add_ps( r2, _mm_mul_ps( _mm_permute_ps( p2, 0xAA ), _mm256_castps256_ps128( m2 ) ) );
+		r2 = _mm_add_ps( r2, _mm_blend_ps( _mm256_castps256_ps128( zero ), p2, 0x08 ) );
+
+		_mm256_storeu_ps( m + 0 * 4, r01 );
+		_mm_storeu_ps( m + 2 * 4, r2 );
+	}
+}
+
+/*
+============
+AVX2_UntransformJoints
+============
+*/
+static AVX2_TARGET void AVX2_UntransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) {
+	const __m128 zero = _mm_setzero_ps();
+	const __m256i select01 = _mm256_setr_epi32( 0, 0, 0, 0, 1, 1, 1, 1 );
+	int i;
+
+	for ( i = lastJoint; i >= firstJoint; i-- ) {
+		assert( parents[i] < i );
+		float *m = jointMats[i].ToFloatPtr();
+		const float *p = jointMats[parents[i]].ToFloatPtr();
+		__m256 r01 = _mm256_setzero_ps();
+		__m128 r2 = _mm_setzero_ps();
+
+		for ( int k = 0; k < 3; k++ ) {
+			__m128 pk = _mm_loadu_ps( p + k * 4 );
+			__m128 mk = _mm_sub_ps( _mm_loadu_ps( m + k * 4 ), _mm_blend_ps( zero, pk, 0x08 ) );
+			__m256 mkk = _mm256_insertf128_ps( _mm256_castps128_ps256( mk ), mk, 1 );
+			__m256 pkk = _mm256_broadcast_ps( (const __m128 *) ( p + k * 4 ) );
+
+			// row k of the parent scales row k of the joint into result rows 0, 1 and 2
+			r01 = _mm256_fmadd_ps( _mm256_permutevar_ps( pkk, select01 ), mkk, r01 );
+			r2 = _mm_fmadd_ps( _mm_permute_ps( pk, 0xAA ), mk, r2 );
+		}
+
+		_mm256_storeu_ps( m + 0 * 4, r01 );
+		_mm_storeu_ps( m + 2 * 4, r2 );
+	}
+}
+
+/*
+============
+AVX2_TransformVerts
+
+  The first two rows of each weighted joint are accumulated together in a 256 bit register.
+============
+*/
+static AVX2_TARGET void AVX2_TransformVerts( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int numWeights ) {
+	const byte *jointsPtr = (const byte *)joints;
+	int i, j;
+
+	for ( j = i = 0; i < numVerts; i++ ) {
+		const float *m = ( (const idJointMat *) ( jointsPtr + index[j*2+0] ) )->ToFloatPtr();
+		__m128 w = _mm_loadu_ps( weights[j].ToFloatPtr() );
+		__m256 ww = _mm256_insertf128_ps( _mm256_castps128_ps256( w ), w, 1 );
+
+		__m256 acc01 = _mm256_mul_ps( _mm256_loadu_ps( m ), ww );
+		__m128 acc2 = _mm_mul_ps( _mm_loadu_ps( m + 8 ), w );
+
+		while( index[j*2+1] == 0 ) {
+			j++;
+			m = ( (const idJointMat *) ( jointsPtr + index[j*2+0] ) )->ToFloatPtr();
+			w = _mm_loadu_ps( weights[j].ToFloatPtr() );
+			ww = _mm256_insertf128_ps( _mm256_castps128_ps256( w ), w, 1 );
+
+			acc01 = _mm256_fmadd_ps( _mm256_loadu_ps( m ), ww, acc01 );
+			acc2 = _mm_fmadd_ps( _mm_loadu_ps( m + 8 ), w, acc2 );
+		}
+		j++;
+
+		__m128 xy = _mm_hadd_ps( _mm256_castps256_ps128( acc01 ), _mm256_extractf128_ps( acc01, 1 ) );
+		__m128 xyz = _mm_hadd_ps( xy, _mm_hadd_ps( acc2, acc2 ) );
+
+		_mm_storel_pi( (__m64 *) verts[i].xyz.ToFloatPtr(), xyz );
+		_mm_store_ss( verts[i].xyz.ToFloatPtr() + 2, _mm_movehl_ps( xyz, xyz ) );
+	}
+}
+
+/*
+============
+AVX2_RSqrtFast
+
+  idMath::RSqrt for eight values, bit identical to the scalar version as long as
+  nothing gets fused.
+============
+*/
+static AVX2_TARGET_NOFMA inline __m256 AVX2_RSqrtFast( const __m256 x ) {
+	__m256 y = _mm256_mul_ps( x, _mm256_set1_ps( 0.5f ) );
+	__m256 r = _mm256_castsi256_ps( _mm256_sub_epi32( _mm256_set1_epi32( 0x5f3759df ), _mm256_srai_epi32( _mm256_castps_si256( x ), 1 ) ) );
+	return _mm256_mul_ps( r, _mm256_sub_ps( _mm256_set1_ps( 1.5f ), _mm256_mul_ps( _mm256_mul_ps( r, r ), y ) ) );
+}
+
+/*
+============
+AVX2_LoadHeights
+
+  Loads the heights of columns x to x + 7 of a wrapping row as floats.
+============
+*/
+static AVX2_TARGET_NOFMA inline __m256 AVX2_LoadHeights( const byte *row, const int x, const int width ) {
+	__m256i h;
+
+	if ( x + 8 <= width ) {
+		h = _mm256_cvtepu8_epi32( _mm_loadl_epi64( (const __m128i *)( row + x ) ) );
+	} else {
+		const int mask = width - 1;
+		h = _mm256_setr_epi32( row[( x + 0 ) & mask], row[( x + 1 ) & mask], row[( x + 2 ) & mask], row[( x + 3 ) & mask],
+								row[( x + 4 ) & mask], row[( x + 5 ) & mask], row[( x + 6 ) & mask], row[( x + 7 ) & mask] );
+	}
+	return _mm256_cvtepi32_ps( h );
+}
+
+/*
+============
+AVX2_MipMapImage
+
+  Eight output pixels at a time, the 16 bit sums give the same result as the generic code.
+============
+*/
+static AVX2_TARGET void AVX2_MipMapImage( byte *dst, const byte *src, const int width, const int height ) {
+	const int row = width * 4;
+	const int outWidth = width >> 1;
+	const int outHeight = height >> 1;
+	const __m256i zero = _mm256_setzero_si256();
+
+	for ( int i = 0; i < outHeight; i++ ) {
+		const byte *in0 = src + i * 2 * row;
+		const byte *in1 = in0 + row;
+		byte *out = dst + i * outWidth * 4;
+
+		for ( int j = 0; j < outWidth; j += 8, in0 += 64, in1 += 64, out += 32 ) {
+			__m256i a0 = _mm256_loadu_si256( (const __m256i *)( in0 + 0 ) );
+			__m256i a1 = _mm256_loadu_si256( (const __m256i *)( in0 + 32 ) );
+			__m256i b0 = _mm256_loadu_si256( (const __m256i *)( in1 + 0 ) );
+			__m256i b1 = _mm256_loadu_si256( (const __m256i *)( in1 + 32 ) );
+
+			// vertical sums, the unpacks work within 128 bit lanes so each lane holds the pairs of its own four pixels
+			__m256i s0 = _mm256_add_epi16( _mm256_unpacklo_epi8( a0, zero ), _mm256_unpacklo_epi8( b0, zero ) );
+			__m256i s1 = _mm256_add_epi16( _mm256_unpackhi_epi8( a0, zero ), _mm256_unpackhi_epi8( b0, zero ) );
+			__m256i s2 = _mm256_add_epi16( _mm256_unpacklo_epi8( a1, zero ), _mm256_unpacklo_epi8( b1, zero ) );
+			__m256i s3 = _mm256_add_epi16( _mm256_unpackhi_epi8( a1, zero ), _mm256_unpackhi_epi8( b1, zero ) );
+
+			// horizontal sums
+			__m256i r0 = _mm256_add_epi16( _mm256_unpacklo_epi64( s0, s1 ), _mm256_unpackhi_epi64( s0, s1 ) );
+			__m256i r1 = _mm256_add_epi16( _mm256_unpacklo_epi64( s2, s3 ), _mm256_unpackhi_epi64( s2, s3 ) );
+
+			__m256i p = _mm256_packus_epi16( _mm256_srli_epi16( r0, 2 ), _mm256_srli_epi16( r1, 2 ) );
+			_mm256_storeu_si256( (__m256i *)out, _mm256_permute4x64_epi64( p, _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+		}
+	}
+}
+
+/*
+============
+AVX2_ResampleImageRow
+
+  Gathers eight pixels from each of the four source positions, returns the number
+  of pixels written.
+============
+*/
+static AVX2_TARGET int AVX2_ResampleImageRow( byte *dst, const byte *row1, const byte *row2, const unsigned int *offsets1, const unsigned int *offsets2, const int numPixels ) {
+	const __m256i zero = _mm256_setzero_si256();
+	int j;
+
+	for ( j = 0; j + 8 <= numPixels; j += 8 ) {
+		__m256i o1 = _mm256_loadu_si256( (const __m256i *)( offsets1 + j ) );
+		__m256i o2 = _mm256_loadu_si256( (const __m256i *)( offsets2 + j ) );
+
+		__m256i v1 = _mm256_i32gather_epi32( (const int *)row1, o1, 1 );
+		__m256i v2 = _mm256_i32gather_epi32( (const int *)row1, o2, 1 );
+		__m256i v3 = _mm256_i32gather_epi32( (const int *)row2, o1, 1 );
+		__m256i v4 = _mm256_i32gather_epi32( (const int *)row2, o2, 1 );
+
+		__m256i lo = _mm256_add_epi16( _mm256_add_epi16( _mm256_unpacklo_epi8( v1, zero ), _mm256_unpacklo_epi8( v2, zero ) ),
+										_mm256_add_epi16( _mm256_unpacklo_epi8( v3, zero ), _mm256_unpacklo_epi8( v4, zero ) ) );
+		__m256i hi = _mm256_add_epi16( _mm256_add_epi16( _mm256_unpackhi_epi8( v1, zero ), _mm256_unpackhi_epi8( v2, zero ) ),
+										_mm256_add_epi16( _mm256_unpackhi_epi8( v3, zero ), _mm256_unpackhi_epi8( v4, zero ) ) );
+
+		// unpack and pack are both in lane, so the pixels come out in order
+		_mm256_storeu_si256( (__m256i *)( dst + j * 4 ), _mm256_packus_epi16( _mm256_srli_epi16( lo, 2 ), _mm256_srli_epi16( hi, 2 ) ) );
+	}
+	return j;
+}
+
+/*
+============
+AVX2_HeightmapToNormalMap
+
+  Eight pixels at a time with the same operations as the generic code.  Not fused
+  so the result is identical.
+============
+*/
+static AVX2_TARGET_NOFMA void AVX2_HeightmapToNormalMap( byte *dst, const byte *heights, const int width, const int height, const float scale ) {
+	const __m256 s = _mm256_set1_ps( scale );
+	const __m256 one = _mm256_set1_ps( 1.0f );
+	const __m256 colorScale = _mm256_set1_ps( 127.0f );
+	const __m256 colorBias = _mm256_set1_ps( 128.0f );
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 max = _mm256_set1_ps( 255.0f );
+	const __m256i alpha = _mm256_set1_epi32( 0xFF000000 );
+
+	for ( int i = 0; i < height; i++ ) {
+		const byte *row1 = heights + i * width;
+		const byte *row2 = heights + ( ( i + 1 ) & ( height - 1 ) ) * width;
+		byte *out = dst + i * width * 4;
+
+		for ( int j = 0; j < width; j += 8, out += 32 ) {
+			__m256 d1 = AVX2_LoadHeights( row1, j, width );
+			__m256 d2 = AVX2_LoadHeights( row1, j + 1, width );
+			__m256 d3 = AVX2_LoadHeights( row2, j, width );
+			__m256 d4 = AVX2_LoadHeights( row2, j + 1, width );
+
+			__m256 x1 = _mm256_mul_ps( _mm256_sub_ps( d1, d2 ), s );
+			__m256 y1 = _mm256_mul_ps( _mm256_sub_ps( d1, d3 ), s );
+			__m256 r1 = AVX2_RSqrtFast( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( x1, x1 ), _mm256_mul_ps( y1, y1 ) ), one ) );
+
+			__m256 x2 = _mm256_mul_ps( _mm256_sub_ps( d3, d4 ), s );
+			__m256 r2 = AVX2_RSqrtFast( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( x2, x2 ), _mm256_mul_ps( y1, y1 ) ), one ) );
+
+			__m256 x = _mm256_add_ps( _mm256_mul_ps( x1, r1 ), _mm256_mul_ps( x2, r2 ) );
+			__m256 y = _mm256_add_ps( _mm256_mul_ps( y1, r1 ), _mm256_mul_ps( y1, r2 ) );
+			__m256 z = _mm256_add_ps( r1, r2 );
+			__m256 r = AVX2_RSqrtFast( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( x, x ), _mm256_mul_ps( y, y ) ), _mm256_mul_ps( z, z ) ) );
+
+			__m256i cx = _mm256_cvttps_epi32( _mm256_min_ps( _mm256_max_ps( _mm256_add_ps( _mm256_mul_ps( _mm256_mul_ps( x, r ), colorScale ), colorBias ), zero ), max ) );
+			__m256i cy = _mm256_cvttps_epi32( _mm256_min_ps( _mm256_max_ps( _mm256_add_ps( _mm256_mul_ps( _mm256_mul_ps( y, r ), colorScale ), colorBias ), zero ), max ) );
+			__m256i cz = _mm256_cvttps_epi32( _mm256_min_ps( _mm256_max_ps( _mm256_add_ps( _mm256_mul_ps( _mm256_mul_ps( z, r ), colorScale ), colorBias ), zero ), max ) );
+			__m256i p = _mm256_or_si256( _mm256_or_si256( cx, _mm256_slli_epi32( cy, 8 ) ), _mm256_or_si256( _mm256_slli_epi32( cz, 16 ), alpha ) );
+			_mm256_storeu_si256( (__m256i *)out, p );
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::GetName
+============
+*/
+const char * idSIMD_AVX2::GetName( void ) const {
+	return "MMX & SSE & SSE2 & SSE3 & AVX2 & FMA";
+}
+
+/*
+============
+idSIMD_AVX2::BlendJoints
+============
+*/
+void VPCALL idSIMD_AVX2::BlendJoints( idJointQuat *joints, const idJointQuat *blendJoints, const float lerp, const int *index, const int numJoints ) {
+	int i;
+
+	if ( lerp <= 0.0f ) {
+		return;
+	} else if ( lerp >= 1.0f ) {
+		for ( i = 0; i < numJoints; i++ ) {
+			int j = index[i];
+			joints[j] = blendJoints[j];
+		}
+		return;
+	}
+
+	assert( sizeof( idJointQuat ) == 7 * sizeof( float ) );
+
+	AVX2_BlendJoints( joints, blendJoints, lerp, index, numJoints );
+}
+
+/*
+============
+idSIMD_AVX2::ConvertJointQuatsToJointMats
+============
+*/
+void VPCALL idSIMD_AVX2::ConvertJointQuatsToJointMats( idJointMat *jointMats, const idJointQuat *jointQuats, const int numJoints ) {
+	assert( sizeof( idJointQuat ) == 7 * sizeof( float ) );
+	assert( sizeof( idJointMat ) == 12 * sizeof( float ) );
+
+	AVX2_ConvertJointQuatsToJointMats( jointMats, jointQuats, numJoints );
+}
+
+/*
+============
+idSIMD_AVX2::TransformJoints
+============
+*/
+void VPCALL idSIMD_AVX2::TransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) {
+	AVX2_TransformJoints( jointMats, parents, firstJoint, lastJoint );
+}
+
+/*
+============
+idSIMD_AVX2::UntransformJoints
+============
+*/
+void VPCALL idSIMD_AVX2::UntransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint ) {
+	AVX2_UntransformJoints( jointMats, parents, firstJoint, lastJoint );
+}
+
+/*
+============
+idSIMD_AVX2::TransformVerts
+============
+*/
+void VPCALL idSIMD_AVX2::TransformVerts( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int numWeights ) {
+	AVX2_TransformVerts( verts, numVerts, joints, weights, index, numWeights );
+}
+
+/*
+============
+idSIMD_AVX2::MipMapImage
+============
+*/
+void VPCALL idSIMD_AVX2::MipMapImage( byte *dst, const byte *src, const int width, const int height ) {
+	if ( ( width >> 1 ) & 7 ) {
+		idSIMD_SSE3::MipMapImage( dst, src, width, height );
+		return;
+	}
+	AVX2_MipMapImage( dst, src, width, height );
+}
+
+/*
+============
+idSIMD_AVX2::ResampleImageRow
+============
+*/
+void VPCALL idSIMD_AVX2::ResampleImageRow( byte *dst, const byte *row1, const byte *row2, const unsigned int *offsets1, const unsigned int *offsets2, const int numPixels ) {
+	int j = AVX2_ResampleImageRow( dst, row1, row2, offsets1, offsets2, numPixels );
+	if ( j < numPixels ) {
+		idSIMD_SSE3::ResampleImageRow( dst + j * 4, row1, row2, offsets1 + j, offsets2 + j, numPixels - j );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::HeightmapToNormalMap
+============
+*/
+void VPCALL idSIMD_AVX2::HeightmapToNormalMap( byte *dst, const byte *heights, const int width, const int height, const float scale ) {
+	if ( width & 7 ) {
+		idSIMD_SSE3::HeightmapToNormalMap( dst, heights, width, height, scale );
+		return;
+	}
+	AVX2_HeightmapToNormalMap( dst, heights, width, height, scale );
+}
+
+#endif /* __GNUC__ && __x86_64__ */
@@ -0,0 +1,63 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __MATH_SIMD_AVX2_H__
+#define __MATH_SIMD_AVX2_H__
+
+/*
+===============================================================================
+
+	AVX2 implementation of idSIMDProcessor
+
+	Only the animation, skinning and image kernels are implemented here,
+	everything else falls through to the SSE3 processor. The intrinsics are compiled with
+	per function target attributes so the rest of the code does not need to be
+	built with -mavx2.
+
+===============================================================================
+*/
+
+class idSIMD_AVX2 : public idSIMD_SSE3 {
+public:
+#if defined(__GNUC__) && defined(__x86_64__)
+	virtual const char * VPCALL GetName( void ) const;
+
+	virtual void VPCALL BlendJoints( idJointQuat *joints, const idJointQuat *blendJoints, const float lerp, const int *index, const int numJoints );
+	virtual void VPCALL ConvertJointQuatsToJointMats( idJointMat *jointMats, const idJointQuat *jointQuats, const int numJoints );
+	virtual void VPCALL TransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint );
+	virtual void VPCALL UntransformJoints( idJointMat *jointMats, const int *parents, const int firstJoint, const int lastJoint );
+	virtual void VPCALL TransformVerts( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int numWeights );
+
+	virtual void VPCALL MipMapImage( byte *dst, const byte *src, const int width, const int height );
+	virtual void VPCALL ResampleImageRow( byte *dst, const byte *row1, const byte *row2, const unsigned int *offsets1, const unsigned int *offsets2, const int numPixels );
+	virtual void VPCALL HeightmapToNormalMap( byte *dst, const byte *heights, const int width, const int height, const float scale );
+
+#endif
+};
+
+#endif /* !__MATH_SIMD_AVX2_H__ */
@@ -2437,6 +2437,37 @@ void VPCALL idSIMD_Generic::OverlayPointCull( byte *cullBits, idVec2 *texCoords,
 	}
 }
 
+/*
+============
+idSIMD_Generic::ShadowPointCull
+
+  Classifies the vertices against the six light frustum planes for shadow volume creation.
+  For every plane i not flagged in frontBits ( 1 << ( i + 6 ) ):
+    bit i       is set if the vertex is less than epsilon in front of the plane
+    bit i + 6   is set if the vertex is more than -epsilon in front of the plane
+  frontBits is or'ed into every result.
+============
+*/
+void VPCALL idSIMD_Generic::ShadowPointCull( unsigned short *pointCull, const int frontBits, const float epsilon, const idPlane *planes, const idDrawVert *verts, const int numVerts ) {
+	int i, j;
+
+	for ( i = 0; i < numVerts; i++ ) {
+		const idVec3 &v = verts[i].xyz;
+		int bits = frontBits;
+
+		for ( j = 0; j < 6; j++ ) {
+			if ( frontBits & ( 1 << ( j + 6 ) ) ) {
+				continue;
+			}
+			float d = planes[j].Distance( v );
+			bits |= ( d < epsilon ) << j;
+			bits |= ( d > -epsilon ) << ( j + 6 );
+		}
+
+		pointCull[i] = bits;
+	}
+}
+
 /*
 ============
 idSIMD_Generic::DeriveTriPlanes
@@ -2845,6 +2876,180 @@ int VPCALL idSIMD_Generic::CreateVertexProgramShadowCache( idVec4 *vertexCache,
 	return numVerts * 2;
 }
 
+/*
+============
+idSIMD_Generic::MipMapImage
+
+  Box filters a width x height image into a ( width / 2 ) x ( height / 2 ) image.
+  Both sizes are at least two.
+============
+*/
+void VPCALL idSIMD_Generic::MipMapImage( byte *dst, const byte *src, const int width, const int height ) {
+	const int row = width * 4;
+	const int outWidth = width >> 1;
+	const int outHeight = height >> 1;
+
+	for ( int i = 0; i < outHeight; i++ ) {
+		const byte *in_p = src + i * 2 * row;
+		byte *out_p = dst + i * outWidth * 4;
+		for ( int j = 0; j < outWidth; j++, out_p += 4, in_p += 8 ) {
+			out_p[0] = ( in_p[0] + in_p[4] + in_p[row+0] + in_p[row+4] ) >> 2;
+			out_p[1] = ( in_p[1] + in_p[5] + in_p[row+1] + in_p[row+5] ) >> 2;
+			out_p[2] = ( in_p[2] + in_p[6] + in_p[row+2] + in_p[row+6] ) >> 2;
+			out_p[3] = ( in_p[3] + in_p[7] + in_p[row+3] + in_p[row+7] ) >> 2;
+		}
+	}
+}
+
+/*
+============
+idSIMD_Generic::ResampleImageRow
+
+  Averages four pixels for each output pixel, the offsets are in bytes.
+============
+*/
+void VPCALL idSIMD_Generic::ResampleImageRow( byte *dst, const byte *row1, const byte *row2, const unsigned int *offsets1, const unsigned int *offsets2, const int numPixels ) {
+	for ( int j = 0; j < numPixels; j++ ) {
+		const byte *pix1 = row1 + offsets1[j];
+		const byte *pix2 = row1 + offsets2[j];
+		const byte *pix3 = row2 + offsets1[j];
+		const byte *pix4 = row2 + offsets2[j];
+		dst[j*4+0] = ( pix1[0] + pix2[0] + pix3[0] + pix4[0] ) >> 2;
+		dst[j*4+1] = ( pix1[1] + pix2[1] + pix3[1] + pix4[1] ) >> 2;
+		dst[j*4+2] = ( pix1[2] + pix2[2] + pix3[2] + pix4[2] ) >> 2;
+		dst[j*4+3] = ( pix1[3] + pix2[3] + pix3[3] + pix4[3] ) >> 2;
+	}
+}
+
+/*
+============
+idSIMD_Generic::HeightmapToNormalMap
+
+  Estimates a normal for each pixel of a wrapping height map from the gradients
+  of two triangles.
+============
+*/
+void VPCALL idSIMD_Generic::HeightmapToNormalMap( byte *dst, const byte *heights, const int width, const int height, const float scale ) {
+	idVec3 dir, dir2;
+
+	for ( int i = 0; i < height; i++ ) {
+		const byte *row1 = heights + i * width;
+		const byte *row2 = heights + ( ( i + 1 ) & ( height - 1 ) ) * width;
+		byte *out = dst + i * width * 4;
+
+		for ( int j = 0; j < width; j++, out += 4 ) {
+			int d1, d2, d3, d4;
+			int a1, a3, a4;
+
+			// look at three points to estimate the gradient
+			a1 = d1 = row1[j];
+			d2 = row1[( j + 1 ) & ( width - 1 )];
+			a3 = d3 = row2[j];
+			a4 = d4 = row2[( j + 1 ) & ( width - 1 )];
+
+			d2 -= d1;
+			d3 -= d1;
+
+			dir[0] = -d2 * scale;
+			dir[1] = -d3 * scale;
+			dir[2] = 1;
+			dir.NormalizeFast();
+
+			a1 -= a3;
+			a4 -= a3;
+
+			dir2[0] = -a4 * scale;
+			dir2[1] = a1 * scale;
+			dir2[2] = 1;
+			dir2.NormalizeFast();
+
+			dir += dir2;
+			dir.NormalizeFast();
+
+			out[0] = (byte)( dir[0] * 127 + 128 );
+			out[1] = (byte)( dir[1] * 127 + 128 );
+			out[2] = (byte)( dir[2] * 127 + 128 );
+			out[3] = 255;
+		}
+	}
+}
+
+/*
+============
+idSIMD_Generic::AddNormalMaps
+
+  Adds the x and y of the src normals to the dst normals and renormalizes.
+============
+*/
+void VPCALL idSIMD_Generic::AddNormalMaps( byte *dst, const byte *src, const int numPixels ) {
+	for ( int i = 0; i < numPixels; i++ ) {
+		byte *d1 = dst + i * 4;
+		const byte *d2 = src + i * 4;
+		idVec3 n;
+		float len;
+
+		n[0] = ( d1[0] - 128 ) / 127.0;
+		n[1] = ( d1[1] - 128 ) / 127.0;
+		n[2] = ( d1[2] - 128 ) / 127.0;
+
+		// There are some normal maps that blend to 0,0,0 at the edges
+		// this screws up compression, so we try to correct that here by instead fading it to 0,0,1
+		len = n.LengthFast();
+		if ( len < 1.0f ) {
+			n[2] = idMath::Sqrt( idMath::ClampFloat( 0.0f, 1.0f, 1.0 - ( n[0] * n[0] ) - ( n[1] * n[1] ) ) );
+		}
+
+		n[0] += ( d2[0] - 128 ) / 127.0;
+		n[1] += ( d2[1] - 128 ) / 127.0;
+		n.Normalize();
+
+		d1[0] = (byte)( n[0] * 127 + 128 );
+		d1[1] = (byte)( n[1] * 127 + 128 );
+		d1[2] = (byte)( n[2] * 127 + 128 );
+		d1[3] = 255;
+	}
+}
+
+/*
+============
+idSIMD_Generic::SmoothNormalMap
+
+  Averages the 3x3 neighbourhood of each pixel of a wrapping normal map,
+  ignoring 0,0,0 and 128,128,128 pixels.  Only writes the rgb of dst.
+============
+*/
+void VPCALL idSIMD_Generic::SmoothNormalMap( byte *dst, const byte *src, const int width, const int height ) {
+	idVec3 normal;
+
+	for ( int j = 0; j < height; j++ ) {
+		for ( int i = 0; i < width; i++ ) {
+			normal = vec3_origin;
+			for ( int k = -1; k < 2; k++ ) {
+				for ( int l = -1; l < 2; l++ ) {
+					const byte *in = src + ( ( ( j + l ) & ( height - 1 ) ) * width + ( ( i + k ) & ( width - 1 ) ) ) * 4;
+
+					// ignore 000 and -1 -1 -1
+					if ( in[0] == 0 && in[1] == 0 && in[2] == 0 ) {
+						continue;
+					}
+					if ( in[0] == 128 && in[1] == 128 && in[2] == 128 ) {
+						continue;
+					}
+
+					normal[0] += in[0] - 128;
+					normal[1] += in[1] - 128;
+					normal[2] += in[2] - 128;
+				}
+			}
+			normal.Normalize();
+			byte *out = dst + ( j * width + i ) * 4;
+			out[0] = (byte)( 128 + 127 * normal[0] );
+			out[1] = (byte)( 128 + 127 * normal[1] );
+			out[2] = (byte)( 128 + 127 * normal[2] );
+		}
+	}
+}
+
 /*
 ============
 idSIMD_Generic::UpSamplePCMTo44kHz
@@ -628,6 +628,338 @@ void VPCALL idSIMD_SSE::Dot( float *dst, const idVec3 &constant, const idPlane *
 	*/
 }
 
+/*
+	The tangent space kernels work on blocks of four triangles or vertexes, which are
+	transposed into structure of arrays form so every vector operation handles the
+	whole block.  The normal and both tangents of a vertex are adjacent in idDrawVert,
+	so they are written back as two vectors of four floats and one scalar.
+*/
+
+/*
+============
+SSE_RSqrt
+
+  Reciprocal square root estimate refined with one Newton-Raphson iteration.
+  Zero length vectors stay zero instead of turning into NaNs.
+============
+*/
+static ID_INLINE __m128 SSE_RSqrt( __m128 x ) {
+	x = _mm_max_ps( x, _mm_set1_ps( 1e-30f ) );
+	__m128 r = _mm_rsqrt_ps( x );
+	return _mm_mul_ps( r, _mm_sub_ps( _mm_set1_ps( 1.5f ), _mm_mul_ps( _mm_mul_ps( _mm_set1_ps( 0.5f ), x ), _mm_mul_ps( r, r ) ) ) );
+}
+
+/*
+============
+SSE_LoadVertexes4
+
+  Loads the xyz and texture coordinates of four vertexes transposed.
+============
+*/
+static ID_INLINE void SSE_LoadVertexes4( const idDrawVert *v0, const idDrawVert *v1, const idDrawVert *v2, const idDrawVert *v3,
+											__m128 &x, __m128 &y, __m128 &z, __m128 &s, __m128 &t ) {
+	x = _mm_loadu_ps( v0->xyz.ToFloatPtr() );
+	y = _mm_loadu_ps( v1->xyz.ToFloatPtr() );
+	z = _mm_loadu_ps( v2->xyz.ToFloatPtr() );
+	s = _mm_loadu_ps( v3->xyz.ToFloatPtr() );
+	_MM_TRANSPOSE4_PS( x, y, z, s );
+	t = _mm_setr_ps( v0->st[1], v1->st[1], v2->st[1], v3->st[1] );
+}
+
+typedef struct {
+	__m128	nt[4];		// normal and first tangent x
+	__m128	tt[4];		// first tangent y, z and second tangent x, y
+	ALIGN16( float t1z[4] );
+} sseTangentSpace4_t;
+
+/*
+============
+SSE_TransposeTangentSpace4
+
+  Transposes the normals and tangents of a block into the idDrawVert layout.
+============
+*/
+static ID_INLINE void SSE_TransposeTangentSpace4( sseTangentSpace4_t &out,
+													const __m128 nx, const __m128 ny, const __m128 nz,
+													const __m128 t0x, const __m128 t0y, const __m128 t0z,
+													const __m128 t1x, const __m128 t1y, const __m128 t1z ) {
+	out.nt[0] = nx;
+	out.nt[1] = ny;
+	out.nt[2] = nz;
+	out.nt[3] = t0x;
+	_MM_TRANSPOSE4_PS( out.nt[0], out.nt[1], out.nt[2], out.nt[3] );
+	out.tt[0] = t0y;
+	out.tt[1] = t0z;
+	out.tt[2] = t1x;
+	out.tt[3] = t1y;
+	_MM_TRANSPOSE4_PS( out.tt[0], out.tt[1], out.tt[2], out.tt[3] );
+	_mm_store_ps( out.t1z, t1z );
+}
+
+/*
+============
+idSIMD_SSE::DeriveTangents
+
+  Derives the normal and orthogonal tangent vectors for the triangle vertices.
+  For each vertex the normal and tangent vectors are derived from all triangles
+  using the vertex which results in smooth tangents across the mesh.
+  In the process the triangle planes are calculated as well.
+============
+*/
+void VPCALL idSIMD_SSE::DeriveTangents( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) {
+	const int numTris = numIndexes / 3;
+	const __m128 signBit = _mm_set1_ps( -0.0f );
+	const __m128 zero = _mm_setzero_ps();
+	sseTangentSpace4_t ts;
+	__m128 p[4];
+	int i, j, k;
+
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+	assert( ptrdiff_t(&verts->normal) - ptrdiff_t(verts) == DRAWVERT_NORMAL_OFFSET );
+	assert( ptrdiff_t(&verts->tangents[1]) - ptrdiff_t(verts) == DRAWVERT_TANGENT1_OFFSET );
+
+	// the face vectors are summed starting from zero which gives the same sums as
+	// initializing with the first face, except for vertexes that are not used
+	for ( i = 0; i < numVerts; i++ ) {
+		float *n = verts[i].normal.ToFloatPtr();
+		_mm_storeu_ps( n + 0, zero );
+		_mm_storeu_ps( n + 4, zero );
+		n[8] = 0.0f;
+	}
+
+	for ( i = 0; i < numTris; i += 4 ) {
+		const int numBlockTris = Min( numTris - i, 4 );
+		const int *tri[4];
+		__m128 ax, ay, az, as, at;
+		__m128 bx, by, bz, bs, bt;
+		__m128 cx, cy, cz, cs, ct;
+
+		// a partial block repeats its last triangle
+		for ( j = 0; j < 4; j++ ) {
+			tri[j] = indexes + ( i + Min( j, numBlockTris - 1 ) ) * 3;
+		}
+
+		SSE_LoadVertexes4( verts + tri[0][0], verts + tri[1][0], verts + tri[2][0], verts + tri[3][0], ax, ay, az, as, at );
+		SSE_LoadVertexes4( verts + tri[0][1], verts + tri[1][1], verts + tri[2][1], verts + tri[3][1], bx, by, bz, bs, bt );
+		SSE_LoadVertexes4( verts + tri[0][2], verts + tri[1][2], verts + tri[2][2], verts + tri[3][2], cx, cy, cz, cs, ct );
+
+		__m128 d0x = _mm_sub_ps( bx, ax );
+		__m128 d0y = _mm_sub_ps( by, ay );
+		__m128 d0z = _mm_sub_ps( bz, az );
+		__m128 d0s = _mm_sub_ps( bs, as );
+		__m128 d0t = _mm_sub_ps( bt, at );
+
+		__m128 d1x = _mm_sub_ps( cx, ax );
+		__m128 d1y = _mm_sub_ps( cy, ay );
+		__m128 d1z = _mm_sub_ps( cz, az );
+		__m128 d1s = _mm_sub_ps( cs, as );
+		__m128 d1t = _mm_sub_ps( ct, at );
+
+		// normal
+		__m128 nx = _mm_sub_ps( _mm_mul_ps( d1y, d0z ), _mm_mul_ps( d1z, d0y ) );
+		__m128 ny = _mm_sub_ps( _mm_mul_ps( d1z, d0x ), _mm_mul_ps( d1x, d0z ) );
+		__m128 nz = _mm_sub_ps( _mm_mul_ps( d1x, d0y ), _mm_mul_ps( d1y, d0x ) );
+
+		__m128 f = SSE_RSqrt( _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx, nx ), _mm_mul_ps( ny, ny ) ), _mm_mul_ps( nz, nz ) ) );
+		nx = _mm_mul_ps( nx, f );
+		ny = _mm_mul_ps( ny, f );
+		nz = _mm_mul_ps( nz, f );
+
+		// plane through the first vertex
+		p[0] = nx;
+		p[1] = ny;
+		p[2] = nz;
+		p[3] = _mm_xor_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx, ax ), _mm_mul_ps( ny, ay ) ), _mm_mul_ps( nz, az ) ), signBit );
+		_MM_TRANSPOSE4_PS( p[0], p[1], p[2], p[3] );
+		for ( j = 0; j < numBlockTris; j++ ) {
+			_mm_storeu_ps( planes[i + j].ToFloatPtr(), p[j] );
+		}
+
+		// area sign bit
+		__m128 area = _mm_sub_ps( _mm_mul_ps( d0s, d1t ), _mm_mul_ps( d0t, d1s ) );
+		__m128 sign = _mm_and_ps( area, signBit );
+
+		// first tangent
+		__m128 t0x = _mm_sub_ps( _mm_mul_ps( d0x, d1t ), _mm_mul_ps( d0t, d1x ) );
+		__m128 t0y = _mm_sub_ps( _mm_mul_ps( d0y, d1t ), _mm_mul_ps( d0t, d1y ) );
+		__m128 t0z = _mm_sub_ps( _mm_mul_ps( d0z, d1t ), _mm_mul_ps( d0t, d1z ) );
+
+		f = _mm_xor_ps( SSE_RSqrt( _mm_add_ps( _mm_add_ps( _mm_mul_ps( t0x, t0x ), _mm_mul_ps( t0y, t0y ) ), _mm_mul_ps( t0z, t0z ) ) ), sign );
+		t0x = _mm_mul_ps( t0x, f );
+		t0y = _mm_mul_ps( t0y, f );
+		t0z = _mm_mul_ps( t0z, f );
+
+		// second tangent
+		__m128 t1x = _mm_sub_ps( _mm_mul_ps( d0s, d1x ), _mm_mul_ps( d0x, d1s ) );
+		__m128 t1y = _mm_sub_ps( _mm_mul_ps( d0s, d1y ), _mm_mul_ps( d0y, d1s ) );
+		__m128 t1z = _mm_sub_ps( _mm_mul_ps( d0s, d1z ), _mm_mul_ps( d0z, d1s ) );
+
+		f = _mm_xor_ps( SSE_RSqrt( _mm_add_ps( _mm_add_ps( _mm_mul_ps( t1x, t1x ), _mm_mul_ps( t1y, t1y ) ), _mm_mul_ps( t1z, t1z ) ) ), sign );
+		t1x = _mm_mul_ps( t1x, f );
+		t1y = _mm_mul_ps( t1y, f );
+		t1z = _mm_mul_ps( t1z, f );
+
+		SSE_TransposeTangentSpace4( ts, nx, ny, nz, t0x, t0y, t0z, t1x, t1y, t1z );
+
+		// add to the vertexes in triangle order, vertexes may be shared within the block
+		for ( j = 0; j < numBlockTris; j++ ) {
+			for ( k = 0; k < 3; k++ ) {
+				float *n = verts[tri[j][k]].normal.ToFloatPtr();
+				_mm_storeu_ps( n + 0, _mm_add_ps( _mm_loadu_ps( n + 0 ), ts.nt[j] ) );
+				_mm_storeu_ps( n + 4, _mm_add_ps( _mm_loadu_ps( n + 4 ), ts.tt[j] ) );
+				n[8] += ts.t1z[j];
+			}
+		}
+	}
+}
+
+/*
+============
+idSIMD_SSE::DeriveUnsmoothedTangents
+
+  Derives the normal and orthogonal tangent vectors for the triangle vertices.
+  For each vertex the normal and tangent vectors are derived from a single dominant triangle.
+  The bitangent is derived from the normal and tangent like the generic code does.
+============
+*/
+void VPCALL idSIMD_SSE::DeriveUnsmoothedTangents( idDrawVert *verts, const dominantTri_s *dominantTris, const int numVerts ) {
+	sseTangentSpace4_t ts;
+	int i, j;
+
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+	assert( ptrdiff_t(&verts->normal) - ptrdiff_t(verts) == DRAWVERT_NORMAL_OFFSET );
+
+	for ( i = 0; i < numVerts; i += 4 ) {
+		const int numBlockVerts = Min( numVerts - i, 4 );
+		int a[4];
+		__m128 ax, ay, az, as, at;
+		__m128 bx, by, bz, bs, bt;
+		__m128 cx, cy, cz, cs, ct;
+
+		// a partial block repeats its last vertex
+		for ( j = 0; j < 4; j++ ) {
+			a[j] = i + Min( j, numBlockVerts - 1 );
+		}
+
+		const dominantTri_s &dt0 = dominantTris[a[0]];
+		const dominantTri_s &dt1 = dominantTris[a[1]];
+		const dominantTri_s &dt2 = dominantTris[a[2]];
+		const dominantTri_s &dt3 = dominantTris[a[3]];
+
+		SSE_LoadVertexes4( verts + a[0], verts + a[1], verts + a[2], verts + a[3], ax, ay, az, as, at );
+		SSE_LoadVertexes4( verts + dt0.v2, verts + dt1.v2, verts + dt2.v2, verts + dt3.v2, bx, by, bz, bs, bt );
+		SSE_LoadVertexes4( verts + dt0.v3, verts + dt1.v3, verts + dt2.v3, verts + dt3.v3, cx, cy, cz, cs, ct );
+
+		__m128 s0 = _mm_setr_ps( dt0.normalizationScale[0], dt1.normalizationScale[0], dt2.normalizationScale[0], dt3.normalizationScale[0] );
+		__m128 s1 = _mm_setr_ps( dt0.normalizationScale[1], dt1.normalizationScale[1], dt2.normalizationScale[1], dt3.normalizationScale[1] );
+		__m128 s2 = _mm_setr_ps( dt0.normalizationScale[2], dt1.normalizationScale[2], dt2.normalizationScale[2], dt3.normalizationScale[2] );
+
+		__m128 d0 = _mm_sub_ps( bx, ax );
+		__m128 d1 = _mm_sub_ps( by, ay );
+		__m128 d2 = _mm_sub_ps( bz, az );
+		__m128 d4 = _mm_sub_ps( bt, at );
+
+		__m128 d5 = _mm_sub_ps( cx, ax );
+		__m128 d6 = _mm_sub_ps( cy, ay );
+		__m128 d7 = _mm_sub_ps( cz, az );
+		__m128 d9 = _mm_sub_ps( ct, at );
+
+		__m128 n0 = _mm_mul_ps( s2, _mm_sub_ps( _mm_mul_ps( d6, d2 ), _mm_mul_ps( d7, d1 ) ) );
+		__m128 n1 = _mm_mul_ps( s2, _mm_sub_ps( _mm_mul_ps( d7, d0 ), _mm_mul_ps( d5, d2 ) ) );
+		__m128 n2 = _mm_mul_ps( s2, _mm_sub_ps( _mm_mul_ps( d5, d1 ), _mm_mul_ps( d6, d0 ) ) );
+
+		__m128 t0 = _mm_mul_ps( s0, _mm_sub_ps( _mm_mul_ps( d0, d9 ), _mm_mul_ps( d4, d5 ) ) );
+		__m128 t1 = _mm_mul_ps( s0, _mm_sub_ps( _mm_mul_ps( d1, d9 ), _mm_mul_ps( d4, d6 ) ) );
+		__m128 t2 = _mm_mul_ps( s0, _mm_sub_ps( _mm_mul_ps( d2, d9 ), _mm_mul_ps( d4, d7 ) ) );
+
+		__m128 t3 = _mm_mul_ps( s1, _mm_sub_ps( _mm_mul_ps( n2, t1 ), _mm_mul_ps( n1, t2 ) ) );
+		__m128 t4 = _mm_mul_ps( s1, _mm_sub_ps( _mm_mul_ps( n0, t2 ), _mm_mul_ps( n2, t0 ) ) );
+		__m128 t5 = _mm_mul_ps( s1, _mm_sub_ps( _mm_mul_ps( n1, t0 ), _mm_mul_ps( n0, t1 ) ) );
+
+		SSE_TransposeTangentSpace4( ts, n0, n1, n2, t0, t1, t2, t3, t4, t5 );
+
+		// only the normal and tangents are written, which the other vertexes of the block don't read
+		for ( j = 0; j < numBlockVerts; j++ ) {
+			float *n = verts[i + j].normal.ToFloatPtr();
+			_mm_storeu_ps( n + 0, ts.nt[j] );
+			_mm_storeu_ps( n + 4, ts.tt[j] );
+			n[8] = ts.t1z[j];
+		}
+	}
+}
+
+/*
+============
+idSIMD_SSE::NormalizeTangents
+
+  Normalizes each vertex normal and projects and normalizes the
+  tangent vectors onto the plane orthogonal to the vertex normal.
+============
+*/
+void VPCALL idSIMD_SSE::NormalizeTangents( idDrawVert *verts, const int numVerts ) {
+	sseTangentSpace4_t ts;
+	int i, j;
+
+	assert( sizeof( idDrawVert ) == DRAWVERT_SIZE );
+	assert( ptrdiff_t(&verts->normal) - ptrdiff_t(verts) == DRAWVERT_NORMAL_OFFSET );
+
+	for ( i = 0; i < numVerts; i += 4 ) {
+		const int numBlockVerts = Min( numVerts - i, 4 );
+		const float *src[4];
+
+		// a partial block repeats its last vertex
+		for ( j = 0; j < 4; j++ ) {
+			src[j] = verts[i + Min( j, numBlockVerts - 1 )].normal.ToFloatPtr();
+		}
+
+		__m128 nx = _mm_loadu_ps( src[0] + 0 );
+		__m128 ny = _mm_loadu_ps( src[1] + 0 );
+		__m128 nz = _mm_loadu_ps( src[2] + 0 );
+		__m128 t0x = _mm_loadu_ps( src[3] + 0 );
+		_MM_TRANSPOSE4_PS( nx, ny, nz, t0x );
+
+		__m128 t0y = _mm_loadu_ps( src[0] + 4 );
+		__m128 t0z = _mm_loadu_ps( src[1] + 4 );
+		__m128 t1x = _mm_loadu_ps( src[2] + 4 );
+		__m128 t1y = _mm_loadu_ps( src[3] + 4 );
+		_MM_TRANSPOSE4_PS( t0y, t0z, t1x, t1y );
+
+		__m128 t1z = _mm_setr_ps( src[0][8], src[1][8], src[2][8], src[3][8] );
+
+		__m128 f = SSE_RSqrt( _mm_add_ps( _mm_add_ps( _mm_mul_ps( nx, nx ), _mm_mul_ps( ny, ny ) ), _mm_mul_ps( nz, nz ) ) );
+		nx = _mm_mul_ps( nx, f );
+		ny = _mm_mul_ps( ny, f );
+		nz = _mm_mul_ps( nz, f );
+
+		__m128 d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( t0x, nx ), _mm_mul_ps( t0y, ny ) ), _mm_mul_ps( t0z, nz ) );
+		t0x = _mm_sub_ps( t0x, _mm_mul_ps( d, nx ) );
+		t0y = _mm_sub_ps( t0y, _mm_mul_ps( d, ny ) );
+		t0z = _mm_sub_ps( t0z, _mm_mul_ps( d, nz ) );
+		f = SSE_RSqrt( _mm_add_ps( _mm_add_ps( _mm_mul_ps( t0x, t0x ), _mm_mul_ps( t0y, t0y ) ), _mm_mul_ps( t0z, t0z ) ) );
+		t0x = _mm_mul_ps( t0x, f );
+		t0y = _mm_mul_ps( t0y, f );
+		t0z = _mm_mul_ps( t0z, f );
+
+		d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( t1x, nx ), _mm_mul_ps( t1y, ny ) ), _mm_mul_ps( t1z, nz ) );
+		t1x = _mm_sub_ps( t1x, _mm_mul_ps( d, nx ) );
+		t1y = _mm_sub_ps( t1y, _mm_mul_ps( d, ny ) );
+		t1z = _mm_sub_ps( t1z, _mm_mul_ps( d, nz ) );
+		f = SSE_RSqrt( _mm_add_ps( _mm_add_ps( _mm_mul_ps( t1x, t1x ), _mm_mul_ps( t1y, t1y ) ), _mm_mul_ps( t1z, t1z ) ) );
+		t1x = _mm_mul_ps( t1x, f );
+		t1y = _mm_mul_ps( t1y, f );
+		t1z = _mm_mul_ps( t1z, f );
+
+		SSE_TransposeTangentSpace4( ts, nx, ny, nz, t0x, t0y, t0z, t1x, t1y, t1z );
+
+		for ( j = 0; j < numBlockVerts; j++ ) {
+			float *n = verts[i + j].normal.ToFloatPtr();
+			_mm_storeu_ps( n + 0, ts.nt[j] );
+			_mm_storeu_ps( n + 4, ts.tt[j] );
+			n[8] = ts.t1z[j];
+		}
+	}
+}
+
 #elif defined(_MSC_VER) && defined(_M_IX86)
 
 #include <xmmintrin.h>
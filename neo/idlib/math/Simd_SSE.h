@@ -48,6 +48,10 @@ public:
 	virtual	void VPCALL MinMax( idVec3 &min,		idVec3 &max,			const idDrawVert *src,	const int *indexes,		const int count );
 	virtual void VPCALL Dot( float *dst,			const idVec3 &constant,	const idPlane *src,		const int count );
 
+	virtual void VPCALL DeriveTangents( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes );
+	virtual void VPCALL DeriveUnsmoothedTangents( idDrawVert *verts, const dominantTri_s *dominantTris, const int numVerts );
+	virtual void VPCALL NormalizeTangents( idDrawVert *verts, const int numVerts );
+
 #elif defined(_MSC_VER) && defined(_M_IX86)
 	virtual const char * VPCALL GetName( void ) const;
 
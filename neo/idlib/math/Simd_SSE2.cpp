@@ -244,6 +244,396 @@ void VPCALL idSIMD_SSE2::CmpLT( byte *dst, const byte bitNum, const float *src0,
 	}
 }
 
+/*
+============
+idSIMD_SSE2::ShadowPointCull
+
+  Four vertices are classified at a time. The xyz of each vertex is loaded
+  unaligned (the 4th float is st[0] and ignored), the 4x4 block is transposed
+  so every plane test becomes three multiply-adds and two compares, and the
+  compare masks are and'ed with the bit values to build the cull bits in
+  32 bit lanes before they are packed down to shorts.
+============
+*/
+void VPCALL idSIMD_SSE2::ShadowPointCull( unsigned short *pointCull, const int frontBits, const float epsilon, const idPlane *planes, const idDrawVert *verts, const int numVerts ) {
+	int i, j, numPlanes;
+	__m128 planeA[6], planeB[6], planeC[6], planeD[6];
+	__m128i planeBitsLT[6], planeBitsGT[6];
+
+	// gather the planes that still need testing
+	numPlanes = 0;
+	for ( j = 0; j < 6; j++ ) {
+		if ( frontBits & ( 1 << ( j + 6 ) ) ) {
+			continue;
+		}
+		planeA[numPlanes] = _mm_set1_ps( planes[j][0] );
+		planeB[numPlanes] = _mm_set1_ps( planes[j][1] );
+		planeC[numPlanes] = _mm_set1_ps( planes[j][2] );
+		planeD[numPlanes] = _mm_set1_ps( planes[j][3] );
+		planeBitsLT[numPlanes] = _mm_set1_epi32( 1 << j );
+		planeBitsGT[numPlanes] = _mm_set1_epi32( 1 << ( j + 6 ) );
+		numPlanes++;
+	}
+
+	const __m128 posEpsilon = _mm_set1_ps( epsilon );
+	const __m128 negEpsilon = _mm_set1_ps( -epsilon );
+	const __m128i front = _mm_set1_epi32( frontBits );
+
+	for ( i = 0; i + 4 <= numVerts; i += 4 ) {
+		__m128 x = _mm_loadu_ps( verts[i+0].xyz.ToFloatPtr() );
+		__m128 y = _mm_loadu_ps( verts[i+1].xyz.ToFloatPtr() );
+		__m128 z = _mm_loadu_ps( verts[i+2].xyz.ToFloatPtr() );
+		__m128 w = _mm_loadu_ps( verts[i+3].xyz.ToFloatPtr() );
+		_MM_TRANSPOSE4_PS( x, y, z, w );
+
+		__m128i bits = front;
+		for ( j = 0; j < numPlanes; j++ ) {
+			// same evaluation order as idPlane::Distance so both paths agree on the epsilon boundary
+			__m128 d = _mm_add_ps( _mm_mul_ps( x, planeA[j] ), _mm_mul_ps( y, planeB[j] ) );
+			d = _mm_add_ps( _mm_add_ps( d, _mm_mul_ps( z, planeC[j] ) ), planeD[j] );
+			__m128i lt = _mm_castps_si128( _mm_cmplt_ps( d, posEpsilon ) );
+			__m128i gt = _mm_castps_si128( _mm_cmpgt_ps( d, negEpsilon ) );
+			bits = _mm_or_si128( bits, _mm_and_si128( lt, planeBitsLT[j] ) );
+			bits = _mm_or_si128( bits, _mm_and_si128( gt, planeBitsGT[j] ) );
+		}
+
+		// all bits fit in 12 bits so the signed saturation never kicks in
+		_mm_storel_epi64( (__m128i *)( pointCull + i ), _mm_packs_epi32( bits, bits ) );
+	}
+
+	for ( ; i < numVerts; i++ ) {
+		const idVec3 &v = verts[i].xyz;
+		int bits = frontBits;
+
+		for ( j = 0; j < 6; j++ ) {
+			if ( frontBits & ( 1 << ( j + 6 ) ) ) {
+				continue;
+			}
+			float d = planes[j].Distance( v );
+			bits |= ( d < epsilon ) << j;
+			bits |= ( d > -epsilon ) << ( j + 6 );
+		}
+
+		pointCull[i] = bits;
+	}
+}
+
+/*
+============
+SSE2_RSqrtFast
+
+  idMath::RSqrt for four values, bit identical to the scalar version.
+============
+*/
+static inline __m128 SSE2_RSqrtFast( const __m128 x ) {
+	__m128 y = _mm_mul_ps( x, _mm_set1_ps( 0.5f ) );
+	__m128 r = _mm_castsi128_ps( _mm_sub_epi32( _mm_set1_epi32( 0x5f3759df ), _mm_srai_epi32( _mm_castps_si128( x ), 1 ) ) );
+	return _mm_mul_ps( r, _mm_sub_ps( _mm_set1_ps( 1.5f ), _mm_mul_ps( _mm_mul_ps( r, r ), y ) ) );
+}
+
+/*
+============
+SSE2_NormalToPixels
+
+  Packs four normals into RGBA pixels the way ( byte )( n * 127 + 128 ) does.
+============
+*/
+static inline __m128i SSE2_NormalToPixels( const __m128 x, const __m128 y, const __m128 z, const __m128i alpha ) {
+	const __m128 scale = _mm_set1_ps( 127.0f );
+	const __m128 bias = _mm_set1_ps( 128.0f );
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 max = _mm_set1_ps( 255.0f );
+
+	__m128i r = _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( _mm_add_ps( _mm_mul_ps( x, scale ), bias ), zero ), max ) );
+	__m128i g = _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( _mm_add_ps( _mm_mul_ps( y, scale ), bias ), zero ), max ) );
+	__m128i b = _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( _mm_add_ps( _mm_mul_ps( z, scale ), bias ), zero ), max ) );
+	return _mm_or_si128( _mm_or_si128( r, _mm_slli_epi32( g, 8 ) ), _mm_or_si128( _mm_slli_epi32( b, 16 ), alpha ) );
+}
+
+/*
+============
+SSE2_LoadHeights
+
+  Loads the heights of columns x to x + 3 of a wrapping row as floats.
+============
+*/
+static inline __m128 SSE2_LoadHeights( const byte *row, const int x, const int width ) {
+	__m128i h;
+
+	if ( x + 4 <= width ) {
+		int bytes;
+		memcpy( &bytes, row + x, 4 );
+		h = _mm_cvtsi32_si128( bytes );
+		h = _mm_unpacklo_epi16( _mm_unpacklo_epi8( h, _mm_setzero_si128() ), _mm_setzero_si128() );
+	} else {
+		const int mask = width - 1;
+		h = _mm_setr_epi32( row[( x + 0 ) & mask], row[( x + 1 ) & mask], row[( x + 2 ) & mask], row[( x + 3 ) & mask] );
+	}
+	return _mm_cvtepi32_ps( h );
+}
+
+/*
+============
+SSE2_LoadPixels
+
+  Loads pixels x to x + 3 of a wrapping row.
+============
+*/
+static inline __m128i SSE2_LoadPixels( const byte *row, const int x, const int width ) {
+	if ( x >= 0 && x + 4 <= width ) {
+		return _mm_loadu_si128( (const __m128i *)( row + x * 4 ) );
+	}
+	const int *pixels = (const int *)row;
+	const int mask = width - 1;
+	return _mm_setr_epi32( pixels[( x + 0 ) & mask], pixels[( x + 1 ) & mask], pixels[( x + 2 ) & mask], pixels[( x + 3 ) & mask] );
+}
+
+/*
+============
+idSIMD_SSE2::MipMapImage
+
+  Four output pixels at a time, the 16 bit sums give the same result as the generic code.
+============
+*/
+void VPCALL idSIMD_SSE2::MipMapImage( byte *dst, const byte *src, const int width, const int height ) {
+	const int row = width * 4;
+	const int outWidth = width >> 1;
+	const int outHeight = height >> 1;
+	const __m128i zero = _mm_setzero_si128();
+
+	if ( outWidth & 3 ) {
+		idSIMD_Generic::MipMapImage( dst, src, width, height );
+		return;
+	}
+
+	for ( int i = 0; i < outHeight; i++ ) {
+		const byte *in0 = src + i * 2 * row;
+		const byte *in1 = in0 + row;
+		byte *out = dst + i * outWidth * 4;
+
+		for ( int j = 0; j < outWidth; j += 4, in0 += 32, in1 += 32, out += 16 ) {
+			__m128i a0 = _mm_loadu_si128( (const __m128i *)( in0 + 0 ) );
+			__m128i a1 = _mm_loadu_si128( (const __m128i *)( in0 + 16 ) );
+			__m128i b0 = _mm_loadu_si128( (const __m128i *)( in1 + 0 ) );
+			__m128i b1 = _mm_loadu_si128( (const __m128i *)( in1 + 16 ) );
+
+			// vertical sums of the pixel pairs 0 1, 2 3, 4 5 and 6 7
+			__m128i s01 = _mm_add_epi16( _mm_unpacklo_epi8( a0, zero ), _mm_unpacklo_epi8( b0, zero ) );
+			__m128i s23 = _mm_add_epi16( _mm_unpackhi_epi8( a0, zero ), _mm_unpackhi_epi8( b0, zero ) );
+			__m128i s45 = _mm_add_epi16( _mm_unpacklo_epi8( a1, zero ), _mm_unpacklo_epi8( b1, zero ) );
+			__m128i s67 = _mm_add_epi16( _mm_unpackhi_epi8( a1, zero ), _mm_unpackhi_epi8( b1, zero ) );
+
+			// horizontal sums
+			__m128i r0 = _mm_add_epi16( _mm_unpacklo_epi64( s01, s23 ), _mm_unpackhi_epi64( s01, s23 ) );
+			__m128i r1 = _mm_add_epi16( _mm_unpacklo_epi64( s45, s67 ), _mm_unpackhi_epi64( s45, s67 ) );
+
+			r0 = _mm_srli_epi16( r0, 2 );
+			r1 = _mm_srli_epi16( r1, 2 );
+			_mm_storeu_si128( (__m128i *)out, _mm_packus_epi16( r0, r1 ) );
+		}
+	}
+}
+
+/*
+============
+idSIMD_SSE2::ResampleImageRow
+============
+*/
+void VPCALL idSIMD_SSE2::ResampleImageRow( byte *dst, const byte *row1, const byte *row2, const unsigned int *offsets1, const unsigned int *offsets2, const int numPixels ) {
+	const __m128i zero = _mm_setzero_si128();
+	int j;
+
+	for ( j = 0; j + 4 <= numPixels; j += 4 ) {
+		const unsigned int *o1 = offsets1 + j;
+		const unsigned int *o2 = offsets2 + j;
+		int p[4][4];
+
+		for ( int k = 0; k < 4; k++ ) {
+			memcpy( &p[0][k], row1 + o1[k], 4 );
+			memcpy( &p[1][k], row1 + o2[k], 4 );
+			memcpy( &p[2][k], row2 + o1[k], 4 );
+			memcpy( &p[3][k], row2 + o2[k], 4 );
+		}
+		__m128i v1 = _mm_loadu_si128( (const __m128i *)p[0] );
+		__m128i v2 = _mm_loadu_si128( (const __m128i *)p[1] );
+		__m128i v3 = _mm_loadu_si128( (const __m128i *)p[2] );
+		__m128i v4 = _mm_loadu_si128( (const __m128i *)p[3] );
+
+		__m128i lo = _mm_add_epi16( _mm_add_epi16( _mm_unpacklo_epi8( v1, zero ), _mm_unpacklo_epi8( v2, zero ) ),
+									_mm_add_epi16( _mm_unpacklo_epi8( v3, zero ), _mm_unpacklo_epi8( v4, zero ) ) );
+		__m128i hi = _mm_add_epi16( _mm_add_epi16( _mm_unpackhi_epi8( v1, zero ), _mm_unpackhi_epi8( v2, zero ) ),
+									_mm_add_epi16( _mm_unpackhi_epi8( v3, zero ), _mm_unpackhi_epi8( v4, zero ) ) );
+
+		_mm_storeu_si128( (__m128i *)( dst + j * 4 ), _mm_packus_epi16( _mm_srli_epi16( lo, 2 ), _mm_srli_epi16( hi, 2 ) ) );
+	}
+
+	if ( j < numPixels ) {
+		idSIMD_Generic::ResampleImageRow( dst + j * 4, row1, row2, offsets1 + j, offsets2 + j, numPixels - j );
+	}
+}
+
+/*
+============
+idSIMD_SSE2::HeightmapToNormalMap
+
+  Four pixels at a time with the same operations as the generic code, the
+  wrapping columns are gathered one by one.
+============
+*/
+void VPCALL idSIMD_SSE2::HeightmapToNormalMap( byte *dst, const byte *heights, const int width, const int height, const float scale ) {
+	if ( width & 3 ) {
+		idSIMD_Generic::HeightmapToNormalMap( dst, heights, width, height, scale );
+		return;
+	}
+
+	const __m128 s = _mm_set1_ps( scale );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128i alpha = _mm_set1_epi32( 0xFF000000 );
+
+	for ( int i = 0; i < height; i++ ) {
+		const byte *row1 = heights + i * width;
+		const byte *row2 = heights + ( ( i + 1 ) & ( height - 1 ) ) * width;
+		byte *out = dst + i * width * 4;
+
+		for ( int j = 0; j < width; j += 4, out += 16 ) {
+			__m128 d1 = SSE2_LoadHeights( row1, j, width );
+			__m128 d2 = SSE2_LoadHeights( row1, j + 1, width );
+			__m128 d3 = SSE2_LoadHeights( row2, j, width );
+			__m128 d4 = SSE2_LoadHeights( row2, j + 1, width );
+
+			// dir = ( d1 - d2, d1 - d3, 1 ) * scale, normalized
+			__m128 x1 = _mm_mul_ps( _mm_sub_ps( d1, d2 ), s );
+			__m128 y1 = _mm_mul_ps( _mm_sub_ps( d1, d3 ), s );
+			__m128 r1 = SSE2_RSqrtFast( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x1, x1 ), _mm_mul_ps( y1, y1 ) ), one ) );
+			x1 = _mm_mul_ps( x1, r1 );
+			y1 = _mm_mul_ps( y1, r1 );
+
+			// dir2 = ( d3 - d4, d1 - d3, 1 ) * scale, normalized
+			__m128 x2 = _mm_mul_ps( _mm_sub_ps( d3, d4 ), s );
+			__m128 y2 = _mm_mul_ps( _mm_sub_ps( d1, d3 ), s );
+			__m128 r2 = SSE2_RSqrtFast( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x2, x2 ), _mm_mul_ps( y2, y2 ) ), one ) );
+			x2 = _mm_mul_ps( x2, r2 );
+			y2 = _mm_mul_ps( y2, r2 );
+
+			__m128 x = _mm_add_ps( x1, x2 );
+			__m128 y = _mm_add_ps( y1, y2 );
+			__m128 z = _mm_add_ps( r1, r2 );
+			__m128 r = SSE2_RSqrtFast( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) ) );
+
+			_mm_storeu_si128( (__m128i *)out, SSE2_NormalToPixels( _mm_mul_ps( x, r ), _mm_mul_ps( y, r ), _mm_mul_ps( z, r ), alpha ) );
+		}
+	}
+}
+
+/*
+============
+idSIMD_SSE2::AddNormalMaps
+
+  Can differ by one from the generic code, which mixes in double precision
+  and uses the table based idMath::InvSqrt.
+============
+*/
+void VPCALL idSIMD_SSE2::AddNormalMaps( byte *dst, const byte *src, const int numPixels ) {
+	const __m128i byteMask = _mm_set1_epi32( 0xFF );
+	const __m128i bias = _mm_set1_epi32( 128 );
+	const __m128 divisor = _mm_set1_ps( 127.0f );
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps( 1.0f );
+	const __m128 tiny = _mm_set1_ps( 1e-30f );
+	const __m128i alpha = _mm_set1_epi32( 0xFF000000 );
+	int i;
+
+	for ( i = 0; i + 4 <= numPixels; i += 4 ) {
+		__m128i p1 = _mm_loadu_si128( (const __m128i *)( dst + i * 4 ) );
+		__m128i p2 = _mm_loadu_si128( (const __m128i *)( src + i * 4 ) );
+
+		__m128 x = _mm_div_ps( _mm_cvtepi32_ps( _mm_sub_epi32( _mm_and_si128( p1, byteMask ), bias ) ), divisor );
+		__m128 y = _mm_div_ps( _mm_cvtepi32_ps( _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( p1, 8 ), byteMask ), bias ) ), divisor );
+		__m128 z = _mm_div_ps( _mm_cvtepi32_ps( _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( p1, 16 ), byteMask ), bias ) ), divisor );
+
+		// fade normals that blend to 0,0,0 to 0,0,1 instead
+		__m128 xx = _mm_mul_ps( x, x );
+		__m128 yy = _mm_mul_ps( y, y );
+		__m128 sqrLength = _mm_add_ps( _mm_add_ps( xx, yy ), _mm_mul_ps( z, z ) );
+		__m128 short1 = _mm_cmplt_ps( _mm_mul_ps( sqrLength, SSE2_RSqrtFast( sqrLength ) ), one );
+		__m128 fixedZ = _mm_sqrt_ps( _mm_min_ps( _mm_max_ps( _mm_sub_ps( _mm_sub_ps( one, xx ), yy ), zero ), one ) );
+		z = _mm_or_ps( _mm_and_ps( short1, fixedZ ), _mm_andnot_ps( short1, z ) );
+
+		x = _mm_add_ps( x, _mm_div_ps( _mm_cvtepi32_ps( _mm_sub_epi32( _mm_and_si128( p2, byteMask ), bias ) ), divisor ) );
+		y = _mm_add_ps( y, _mm_div_ps( _mm_cvtepi32_ps( _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( p2, 8 ), byteMask ), bias ) ), divisor ) );
+
+		sqrLength = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) );
+		__m128 r = _mm_div_ps( one, _mm_sqrt_ps( _mm_max_ps( sqrLength, tiny ) ) );
+
+		_mm_storeu_si128( (__m128i *)( dst + i * 4 ), SSE2_NormalToPixels( _mm_mul_ps( x, r ), _mm_mul_ps( y, r ), _mm_mul_ps( z, r ), alpha ) );
+	}
+
+	if ( i < numPixels ) {
+		idSIMD_Generic::AddNormalMaps( dst + i * 4, src + i * 4, numPixels - i );
+	}
+}
+
+/*
+============
+idSIMD_SSE2::SmoothNormalMap
+
+  Four pixels at a time.  The sums are done with integers, which is exact,
+  but the normalization can differ by one from the table based idMath::InvSqrt.
+============
+*/
+void VPCALL idSIMD_SSE2::SmoothNormalMap( byte *dst, const byte *src, const int width, const int height ) {
+	if ( width & 3 ) {
+		idSIMD_Generic::SmoothNormalMap( dst, src, width, height );
+		return;
+	}
+
+	const __m128i byteMask = _mm_set1_epi32( 0xFF );
+	const __m128i rgbMask = _mm_set1_epi32( 0x00FFFFFF );
+	const __m128i grey = _mm_set1_epi32( 0x00808080 );
+	const __m128i bias = _mm_set1_epi32( 128 );
+	const __m128i alphaMask = _mm_set1_epi32( 0xFF000000 );
+	const __m128 tiny = _mm_set1_ps( 1e-30f );
+	const __m128 one = _mm_set1_ps( 1.0f );
+
+	for ( int j = 0; j < height; j++ ) {
+		const byte *rows[3];
+		rows[0] = src + ( ( j - 1 ) & ( height - 1 ) ) * width * 4;
+		rows[1] = src + j * width * 4;
+		rows[2] = src + ( ( j + 1 ) & ( height - 1 ) ) * width * 4;
+		byte *out = dst + j * width * 4;
+
+		for ( int i = 0; i < width; i += 4, out += 16 ) {
+			__m128i sumX = _mm_setzero_si128();
+			__m128i sumY = _mm_setzero_si128();
+			__m128i sumZ = _mm_setzero_si128();
+
+			for ( int k = -1; k < 2; k++ ) {
+				for ( int l = 0; l < 3; l++ ) {
+					__m128i p = SSE2_LoadPixels( rows[l], i + k, width );
+
+					// ignore 000 and -1 -1 -1
+					__m128i rgb = _mm_and_si128( p, rgbMask );
+					__m128i ignore = _mm_or_si128( _mm_cmpeq_epi32( rgb, _mm_setzero_si128() ), _mm_cmpeq_epi32( rgb, grey ) );
+
+					sumX = _mm_add_epi32( sumX, _mm_andnot_si128( ignore, _mm_sub_epi32( _mm_and_si128( p, byteMask ), bias ) ) );
+					sumY = _mm_add_epi32( sumY, _mm_andnot_si128( ignore, _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( p, 8 ), byteMask ), bias ) ) );
+					sumZ = _mm_add_epi32( sumZ, _mm_andnot_si128( ignore, _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( p, 16 ), byteMask ), bias ) ) );
+				}
+			}
+
+			__m128 x = _mm_cvtepi32_ps( sumX );
+			__m128 y = _mm_cvtepi32_ps( sumY );
+			__m128 z = _mm_cvtepi32_ps( sumZ );
+			__m128 sqrLength = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ), _mm_mul_ps( z, z ) );
+			__m128 r = _mm_div_ps( one, _mm_sqrt_ps( _mm_max_ps( sqrLength, tiny ) ) );
+
+			// keep the alpha of dst
+			__m128i a = _mm_and_si128( _mm_loadu_si128( (const __m128i *)out ), alphaMask );
+			_mm_storeu_si128( (__m128i *)out, SSE2_NormalToPixels( _mm_mul_ps( x, r ), _mm_mul_ps( y, r ), _mm_mul_ps( z, r ), a ) );
+		}
+	}
+}
+
 #elif defined(_MSC_VER) && defined(_M_IX86)
 
 #include <xmmintrin.h>
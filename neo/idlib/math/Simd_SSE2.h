@@ -45,6 +45,14 @@ public:
 	virtual const char * VPCALL GetName( void ) const;
 	virtual void VPCALL CmpLT( byte *dst,			const byte bitNum,		const float *src0,		const float constant,	const int count );
 
+	virtual void VPCALL ShadowPointCull( unsigned short *pointCull, const int frontBits, const float epsilon, const idPlane *planes, const idDrawVert *verts, const int numVerts );
+
+	virtual void VPCALL MipMapImage( byte *dst, const byte *src, const int width, const int height );
+	virtual void VPCALL ResampleImageRow( byte *dst, const byte *row1, const byte *row2, const unsigned int *offsets1, const unsigned int *offsets2, const int numPixels );
+	virtual void VPCALL HeightmapToNormalMap( byte *dst, const byte *heights, const int width, const int height, const float scale );
+	virtual void VPCALL AddNormalMaps( byte *dst, const byte *src, const int numPixels );
+	virtual void VPCALL SmoothNormalMap( byte *dst, const byte *src, const int width, const int height );
+
 #elif defined(_MSC_VER) && defined(_M_IX86)
 	virtual const char * VPCALL GetName( void ) const;
 
@@ -0,0 +1,369 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+#include "tr_local.h"
+
+static const int AREA_REF_TREE_MAX_DEPTH	= 256;
+
+/*
+================
+AreaRefTree_Cost
+
+Surface area heuristic, half of the surface area of the bounds.
+================
+*/
+static ID_INLINE float AreaRefTree_Cost( const idBounds &bounds ) {
+	const idVec3 size = bounds[1] - bounds[0];
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+/*
+================
+idAreaRefTree::Init
+================
+*/
+void idAreaRefTree::Init( void ) {
+	nodes = NULL;
+	numNodes = 0;
+	maxNodes = 0;
+	freeNode = -1;
+	root = -1;
+	numLeafs = 0;
+}
+
+/*
+================
+idAreaRefTree::Shutdown
+================
+*/
+void idAreaRefTree::Shutdown( void ) {
+	Mem_Free( nodes );
+	Init();
+}
+
+/*
+================
+idAreaRefTree::AllocNode
+
+Can move the nodes, so no node pointers may be held across a call.
+================
+*/
+int idAreaRefTree::AllocNode( void ) {
+	int nodeNum;
+
+	if ( freeNode != -1 ) {
+		nodeNum = freeNode;
+		freeNode = nodes[nodeNum].parent;
+	} else {
+		if ( numNodes == maxNodes ) {
+			maxNodes = maxNodes ? maxNodes * 2 : 16;
+			areaRefTreeNode_t *newNodes = (areaRefTreeNode_t *)Mem_Alloc( maxNodes * sizeof( nodes[0] ) );
+			if ( nodes ) {
+				memcpy( newNodes, nodes, numNodes * sizeof( nodes[0] ) );
+				Mem_Free( nodes );
+			}
+			nodes = newNodes;
+		}
+		nodeNum = numNodes++;
+	}
+
+	areaRefTreeNode_t &node = nodes[nodeNum];
+	node.parent = -1;
+	node.children[0] = -1;
+	node.children[1] = -1;
+	node.height = 0;
+	node.ref = NULL;
+	return nodeNum;
+}
+
+/*
+================
+idAreaRefTree::FreeNode
+================
+*/
+void idAreaRefTree::FreeNode( int nodeNum ) {
+	nodes[nodeNum].parent = freeNode;
+	nodes[nodeNum].height = -1;
+	nodes[nodeNum].ref = NULL;
+	freeNode = nodeNum;
+}
+
+/*
+================
+idAreaRefTree::Insert
+================
+*/
+int idAreaRefTree::Insert( areaReference_t *ref, const idBounds &bounds ) {
+	int leaf = AllocNode();
+
+	nodes[leaf].bounds = bounds;
+	nodes[leaf].ref = ref;
+	InsertLeaf( leaf );
+	numLeafs++;
+
+	return leaf;
+}
+
+/*
+================
+idAreaRefTree::Remove
+================
+*/
+void idAreaRefTree::Remove( int leaf ) {
+	assert( leaf >= 0 && leaf < numNodes && nodes[leaf].height == 0 );
+
+	RemoveLeaf( leaf );
+	FreeNode( leaf );
+	numLeafs--;
+}
+
+/*
+================
+idAreaRefTree::InsertLeaf
+
+Descends to the sibling that gives the smallest increase in total
+surface area, then pairs the leaf with it under a new node.
+================
+*/
+void idAreaRefTree::InsertLeaf( int leaf ) {
+	if ( root == -1 ) {
+		root = leaf;
+		nodes[root].parent = -1;
+		return;
+	}
+
+	const idBounds leafBounds = nodes[leaf].bounds;
+
+	int nodeNum = root;
+	while ( nodes[nodeNum].height > 0 ) {
+		const areaRefTreeNode_t &node = nodes[nodeNum];
+		const float cost = AreaRefTree_Cost( node.bounds );
+		const float combinedCost = AreaRefTree_Cost( node.bounds + leafBounds );
+
+		// cost of creating a new parent for this node and the leaf
+		const float siblingCost = 2.0f * combinedCost;
+
+		// minimum cost of pushing the leaf further down the tree
+		const float inheritanceCost = 2.0f * ( combinedCost - cost );
+
+		float childCost[2];
+		for ( int i = 0; i < 2; i++ ) {
+			const areaRefTreeNode_t &child = nodes[node.children[i]];
+			childCost[i] = AreaRefTree_Cost( child.bounds + leafBounds ) + inheritanceCost;
+			if ( child.height > 0 ) {
+				childCost[i] -= AreaRefTree_Cost( child.bounds );
+			}
+		}
+
+		if ( siblingCost < childCost[0] && siblingCost < childCost[1] ) {
+			break;
+		}
+
+		nodeNum = node.children[ childCost[0] < childCost[1] ? 0 : 1 ];
+	}
+
+	const int sibling = nodeNum;
+	const int oldParent = nodes[sibling].parent;
+	const int newParent = AllocNode();
+
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].bounds = leafBounds + nodes[sibling].bounds;
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].children[0] = sibling;
+	nodes[newParent].children[1] = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if ( oldParent != -1 ) {
+		if ( nodes[oldParent].children[0] == sibling ) {
+			nodes[oldParent].children[0] = newParent;
+		} else {
+			nodes[oldParent].children[1] = newParent;
+		}
+	} else {
+		root = newParent;
+	}
+
+	Refit( newParent );
+}
+
+/*
+================
+idAreaRefTree::RemoveLeaf
+================
+*/
+void idAreaRefTree::RemoveLeaf( int leaf ) {
+	if ( leaf == root ) {
+		root = -1;
+		return;
+	}
+
+	const int parent = nodes[leaf].parent;
+	const int grandParent = nodes[parent].parent;
+	const int sibling = ( nodes[parent].children[0] == leaf ) ? nodes[parent].children[1] : nodes[parent].children[0];
+
+	// the sibling takes the place of the parent
+	nodes[sibling].parent = grandParent;
+	FreeNode( parent );
+
+	if ( grandParent != -1 ) {
+		if ( nodes[grandParent].children[0] == parent ) {
+			nodes[grandParent].children[0] = sibling;
+		} else {
+			nodes[grandParent].children[1] = sibling;
+		}
+		Refit( grandParent );
+	} else {
+		root = sibling;
+	}
+}
+
+/*
+================
+idAreaRefTree::Refit
+
+Balances and recalculates the bounds and height from the node up to the root.
+================
+*/
+void idAreaRefTree::Refit( int nodeNum ) {
+	while ( nodeNum != -1 ) {
+		nodeNum = Balance( nodeNum );
+
+		areaRefTreeNode_t &node = nodes[nodeNum];
+		const areaRefTreeNode_t &child0 = nodes[node.children[0]];
+		const areaRefTreeNode_t &child1 = nodes[node.children[1]];
+
+		node.height = 1 + Max( child0.height, child1.height );
+		node.bounds = child0.bounds + child1.bounds;
+
+		nodeNum = node.parent;
+	}
+}
+
+/*
+================
+idAreaRefTree::Balance
+
+If one child of the node is more than one level higher than the other,
+that child is rotated up to take the place of the node.
+Returns the node now at the position of nodeNum.
+================
+*/
+int idAreaRefTree::Balance( int nodeNum ) {
+	areaRefTreeNode_t &a = nodes[nodeNum];
+
+	if ( a.height < 2 ) {
+		return nodeNum;
+	}
+
+	const int balance = nodes[a.children[1]].height - nodes[a.children[0]].height;
+	if ( balance >= -1 && balance <= 1 ) {
+		return nodeNum;
+	}
+
+	// the higher child moves up, the lower one stays below a
+	const int up = ( balance > 1 ) ? 1 : 0;
+	const int upNum = a.children[up];
+	areaRefTreeNode_t &b = nodes[upNum];
+	const areaRefTreeNode_t &c = nodes[a.children[1 - up]];
+
+	// b takes the place of a
+	b.parent = a.parent;
+	a.parent = upNum;
+	if ( b.parent != -1 ) {
+		if ( nodes[b.parent].children[0] == nodeNum ) {
+			nodes[b.parent].children[0] = upNum;
+		} else {
+			nodes[b.parent].children[1] = upNum;
+		}
+	} else {
+		root = upNum;
+	}
+
+	// the higher grandchild stays with b, the lower one moves to a
+	const int keep = ( nodes[b.children[0]].height > nodes[b.children[1]].height ) ? 0 : 1;
+	const int keepNum = b.children[keep];
+	const int moveNum = b.children[1 - keep];
+
+	b.children[0] = nodeNum;
+	b.children[1] = keepNum;
+	a.children[up] = moveNum;
+	nodes[moveNum].parent = nodeNum;
+
+	a.bounds = c.bounds + nodes[moveNum].bounds;
+	a.height = 1 + Max( c.height, nodes[moveNum].height );
+	b.bounds = a.bounds + nodes[keepNum].bounds;
+	b.height = 1 + Max( a.height, nodes[keepNum].height );
+
+	return upNum;
+}
+
+/*
+================
+idAreaRefTree::CullByPlanes
+
+The planes face out, a node is culled if it is completely on the front side of any plane.
+================
+*/
+void idAreaRefTree::CullByPlanes( int numPlanes, const idPlane *planes, idList<areaReference_t *> &refs ) const {
+	int		stack[AREA_REF_TREE_MAX_DEPTH];
+	int		stackDepth;
+
+	if ( root == -1 ) {
+		return;
+	}
+
+	stack[0] = root;
+	stackDepth = 1;
+
+	while ( stackDepth > 0 ) {
+		const areaRefTreeNode_t &node = nodes[ stack[--stackDepth] ];
+
+		int i;
+		for ( i = 0; i < numPlanes; i++ ) {
+			if ( node.bounds.PlaneSide( planes[i], 0.0f ) == PLANESIDE_FRONT ) {
+				break;
+			}
+		}
+		if ( i < numPlanes ) {
+			continue;
+		}
+
+		if ( node.height == 0 ) {
+			refs.Append( node.ref );
+			continue;
+		}
+
+		assert( stackDepth + 2 <= AREA_REF_TREE_MAX_DEPTH );
+		stack[stackDepth++] = node.children[0];
+		stack[stackDepth++] = node.children[1];
+	}
+}
@@ -0,0 +1,87 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __AREAREFTREE_H__
+#define __AREAREFTREE_H__
+
+/*
+===============================================================================
+
+	Area reference tree
+
+	Dynamic bounding volume tree over the world space bounds of the entity or
+	light references in a portal area.  References are inserted when they are
+	linked into the area and removed when they are unlinked, so the tree stays
+	current as defs are updated.  The tree is kept balanced with rotations, so
+	a portal chain only has to visit the nodes that cross its planes.
+
+	Portal areas are cleared allocations, so the tree has no constructor and
+	must be explicitly set up with Init and released with Shutdown.
+
+===============================================================================
+*/
+
+typedef struct {
+	idBounds				bounds;
+	int						parent;			// next free node when on the free list
+	int						children[2];	// -1 for leafs
+	int						height;			// 0 for leafs, -1 for free nodes
+	struct areaReference_s *ref;			// only set on leafs
+} areaRefTreeNode_t;
+
+class idAreaRefTree {
+public:
+	void					Init( void );
+	void					Shutdown( void );
+
+							// returns the leaf node to pass to Remove
+	int						Insert( struct areaReference_s *ref, const idBounds &bounds );
+	void					Remove( int leaf );
+
+	int						Num( void ) const { return numLeafs; }
+
+							// appends all references that are not completely on the front side of one of the planes
+	void					CullByPlanes( int numPlanes, const idPlane *planes, idList<struct areaReference_s *> &refs ) const;
+
+private:
+	areaRefTreeNode_t *		nodes;
+	int						numNodes;
+	int						maxNodes;
+	int						freeNode;
+	int						root;
+	int						numLeafs;
+
+	int						AllocNode( void );
+	void					FreeNode( int nodeNum );
+	void					InsertLeaf( int leaf );
+	void					RemoveLeaf( int leaf );
+	void					Refit( int nodeNum );
+	int						Balance( int nodeNum );
+};
+
+#endif /* !__AREAREFTREE_H__ */
@@ -148,6 +148,57 @@ typedef enum {
 
 #define	MAX_IMAGE_NAME	256
 
+typedef enum {
+	IMAGE_FILE_TGA,
+	IMAGE_FILE_STB				// jpg or png, decoded by stb_image
+} imageFileType_t;
+
+// the raw contents of an image file, so that the decoding can be done by a job
+typedef struct {
+	imageFileType_t		type;
+	byte *				buffer;
+	int					length;
+	int					width, height;
+	ID_TIME_T			timestamp;
+} imageFile_t;
+
+class idImage;
+
+// an image file that is read on the main thread, decoded and mip mapped by
+// R_DecodeImageJob and then uploaded on the main thread again
+typedef struct {
+	idImage *			image;
+	imageFile_t			file;
+	textureDepth_t		depth;
+	bool				allowDownSize;
+	bool				preserveBorder;			// don't let mip mapping smear the texture into the clamped border
+	bool				zeroBorder;				// TR_CLAMP_TO_ZERO
+	bool				zeroBorderAlpha;		// TR_CLAMP_TO_ZERO_ALPHA
+	bool				swapNormalAlpha;		// rxgb normal map
+	bool				colorMipLevels;
+	int					potWidth, potHeight;	// after rounding to a power of two
+	int					uploadWidth, uploadHeight;	// after downsizing
+	byte *				pic;					// decoded file
+	byte *				potPic;					// resampled to potWidth * potHeight, NULL if not needed
+	byte *				mips;					// mip levels 1 and up of the power of two image
+	int					firstLevel;				// the level that is uploaded as level 0
+	GLenum				internalFormat;
+	int					imageHash;
+	bool				failed;					// the file couldn't be decoded
+} imageDecode_t;
+
+void	R_DecodeImageJob( void *data );
+
+// images referenced while a level loads are decoded in batches of jobs that run
+// alongside the map and entity loading, see idImageManager::QueueLevelLoadDecode
+static const int	LEVEL_LOAD_DECODE_BATCH		= 16;
+
+typedef struct {
+	idParallelJobList *	jobList;
+	imageDecode_t		decodes[LEVEL_LOAD_DECODE_BATCH];
+	int					numDecodes;
+} imageDecodeBatch_t;
+
 class idImage {
 public:
 				idImage();
@@ -209,6 +260,10 @@ public:
 	bool		CheckPrecompressedImage( bool fullLoad );
 	void		UploadPrecompressedImage( byte *data, int len );
 	void		ActuallyLoadImage( bool checkForPrecompressed, bool fromBackEnd );
+	bool		CanDecodeInJob() const;
+	bool		StartDecode( imageDecode_t *decode );
+	bool		ReadForDecode( imageDecode_t *decode );
+	void		FinishDecode( imageDecode_t *decode );
 	void		StartBackgroundImageLoad();
 	int			BitsForInternalFormat( int internalFormat ) const;
 	void		UploadCompressedNormalMap( int width, int height, const byte *rgba, int mipLevel );
@@ -384,6 +439,9 @@ public:
 	static idCVar		image_cacheMegs;			// maximum bytes set aside for temporary loading of full-sized precompressed images
 	static idCVar		image_useCache;				// 1 = do background load image caching
 	static idCVar		image_showBackgroundLoads;	// 1 = print number of outstanding background loads
+	static idCVar		image_useDecodeJobs;		// decode and mip map level load images in jobs
+	static idCVar		image_useProgramCache;		// read and write the results of image programs in IMAGE_PROGRAM_CACHE_DIR
+	static idCVar		image_levelLoadDecodeMegs;	// maximum MB of images decoded while the level loads
 	static idCVar		image_forceDownSize;		// allows the ability to force a downsize
 	static idCVar		image_downSizeSpecular;		// downsize specular
 	static idCVar		image_downSizeSpecularLimit;// downsize specular limit
@@ -421,6 +479,9 @@ public:
 	//--------------------------------------------------------
 
 	idImage *			AllocImage( const char *name );
+	void				LoadImagesInJobs( const idList<idImage *> &loadList );
+	void				QueueLevelLoadDecode( idImage *image );
+	int					FinishLevelLoadDecodes( bool upload );
 	void				SetNormalPalette();
 	void				ChangeTextureFilter();
 
@@ -430,6 +491,10 @@ public:
 
 	bool				insideLevelLoad;			// don't actually load images now
 
+	idList<imageDecodeBatch_t *> levelLoadBatches;	// decoding while the level loads, uploaded by EndLevelLoad
+	int					numWaitedBatches;			// the first batches are already done
+	int					levelLoadDecodeBytes;
+
 	byte				originalToCompressed[256];	// maps normal maps to 8 bit textures
 	byte				compressedPalette[768];		// the palette that normal maps use
 
@@ -462,12 +527,18 @@ FIXME: make an "imageBlock" type to hold byte*,width,height?
 ====================================================================
 */
 
+#define	MAX_RESAMPLE_DIMENSION	4096		// largest size R_ResampleTexture will produce
+
 byte *R_Dropsample( const byte *in, int inwidth, int inheight,
 							int outwidth, int outheight );
 byte *R_ResampleTexture( const byte *in, int inwidth, int inheight,
 							int outwidth, int outheight );
 byte *R_MipMapWithAlphaSpecularity( const byte *in, int width, int height );
 byte *R_MipMap( const byte *in, int width, int height, bool preserveBorder );
+// these write to a buffer of the output size instead of allocating, so jobs can use them
+void R_ResampleTextureTo( const byte *in, int inwidth, int inheight,
+							byte *out, int outwidth, int outheight );
+void R_MipMapTo( const byte *in, int width, int height, byte *out, bool preserveBorder );
 byte *R_MipMap3D( const byte *in, int width, int height, int depth, bool preserveBorder );
 
 // these operate in-place on the provided pixels
@@ -487,6 +558,10 @@ IMAGEFILES
 */
 
 void R_LoadImage( const char *name, byte **pic, int *width, int *height, ID_TIME_T *timestamp, bool makePowerOf2 );
+// R_ReadImageFile uses the file system, R_DecodeImageFile can be called from a job
+bool R_ReadImageFile( const char *name, imageFile_t *file );
+bool R_DecodeImageFile( const imageFile_t *file, byte *pic );
+void R_FreeImageFile( imageFile_t *file );
 // pic is in top to bottom raster format
 bool R_LoadCubeImages( const char *cname, cubeFiles_t extensions, byte *pic[6], int *size, ID_TIME_T *timestamp );
 
@@ -498,7 +573,13 @@ IMAGEPROGRAM
 ====================================================================
 */
 
+// evaluated image programs are cached as IMAGE_PROGRAM_CACHE_DIR + mangled program + IMAGE_PROGRAM_CACHE_EXT
+#define IMAGE_PROGRAM_CACHE_DIR		"imagecache/"
+#define IMAGE_PROGRAM_CACHE_EXT		".bimage"
+
 void R_LoadImageProgram( const char *name, byte **pic, int *width, int *height, ID_TIME_T *timestamp, textureDepth_t *depth = NULL );
 const char *R_ParsePastImageProgram( idLexer &src );
+void R_ImageProgramStringToFileName( const char *imageProg, const char *dir, const char *ext, idStr &fileName );
+void R_BenchmarkImageProcessing_f( const idCmdArgs &args );
 
 #endif
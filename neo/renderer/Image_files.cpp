@@ -528,32 +528,13 @@ TARGA LOADING
 
 /*
 =============
-LoadTGA
+R_ReadTGAHeader
+
+Returns the start of the pixel data
 =============
 */
-static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_TIME_T *timestamp ) {
-	int		columns, rows, numPixels, fileSize, numBytes;
-	byte	*pixbuf;
-	int		row, column;
-	byte	*buf_p;
-	byte	*buffer;
-	TargaHeader	targa_header;
-	byte		*targa_rgba;
-
-	if ( !pic ) {
-		fileSystem->ReadFile( name, NULL, timestamp );
-		return;	// just getting timestamp
-	}
-
-	*pic = NULL;
-
-	//
-	// load the file
-	//
-	fileSize = fileSystem->ReadFile( name, (void **)&buffer, timestamp );
-	if ( !buffer ) {
-		return;
-	}
+static const byte *R_ReadTGAHeader( const byte *buffer, TargaHeader &targa_header ) {
+	const byte	*buf_p;
 
 	buf_p = buffer;
 
@@ -577,6 +558,23 @@ static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_T
 	targa_header.pixel_size = *buf_p++;
 	targa_header.attributes = *buf_p++;
 
+	if ( targa_header.id_length != 0 ) {
+		buf_p += targa_header.id_length;  // skip TARGA image comment
+	}
+
+	return buf_p;
+}
+
+/*
+=============
+R_CheckTGAHeader
+
+Errors out on anything R_DecodeTGA can't handle
+=============
+*/
+static void R_CheckTGAHeader( const char *name, const TargaHeader &targa_header, int fileSize ) {
+	int		numBytes;
+
 	if ( targa_header.image_type != 2 && targa_header.image_type != 10 && targa_header.image_type != 3 ) {
 		common->Error( "LoadTGA( %s ): Only type 2 (RGB), 3 (gray), and 10 (RGB) TGA images supported\n", name );
 	}
@@ -589,30 +587,33 @@ static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_T
 		common->Error( "LoadTGA( %s ): Only 32 or 24 bit images supported (no colormaps)\n", name );
 	}
 
+	if ( targa_header.pixel_size != 8 && targa_header.pixel_size != 24 && targa_header.pixel_size != 32 ) {
+		common->Error( "LoadTGA( %s ): illegal pixel_size '%d'\n", name, targa_header.pixel_size );
+	}
+
 	if ( targa_header.image_type == 2 || targa_header.image_type == 3 ) {
 		numBytes = targa_header.width * targa_header.height * ( targa_header.pixel_size >> 3 );
 		if ( numBytes > fileSize - 18 - targa_header.id_length ) {
 			common->Error( "LoadTGA( %s ): incomplete file\n", name );
 		}
 	}
+}
 
-	columns = targa_header.width;
-	rows = targa_header.height;
-	numPixels = columns * rows;
-
-	if ( width ) {
-		*width = columns;
-	}
-	if ( height ) {
-		*height = rows;
-	}
+/*
+=============
+R_DecodeTGA
 
-	targa_rgba = (byte *)R_StaticAlloc(numPixels*4);
-	*pic = targa_rgba;
+Decodes the pixels of a checked tga file into targa_rgba, which must hold
+width * height * 4 bytes.  Doesn't allocate or print, so jobs can use it.
+=============
+*/
+static void R_DecodeTGA( const TargaHeader &targa_header, const byte *buf_p, byte *targa_rgba ) {
+	int		columns, rows;
+	byte	*pixbuf;
+	int		row, column;
 
-	if ( targa_header.id_length != 0 ) {
-		buf_p += targa_header.id_length;  // skip TARGA image comment
-	}
+	columns = targa_header.width;
+	rows = targa_header.height;
 
 	if ( targa_header.image_type == 2 || targa_header.image_type == 3 )
 	{
@@ -656,7 +657,7 @@ static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_T
 					*pixbuf++ = alphabyte;
 					break;
 				default:
-					common->Error( "LoadTGA( %s ): illegal pixel_size '%d'\n", name, targa_header.pixel_size );
+					// rejected by R_CheckTGAHeader
 					break;
 				}
 			}
@@ -690,7 +691,7 @@ static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_T
 								alphabyte = *buf_p++;
 								break;
 						default:
-							common->Error( "LoadTGA( %s ): illegal pixel_size '%d'\n", name, targa_header.pixel_size );
+							// rejected by R_CheckTGAHeader
 							break;
 					}
 
@@ -735,7 +736,7 @@ static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_T
 									*pixbuf++ = alphabyte;
 									break;
 							default:
-								common->Error( "LoadTGA( %s ): illegal pixel_size '%d'\n", name, targa_header.pixel_size );
+								// rejected by R_CheckTGAHeader
 								break;
 						}
 						column++;
@@ -757,9 +758,56 @@ static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_T
 	}
 
 	if ( (targa_header.attributes & (1<<5)) ) {			// image flp bit
-		R_VerticalFlip( *pic, *width, *height );
+		R_VerticalFlip( targa_rgba, columns, rows );
+	}
+}
+
+/*
+=============
+LoadTGA
+=============
+*/
+static void LoadTGA( const char *name, byte **pic, int *width, int *height, ID_TIME_T *timestamp ) {
+	int		columns, rows, numPixels, fileSize;
+	const byte	*buf_p;
+	byte	*buffer;
+	TargaHeader	targa_header;
+	byte		*targa_rgba;
+
+	if ( !pic ) {
+		fileSystem->ReadFile( name, NULL, timestamp );
+		return;	// just getting timestamp
+	}
+
+	*pic = NULL;
+
+	//
+	// load the file
+	//
+	fileSize = fileSystem->ReadFile( name, (void **)&buffer, timestamp );
+	if ( !buffer ) {
+		return;
+	}
+
+	buf_p = R_ReadTGAHeader( buffer, targa_header );
+	R_CheckTGAHeader( name, targa_header, fileSize );
+
+	columns = targa_header.width;
+	rows = targa_header.height;
+	numPixels = columns * rows;
+
+	if ( width ) {
+		*width = columns;
+	}
+	if ( height ) {
+		*height = rows;
 	}
 
+	targa_rgba = (byte *)R_StaticAlloc(numPixels*4);
+	*pic = targa_rgba;
+
+	R_DecodeTGA( targa_header, buf_p, targa_rgba );
+
 	fileSystem->FreeFile( buffer );
 }
 
@@ -932,6 +980,148 @@ void R_LoadImage( const char *cname, byte **pic, int *width, int *height, ID_TIM
 }
 
 
+/*
+=================
+R_ReadImageStb
+=================
+*/
+static bool R_ReadImageStb( const char *name, imageFile_t *file ) {
+	int		comp;
+
+	file->length = fileSystem->ReadFile( name, (void **)&file->buffer, &file->timestamp );
+	if ( !file->buffer ) {
+		return false;
+	}
+	if ( !stbi_info_from_memory( file->buffer, file->length, &file->width, &file->height, &comp ) ) {
+		// let R_LoadImage print the error
+		R_FreeImageFile( file );
+		return false;
+	}
+	file->type = IMAGE_FILE_STB;
+	return true;
+}
+
+/*
+=================
+R_ReadImageTGA
+=================
+*/
+static bool R_ReadImageTGA( const char *name, imageFile_t *file ) {
+	TargaHeader	targa_header;
+
+	file->length = fileSystem->ReadFile( name, (void **)&file->buffer, &file->timestamp );
+	if ( !file->buffer ) {
+		return false;
+	}
+	R_ReadTGAHeader( file->buffer, targa_header );
+	R_CheckTGAHeader( name, targa_header, file->length );
+
+	file->type = IMAGE_FILE_TGA;
+	file->width = targa_header.width;
+	file->height = targa_header.height;
+	return true;
+}
+
+/*
+=================
+R_ReadImageFile
+
+Reads an image file for R_DecodeImageFile, looking for the same files
+as R_LoadImage does.
+
+Returns false if the file couldn't be found or is a type that only
+R_LoadImage handles.
+=================
+*/
+bool R_ReadImageFile( const char *cname, imageFile_t *file ) {
+	idStr name = cname;
+	idStr ext;
+
+	memset( file, 0, sizeof( *file ) );
+	file->timestamp = FILE_NOT_FOUND_TIMESTAMP;
+
+	name.DefaultFileExtension( ".tga" );
+
+	if ( name.Length() < 5 ) {
+		return false;
+	}
+
+	name.ToLower();
+	name.ExtractFileExtension( ext );
+
+	if ( ext == "tga" ) {
+#if IMG_ENABLE_PNGS > 0
+		name.SetFileExtension( ".png" );
+		if ( R_ReadImageStb( name.c_str(), file ) ) {
+			return true;
+		}
+		name.SetFileExtension( ".tga" );
+#endif
+		if ( R_ReadImageTGA( name.c_str(), file ) ) {
+			return true;
+		}
+		name.SetFileExtension( ".jpg" );
+		return R_ReadImageStb( name.c_str(), file );
+	}
+	if ( ext == "jpg" ) {
+		return R_ReadImageStb( name.c_str(), file );
+	}
+
+	return false;
+}
+
+/*
+=================
+R_DecodeImageFile
+
+Decodes a file read by R_ReadImageFile into pic, which must hold
+width * height * 4 bytes.  Doesn't use the file system, allocate from
+the heap or print, so jobs can use it.
+
+Returns false if the file was corrupt.
+=================
+*/
+bool R_DecodeImageFile( const imageFile_t *file, byte *pic ) {
+	if ( file->width < 1 || file->height < 1 ) {
+		return false;
+	}
+
+	if ( file->type == IMAGE_FILE_TGA ) {
+		TargaHeader	targa_header;
+		const byte	*pixels;
+
+		pixels = R_ReadTGAHeader( file->buffer, targa_header );
+		R_DecodeTGA( targa_header, pixels, pic );
+		return true;
+	}
+
+	// stb_image allocates with malloc, which is safe outside the main thread
+	int w = 0, h = 0, comp = 0;
+	byte *decodedImageData = stbi_load_from_memory( file->buffer, file->length, &w, &h, &comp, 4 );
+	if ( decodedImageData == NULL ) {
+		return false;
+	}
+	if ( w != file->width || h != file->height ) {
+		stbi_image_free( decodedImageData );
+		return false;
+	}
+	memcpy( pic, decodedImageData, w * h * 4 );
+	stbi_image_free( decodedImageData );
+	return true;
+}
+
+/*
+=================
+R_FreeImageFile
+=================
+*/
+void R_FreeImageFile( imageFile_t *file ) {
+	if ( file->buffer ) {
+		fileSystem->FreeFile( file->buffer );
+		file->buffer = NULL;
+	}
+}
+
 /*
 =======================
 R_LoadCubeImages
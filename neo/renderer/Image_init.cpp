@@ -62,6 +62,9 @@ idCVar idImageManager::image_cacheMinK( "image_cacheMinK", "200", CVAR_RENDERER
 idCVar idImageManager::image_cacheMegs( "image_cacheMegs", "20", CVAR_RENDERER | CVAR_ARCHIVE, "maximum MB set aside for temporary loading of full-sized precompressed images" );
 idCVar idImageManager::image_useCache( "image_useCache", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_BOOL, "1 = do background load image caching" );
 idCVar idImageManager::image_showBackgroundLoads( "image_showBackgroundLoads", "0", CVAR_RENDERER | CVAR_BOOL, "1 = print number of outstanding background loads" );
+idCVar idImageManager::image_useDecodeJobs( "image_useDecodeJobs", "1", CVAR_RENDERER | CVAR_BOOL, "decode and mip map the images of a level load in parallel jobs" );
+idCVar idImageManager::image_useProgramCache( "image_useProgramCache", "1", CVAR_RENDERER | CVAR_BOOL, "read and write the results of image programs in " IMAGE_PROGRAM_CACHE_DIR );
+idCVar idImageManager::image_levelLoadDecodeMegs( "image_levelLoadDecodeMegs", "256", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "maximum MB of images decoded in jobs while the map and entities are loading, 0 = decode everything at the end of the level load" );
 idCVar idImageManager::image_downSizeSpecular( "image_downSizeSpecular", "0", CVAR_RENDERER | CVAR_ARCHIVE, "controls specular downsampling" );
 idCVar idImageManager::image_downSizeBump( "image_downSizeBump", "0", CVAR_RENDERER | CVAR_ARCHIVE, "controls normal map downsampling" );
 idCVar idImageManager::image_downSizeSpecularLimit( "image_downSizeSpecularLimit", "64", CVAR_RENDERER | CVAR_ARCHIVE, "controls specular downsampled limit" );
@@ -1547,11 +1550,18 @@ idImage	*idImageManager::ImageFromFile( const char *_name, textureFilter_t filte
 			}
 
 			if ( image->allowDownSize == allowDownSize && image->depth == depth ) {
+				bool firstReference = !image->levelLoadReferenced;
+
 				// note that it is used this level load
 				image->levelLoadReferenced = true;
 				if ( image->partialImage != NULL ) {
 					image->partialImage->levelLoadReferenced = true;
 				}
+
+				// start decoding it if it was purged by an earlier level
+				if ( firstReference ) {
+					QueueLevelLoadDecode( image );
+				}
 				return image;
 			}
 
@@ -1646,6 +1656,7 @@ idImage	*idImageManager::ImageFromFile( const char *_name, textureFilter_t filte
 		declManager->MediaPrint( "%ix%i %s\n", image->uploadWidth, image->uploadHeight, image->imgName.c_str() );
 	} else {
 		declManager->MediaPrint( "%s\n", image->imgName.c_str() );
+		QueueLevelLoadDecode( image );
 	}
 
 	return image;
@@ -1970,6 +1981,9 @@ void idImageManager::Init() {
 
 	memset(imageHashTable, 0, sizeof(imageHashTable));
 
+	numWaitedBatches = 0;
+	levelLoadDecodeBytes = 0;
+
 	images.Resize( 1024, 1024 );
 
 	// clear the cached LRU
@@ -2020,6 +2034,7 @@ Shutdown
 ===============
 */
 void idImageManager::Shutdown() {
+	FinishLevelLoadDecodes( false );
 	images.DeleteContents( true );
 }
 
@@ -2034,6 +2049,9 @@ loading the actual data.
 ====================
 */
 void idImageManager::BeginLevelLoad() {
+	// an earlier level load may have been aborted by an error
+	FinishLevelLoadDecodes( false );
+
 	insideLevelLoad = true;
 
 	for ( int i = 0 ; i < images.Num() ; i++ ) {
@@ -2071,6 +2089,7 @@ void idImageManager::EndLevelLoad() {
 
 	insideLevelLoad = false;
 	if ( idAsyncNetwork::serverDedicated.GetInteger() ) {
+		FinishLevelLoadDecodes( false );
 		return;
 	}
 
@@ -2079,6 +2098,7 @@ void idImageManager::EndLevelLoad() {
 	int		purgeCount = 0;
 	int		keepCount = 0;
 	int		loadCount = 0;
+	int		decodedCount = 0;
 
 	// purge the ones we don't need
 	for ( int i = 0 ; i < images.Num() ; i++ ) {
@@ -2097,7 +2117,12 @@ void idImageManager::EndLevelLoad() {
 		}
 	}
 
+	// upload the ones decoded while the level was loading, now that the
+	// unused ones are gone
+	decodedCount = FinishLevelLoadDecodes( true );
+
 	// load the ones we do need, if we are preloading
+	idList<idImage *>	loadList;
 	for ( int i = 0 ; i < images.Num() ; i++ ) {
 		idImage	*image = images[ i ];
 		if ( image->generatorFunction ) {
@@ -2105,9 +2130,18 @@ void idImageManager::EndLevelLoad() {
 		}
 
 		if ( image->levelLoadReferenced && image->texnum == idImage::TEXTURE_NOT_LOADED && !image->partialImage ) {
-//			common->Printf( "Loading %s\n", image->imgName.c_str() );
+			loadList.Append( image );
+		}
+	}
+
+	if ( image_useDecodeJobs.GetBool() && parallelJobManager->GetNumWorkers() > 0 ) {
+		LoadImagesInJobs( loadList );
+		loadCount = loadList.Num();
+	} else {
+		for ( int i = 0 ; i < loadList.Num() ; i++ ) {
+//			common->Printf( "Loading %s\n", loadList[ i ]->imgName.c_str() );
 			loadCount++;
-			image->ActuallyLoadImage( true, false );
+			loadList[ i ]->ActuallyLoadImage( true, false );
 
 			if ( ( loadCount & 15 ) == 0 ) {
 				session->PacifierUpdate();
@@ -2118,10 +2152,212 @@ void idImageManager::EndLevelLoad() {
 	int	end = Sys_Milliseconds();
 	common->Printf( "%5i purged from previous\n", purgeCount );
 	common->Printf( "%5i kept from previous\n", keepCount );
-	common->Printf( "%5i new loaded\n", loadCount );
+	common->Printf( "%5i new loaded\n", loadCount + decodedCount );
+	if ( decodedCount ) {
+		common->Printf( "%5i decoded while the level was loading\n", decodedCount );
+	}
 	common->Printf( "all images loaded in %5.1f seconds\n", (end-start) * 0.001 );
 }
 
+/*
+====================
+LoadImagesInJobs
+
+The files of a batch of images are read while the jobs of the previous
+batch decode and mip map theirs, then the previous batch is uploaded.
+====================
+*/
+void idImageManager::LoadImagesInJobs( const idList<idImage *> &loadList ) {
+	static const int	DECODE_BATCH_SIZE = 16;
+	imageDecode_t		decodes[2][DECODE_BATCH_SIZE];
+	int					numDecodes[2];
+	idParallelJobList	jobList0( "idImageManager::LoadImagesInJobs" );
+	idParallelJobList	jobList1( "idImageManager::LoadImagesInJobs" );
+	idParallelJobList *	jobLists[2] = { &jobList0, &jobList1 };
+	int					current, previous;
+	int					next;
+
+	numDecodes[0] = numDecodes[1] = 0;
+	current = 0;
+	next = 0;
+	while ( 1 ) {
+		previous = current ^ 1;
+
+		while ( next < loadList.Num() && numDecodes[current] < DECODE_BATCH_SIZE ) {
+			imageDecode_t *decode = &decodes[current][numDecodes[current]];
+			// a pacifier update may have loaded it already
+			if ( loadList[next]->texnum == idImage::TEXTURE_NOT_LOADED && loadList[next]->StartDecode( decode ) ) {
+				jobLists[current]->AddJob( R_DecodeImageJob, decode );
+				numDecodes[current]++;
+			}
+			next++;
+
+			if ( ( next & 15 ) == 0 ) {
+				session->PacifierUpdate();
+			}
+		}
+		if ( numDecodes[current] ) {
+			jobLists[current]->Submit();
+		}
+
+		if ( numDecodes[previous] ) {
+			jobLists[previous]->Wait();
+			for ( int i = 0 ; i < numDecodes[previous] ; i++ ) {
+				decodes[previous][i].image->FinishDecode( &decodes[previous][i] );
+			}
+			numDecodes[previous] = 0;
+		}
+
+		if ( !numDecodes[current] && next >= loadList.Num() ) {
+			break;
+		}
+		current = previous;
+	}
+}
+
+/*
+====================
+R_DecodeMemorySize
+
+Approximately what a queued decode keeps allocated until it is uploaded.
+====================
+*/
+static int R_DecodeMemorySize( const imageDecode_t *decode ) {
+	int size = decode->file.width * decode->file.height * 4;
+	if ( decode->potPic ) {
+		size += decode->potWidth * decode->potHeight * 4;
+	}
+	// the mip levels
+	size += decode->potWidth * decode->potHeight * 4 / 3;
+	return size + decode->file.length;
+}
+
+/*
+====================
+QueueLevelLoadDecode
+
+Reads an image that was referenced for the first time in this level load and
+starts decoding it in a job, so the decoding runs while the main thread loads
+the map and spawns the entities.  The results are uploaded by EndLevelLoad
+after the images of the previous level have been purged, so the textures of
+two levels are still never loaded together.
+
+Images the jobs can't handle, precompressed images and anything beyond
+image_levelLoadDecodeMegs are left to EndLevelLoad.
+====================
+*/
+void idImageManager::QueueLevelLoadDecode( idImage *image ) {
+	static const int MAX_ACTIVE_BATCHES = 4;
+
+	if ( !insideLevelLoad || !image_preload.GetBool() || !image_useDecodeJobs.GetBool() || parallelJobManager->GetNumWorkers() <= 0 ) {
+		return;
+	}
+	if ( image->texnum != idImage::TEXTURE_NOT_LOADED || image->partialImage != NULL || !image->CanDecodeInJob() ) {
+		return;
+	}
+	if ( levelLoadDecodeBytes >= image_levelLoadDecodeMegs.GetInteger() * 1024 * 1024 ) {
+		return;
+	}
+
+	// a precompressed image doesn't need any decoding
+	if ( image_usePrecompressedTextures.GetBool() ) {
+		char	filename[MAX_IMAGE_NAME];
+
+		image->ImageProgramStringToCompressedFileName( image->imgName, filename );
+		if ( fileSystem->ReadFile( filename, NULL, NULL ) != -1 ) {
+			return;
+		}
+	}
+
+	imageDecodeBatch_t *batch = NULL;
+	if ( levelLoadBatches.Num() && levelLoadBatches[levelLoadBatches.Num() - 1]->numDecodes < LEVEL_LOAD_DECODE_BATCH ) {
+		batch = levelLoadBatches[levelLoadBatches.Num() - 1];
+	} else {
+		batch = new imageDecodeBatch_t;
+		batch->jobList = new idParallelJobList( "idImageManager::QueueLevelLoadDecode" );
+		batch->numDecodes = 0;
+		levelLoadBatches.Append( batch );
+	}
+
+	imageDecode_t *decode = &batch->decodes[batch->numDecodes];
+	if ( !image->ReadForDecode( decode ) ) {
+		return;
+	}
+	batch->jobList->AddJob( R_DecodeImageJob, decode );
+	batch->numDecodes++;
+	levelLoadDecodeBytes += R_DecodeMemorySize( decode );
+
+	if ( batch->numDecodes < LEVEL_LOAD_DECODE_BATCH ) {
+		return;
+	}
+	batch->jobList->Submit();
+
+	// only a few lists are handed to the workers at a time, so wait for the
+	// oldest one, which is usually done by now, and drop its file buffers
+	if ( levelLoadBatches.Num() - numWaitedBatches > MAX_ACTIVE_BATCHES ) {
+		imageDecodeBatch_t *oldest = levelLoadBatches[numWaitedBatches++];
+		oldest->jobList->Wait();
+		for ( int i = 0 ; i < oldest->numDecodes ; i++ ) {
+			levelLoadDecodeBytes -= oldest->decodes[i].file.length;
+			R_FreeImageFile( &oldest->decodes[i].file );
+		}
+	}
+}
+
+/*
+====================
+FinishLevelLoadDecodes
+
+Waits for the decodes started by QueueLevelLoadDecode and uploads the images
+that are still needed with the same settings, or throws them all away.
+Returns the number of uploaded images.
+====================
+*/
+int idImageManager::FinishLevelLoadDecodes( bool upload ) {
+	int		uploadCount = 0;
+
+	for ( int i = 0 ; i < levelLoadBatches.Num() ; i++ ) {
+		imageDecodeBatch_t *batch = levelLoadBatches[i];
+
+		// the last batch may not be full yet
+		if ( upload && !batch->jobList->IsSubmitted() ) {
+			batch->jobList->Submit();
+		}
+		batch->jobList->Wait();
+
+		for ( int j = 0 ; j < batch->numDecodes ; j++ ) {
+			imageDecode_t *decode = &batch->decodes[j];
+			idImage *image = decode->image;
+
+			// a later reference may have changed the depth or downsizing, or something
+			// may have loaded the image in the mean time
+			if ( upload && image->levelLoadReferenced && image->texnum == idImage::TEXTURE_NOT_LOADED
+					&& decode->depth == image->depth && decode->allowDownSize == image->allowDownSize ) {
+				image->FinishDecode( decode );
+				uploadCount++;
+
+				if ( ( uploadCount & 15 ) == 0 ) {
+					session->PacifierUpdate();
+				}
+			} else {
+				R_FreeImageFile( &decode->file );
+				R_StaticFree( decode->pic );
+				R_StaticFree( decode->potPic );
+				R_StaticFree( decode->mips );
+			}
+		}
+
+		delete batch->jobList;
+		delete batch;
+	}
+
+	levelLoadBatches.Clear();
+	numWaitedBatches = 0;
+	levelLoadDecodeBytes = 0;
+
+	return uploadCount;
+}
+
 /*
 ===============
 idImageManager::StartBuild
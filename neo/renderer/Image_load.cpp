@@ -964,15 +964,16 @@ void idImage::GenerateCubeImage( const byte *pic[6], int size,
 
 /*
 ================
-ImageProgramStringToFileCompressedFileName
+R_ImageProgramStringToFileName
+
+Turns an image program into a file name that can be used for data generated
+from it, directories are made from the first few nested programs.
 ================
 */
-void idImage::ImageProgramStringToCompressedFileName( const char *imageProg, char *fileName ) const {
+void R_ImageProgramStringToFileName( const char *imageProg, const char *dir, const char *ext, idStr &fileName ) {
 	const char	*s;
-	char	*f;
 
-	strcpy( fileName, "dds/" );
-	f = fileName + strlen( fileName );
+	fileName = dir;
 
 	int depth = 0;
 
@@ -981,24 +982,32 @@ void idImage::ImageProgramStringToCompressedFileName( const char *imageProg, cha
 	for ( s = imageProg ; *s ; s++ ) {
 		if ( *s == '/' || *s == '\\' || *s == '(') {
 			if ( depth < 4 ) {
-				*f = '/';
+				fileName += '/';
 				depth ++;
 			} else {
-				*f = ' ';
+				fileName += ' ';
 			}
-			f++;
 		} else if ( *s == '<' || *s == '>' || *s == ':' || *s == '|' || *s == '"' || *s == '.' ) {
-			*f = '_';
-			f++;
-		} else if ( *s == ' ' && *(f-1) == '/' ) {	// ignore a space right after a slash
+			fileName += '_';
+		} else if ( *s == ' ' && fileName[fileName.Length()-1] == '/' ) {	// ignore a space right after a slash
 		} else if ( *s == ')' || *s == ',' ) {		// always ignore these
 		} else {
-			*f = *s;
-			f++;
+			fileName += *s;
 		}
 	}
-	*f++ = 0;
-	strcat( fileName, ".dds" );
+	fileName += ext;
+}
+
+/*
+================
+ImageProgramStringToFileCompressedFileName
+================
+*/
+void idImage::ImageProgramStringToCompressedFileName( const char *imageProg, char *fileName ) const {
+	idStr	name;
+
+	R_ImageProgramStringToFileName( imageProg, "dds/", ".dds", name );
+	strcpy( fileName, name.c_str() );
 }
 
 /*
@@ -1647,6 +1656,325 @@ void	idImage::ActuallyLoadImage( bool checkForPrecompressed, bool fromBackEnd )
 	}
 }
 
+/*
+===============
+R_DecodedLevel
+
+Returns a mip level of the power of two image of a decode
+===============
+*/
+static byte *R_DecodedLevel( const imageDecode_t *decode, int level, int &width, int &height ) {
+	byte	*data;
+	byte	*next;
+
+	data = decode->potPic ? decode->potPic : decode->pic;
+	next = decode->mips;
+	width = decode->potWidth;
+	height = decode->potHeight;
+
+	for ( int i = 0 ; i < level ; i++ ) {
+		width >>= 1;
+		height >>= 1;
+		if ( width < 1 ) {
+			width = 1;
+		}
+		if ( height < 1 ) {
+			height = 1;
+		}
+		data = next;
+		next += width * height * 4;
+	}
+
+	return data;
+}
+
+/*
+===============
+R_DecodeImageJob
+
+Does the work of R_LoadImage and GenerateImage between reading the file
+and uploading the texture, everything was allocated by StartDecode.
+===============
+*/
+void R_DecodeImageJob( void *data ) {
+	imageDecode_t *decode = (imageDecode_t *)data;
+	int		width, height;
+	byte	*in, *out;
+
+	if ( !R_DecodeImageFile( &decode->file, decode->pic ) ) {
+		decode->failed = true;
+		return;
+	}
+
+	// convert to exact power of 2 sizes
+	in = decode->pic;
+	if ( decode->potPic ) {
+		R_ResampleTextureTo( decode->pic, decode->file.width, decode->file.height, decode->potPic, decode->potWidth, decode->potHeight );
+		in = decode->potPic;
+	}
+	width = decode->potWidth;
+	height = decode->potHeight;
+
+	// build a hash for checking duplicate image files
+	decode->imageHash = MD4_BlockChecksum( in, width * height * 4 );
+
+	// select proper internal format before we resample
+	decode->internalFormat = decode->image->SelectInternalFormat( (const byte **)&in, 1, width, height, decode->depth );
+
+	// mip map down to the size that gets uploaded
+	out = decode->mips;
+	decode->firstLevel = 0;
+	while ( width > decode->uploadWidth || height > decode->uploadHeight ) {
+		R_MipMapTo( in, width, height, out, decode->preserveBorder );
+
+		width >>= 1;
+		height >>= 1;
+		if ( width < 1 ) {
+			width = 1;
+		}
+		if ( height < 1 ) {
+			height = 1;
+		}
+		in = out;
+		out += width * height * 4;
+		decode->firstLevel++;
+	}
+
+	// zero the border if desired, allowing clamped projection textures
+	// even after picmip resampling or careless artists.
+	if ( decode->zeroBorder ) {
+		byte	rgba[4];
+
+		rgba[0] = rgba[1] = rgba[2] = 0;
+		rgba[3] = 255;
+		R_SetBorderTexels( in, width, height, rgba );
+	}
+	if ( decode->zeroBorderAlpha ) {
+		byte	rgba[4];
+
+		rgba[0] = rgba[1] = rgba[2] = 255;
+		rgba[3] = 0;
+		R_SetBorderTexels( in, width, height, rgba );
+	}
+
+	// swap the red and alpha for rxgb support
+	if ( decode->swapNormalAlpha ) {
+		for ( int i = 0; i < width * height * 4; i += 4 ) {
+			in[ i + 3 ] = in[ i ];
+			in[ i ] = 0;
+		}
+	}
+
+	// create the mip map levels
+	int		miplevel;
+
+	miplevel = 0;
+	while ( width > 1 || height > 1 ) {
+		R_MipMapTo( in, width, height, out, decode->preserveBorder );
+
+		width >>= 1;
+		height >>= 1;
+		if ( width < 1 ) {
+			width = 1;
+		}
+		if ( height < 1 ) {
+			height = 1;
+		}
+		in = out;
+		out += width * height * 4;
+		miplevel++;
+
+		if ( decode->colorMipLevels ) {
+			R_BlendOverTexture( in, width * height, mipBlendColors[miplevel] );
+		}
+	}
+}
+
+/*
+===============
+CanDecodeInJob
+
+The job only handles plain 2D image files, not image programs,
+and the tga debug output is written in GenerateImage.
+===============
+*/
+bool idImage::CanDecodeInJob() const {
+	if ( generatorFunction || isPartialImage || cubeFiles != CF_2D || !glConfig.isInitialized
+		|| strpbrk( imgName.c_str(), "(\" \t" ) != NULL
+		|| globalImages->image_writeTGA.GetBool() || globalImages->image_writeNormalTGA.GetBool() ) {
+		return false;
+	}
+	return true;
+}
+
+/*
+===============
+StartDecode
+
+Reads the file of an image for R_DecodeImageJob and allocates everything
+the job needs, FinishDecode uploads the result.
+
+Returns false if the image was loaded right away instead, which happens for
+precompressed images and anything R_DecodeImageJob can't handle.
+===============
+*/
+bool idImage::StartDecode( imageDecode_t *decode ) {
+	if ( !CanDecodeInJob() ) {
+		ActuallyLoadImage( true, false );
+		return false;
+	}
+
+	// see if we have a pre-generated image file that is
+	// already image processed and compressed
+	if ( globalImages->image_usePrecompressedTextures.GetBool() ) {
+		if ( CheckPrecompressedImage( true ) ) {
+			return false;
+		}
+	}
+
+	if ( !ReadForDecode( decode ) ) {
+		// the normal load prints the warnings and makes the default image
+		ActuallyLoadImage( false, false );
+		return false;
+	}
+
+	return true;
+}
+
+/*
+===============
+ReadForDecode
+
+The part of StartDecode that reads the file and allocates the buffers,
+returns false without loading anything if the job can't decode the file.
+===============
+*/
+bool idImage::ReadForDecode( imageDecode_t *decode ) {
+	memset( decode, 0, sizeof( *decode ) );
+	decode->image = this;
+
+	if ( !R_ReadImageFile( imgName, &decode->file ) ) {
+		return false;
+	}
+
+	// same as the power of 2 conversion in R_LoadImage
+	for ( decode->potWidth = 1 ; decode->potWidth < decode->file.width ; decode->potWidth <<= 1 )
+		;
+	for ( decode->potHeight = 1 ; decode->potHeight < decode->file.height ; decode->potHeight <<= 1 )
+		;
+	if ( decode->potWidth != decode->file.width || decode->potHeight != decode->file.height ) {
+		if ( globalImages->image_roundDown.GetBool() && decode->potWidth > decode->file.width ) {
+			decode->potWidth >>= 1;
+		}
+		if ( globalImages->image_roundDown.GetBool() && decode->potHeight > decode->file.height ) {
+			decode->potHeight >>= 1;
+		}
+		if ( decode->potWidth > MAX_RESAMPLE_DIMENSION || decode->potHeight > MAX_RESAMPLE_DIMENSION ) {
+			R_FreeImageFile( &decode->file );
+			return false;
+		}
+		decode->potPic = (byte *)R_StaticAlloc( decode->potWidth * decode->potHeight * 4 );
+	}
+	decode->pic = (byte *)R_StaticAlloc( decode->file.width * decode->file.height * 4 );
+
+	decode->uploadWidth = decode->potWidth;
+	decode->uploadHeight = decode->potHeight;
+	GetDownsize( decode->uploadWidth, decode->uploadHeight );
+
+	// all the levels below the power of two image
+	int		mipSize = 0;
+	int		width = decode->potWidth;
+	int		height = decode->potHeight;
+	while ( width > 1 || height > 1 ) {
+		width = Max( width >> 1, 1 );
+		height = Max( height >> 1, 1 );
+		mipSize += width * height * 4;
+	}
+	decode->mips = (byte *)R_StaticAlloc( mipSize );
+
+	decode->depth = depth;
+	decode->allowDownSize = allowDownSize;
+	decode->preserveBorder = ( repeat == TR_CLAMP_TO_ZERO );
+	decode->zeroBorder = ( repeat == TR_CLAMP_TO_ZERO );
+	decode->zeroBorderAlpha = ( repeat == TR_CLAMP_TO_ZERO_ALPHA );
+	decode->swapNormalAlpha = ( depth == TD_BUMP && globalImages->image_useNormalCompression.GetInteger() != 1 );
+	decode->colorMipLevels = ( depth == TD_DIFFUSE && globalImages->image_colorMipLevels.GetBool() );
+
+	return true;
+}
+
+/*
+===============
+FinishDecode
+
+Uploads the mip levels made by R_DecodeImageJob, like GenerateImage would
+===============
+*/
+void idImage::FinishDecode( imageDecode_t *decode ) {
+	int		width, height;
+	int		level, miplevel;
+	byte	*data;
+
+	R_FreeImageFile( &decode->file );
+
+	if ( decode->failed ) {
+		R_StaticFree( decode->pic );
+		R_StaticFree( decode->potPic );
+		R_StaticFree( decode->mips );
+
+		// the normal load prints the warnings and makes the default image
+		ActuallyLoadImage( false, false );
+		return;
+	}
+
+	PurgeImage();
+
+	// generate the texture number
+	glGenTextures( 1, &texnum );
+
+	internalFormat = decode->internalFormat;
+
+	R_DecodedLevel( decode, decode->firstLevel, width, height );
+	uploadWidth = width;
+	uploadHeight = height;
+	type = TT_2D;
+
+	Bind();
+
+	level = decode->firstLevel;
+	miplevel = 0;
+	while ( 1 ) {
+		data = R_DecodedLevel( decode, level, width, height );
+		if ( internalFormat == GL_COLOR_INDEX8_EXT ) {
+			UploadCompressedNormalMap( width, height, data, miplevel );
+		} else {
+			glTexImage2D( GL_TEXTURE_2D, miplevel, internalFormat, width, height,
+				0, GL_RGBA, GL_UNSIGNED_BYTE, data );
+		}
+		if ( width == 1 && height == 1 ) {
+			break;
+		}
+		level++;
+		miplevel++;
+	}
+
+	SetImageFilterAndRepeat();
+
+	// see if we messed anything up
+	GL_CheckErrors();
+
+	imageHash = decode->imageHash;
+	timestamp = decode->file.timestamp;
+	precompressedFile = false;
+
+	R_StaticFree( decode->pic );
+	R_StaticFree( decode->potPic );
+	R_StaticFree( decode->mips );
+
+	// write out the precompressed version of this file if needed
+	WritePrecompressedImage();
+}
+
 //=========================================================================================================
 
 /*
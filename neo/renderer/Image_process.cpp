@@ -43,24 +43,40 @@ If a larger shrinking is needed, use the mipmap function
 after resampling to the next lower power of two.
 ================
 */
-#define	MAX_DIMENSION	4096
 byte *R_ResampleTexture( const byte *in, int inwidth, int inheight,
 							int outwidth, int outheight ) {
-	int		i, j;
-	const byte	*inrow, *inrow2;
-	unsigned int	frac, fracstep;
-	unsigned int	p1[MAX_DIMENSION], p2[MAX_DIMENSION];
-	const byte		*pix1, *pix2, *pix3, *pix4;
-	byte		*out, *out_p;
+	byte		*out;
 
-	if ( outwidth > MAX_DIMENSION ) {
-		outwidth = MAX_DIMENSION;
+	if ( outwidth > MAX_RESAMPLE_DIMENSION ) {
+		outwidth = MAX_RESAMPLE_DIMENSION;
 	}
-	if ( outheight > MAX_DIMENSION ) {
-		outheight = MAX_DIMENSION;
+	if ( outheight > MAX_RESAMPLE_DIMENSION ) {
+		outheight = MAX_RESAMPLE_DIMENSION;
 	}
 
 	out = (byte *)R_StaticAlloc( outwidth * outheight * 4 );
+	R_ResampleTextureTo( in, inwidth, inheight, out, outwidth, outheight );
+
+	return out;
+}
+
+/*
+================
+R_ResampleTextureTo
+
+Same as R_ResampleTexture, but writes to the provided buffer and doesn't
+allocate, so it can be used by jobs.  The output size must not be larger
+than MAX_RESAMPLE_DIMENSION.
+================
+*/
+void R_ResampleTextureTo( const byte *in, int inwidth, int inheight,
+							byte *out, int outwidth, int outheight ) {
+	int		i;
+	const byte	*inrow, *inrow2;
+	unsigned int	frac, fracstep;
+	unsigned int	p1[MAX_RESAMPLE_DIMENSION], p2[MAX_RESAMPLE_DIMENSION];
+	byte		*out_p;
+
 	out_p = out;
 
 	fracstep = inwidth*0x10000/outwidth;
@@ -79,20 +95,8 @@ byte *R_ResampleTexture( const byte *in, int inwidth, int inheight,
 	for (i=0 ; i<outheight ; i++, out_p += outwidth*4 ) {
 		inrow = in + 4 * inwidth * (int)( ( i + 0.25f ) * inheight / outheight );
 		inrow2 = in + 4 * inwidth * (int)( ( i + 0.75f ) * inheight / outheight );
-		frac = fracstep >> 1;
-		for (j=0 ; j<outwidth ; j++) {
-			pix1 = inrow + p1[j];
-			pix2 = inrow + p2[j];
-			pix3 = inrow2 + p1[j];
-			pix4 = inrow2 + p2[j];
-			out_p[j*4+0] = (pix1[0] + pix2[0] + pix3[0] + pix4[0])>>2;
-			out_p[j*4+1] = (pix1[1] + pix2[1] + pix3[1] + pix4[1])>>2;
-			out_p[j*4+2] = (pix1[2] + pix2[2] + pix3[2] + pix4[2])>>2;
-			out_p[j*4+3] = (pix1[3] + pix2[3] + pix3[3] + pix4[3])>>2;
-		}
+		SIMDProcessor->ResampleImageRow( out_p, inrow, inrow2, p1, p2, outwidth );
 	}
-
-	return out;
 }
 
 /*
@@ -391,24 +395,13 @@ smeared clamps...
 ================
 */
 byte *R_MipMap( const byte *in, int width, int height, bool preserveBorder ) {
-	int		i, j;
-	const byte	*in_p;
-	byte	*out, *out_p;
-	int		row;
-	byte	border[4];
+	byte	*out;
 	int		newWidth, newHeight;
 
 	if ( width < 1 || height < 1 || ( width + height == 2 ) ) {
 		common->FatalError( "R_MipMap called with size %i,%i", width, height );
 	}
 
-	border[0] = in[0];
-	border[1] = in[1];
-	border[2] = in[2];
-	border[3] = in[3];
-
-	row = width * 4;
-
 	newWidth = width >> 1;
 	newHeight = height >> 1;
 	if ( !newWidth ) {
@@ -418,10 +411,37 @@ byte *R_MipMap( const byte *in, int width, int height, bool preserveBorder ) {
 		newHeight = 1;
 	}
 	out = (byte *)R_StaticAlloc( newWidth * newHeight * 4 );
+	R_MipMapTo( in, width, height, out, preserveBorder );
+
+	return out;
+}
+
+/*
+================
+R_MipMapTo
+
+Same as R_MipMap, but writes the next level to the provided buffer and
+doesn't allocate, so it can be used by jobs.
+================
+*/
+void R_MipMapTo( const byte *in, int width, int height, byte *out, bool preserveBorder ) {
+	int		i;
+	const byte	*in_p;
+	byte	*out_p;
+	byte	border[4];
+	int		inWidth, inHeight;
+
+	border[0] = in[0];
+	border[1] = in[1];
+	border[2] = in[2];
+	border[3] = in[3];
+
 	out_p = out;
 
 	in_p = in;
 
+	inWidth = width;
+	inHeight = height;
 	width >>= 1;
 	height >>= 1;
 
@@ -442,24 +462,15 @@ byte *R_MipMap( const byte *in, int width, int height, bool preserveBorder ) {
 				out_p[3] = ( in_p[3] + in_p[7] )>>1;
 			}
 		}
-		return out;
+		return;
 	}
 
-	for (i=0 ; i<height ; i++, in_p+=row) {
-		for (j=0 ; j<width ; j++, out_p+=4, in_p+=8) {
-			out_p[0] = (in_p[0] + in_p[4] + in_p[row+0] + in_p[row+4])>>2;
-			out_p[1] = (in_p[1] + in_p[5] + in_p[row+1] + in_p[row+5])>>2;
-			out_p[2] = (in_p[2] + in_p[6] + in_p[row+2] + in_p[row+6])>>2;
-			out_p[3] = (in_p[3] + in_p[7] + in_p[row+3] + in_p[row+7])>>2;
-		}
-	}
+	SIMDProcessor->MipMapImage( out, in, inWidth, inHeight );
 
 	// copy the old border texel back around if desired
 	if ( preserveBorder ) {
 		R_SetBorderTexels( out, width, height, border );
 	}
-
-	return out;
 }
 
 /*
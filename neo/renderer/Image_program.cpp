@@ -83,47 +83,8 @@ static void R_HeightmapToNormalMap( byte *data, int width, int height, float sca
 		depth[i] = ( data[i*4] + data[i*4+1] + data[i*4+2] ) / 3;
 	}
 
-	idVec3	dir, dir2;
-	for ( i = 0 ; i < height ; i++ ) {
-		for ( j = 0 ; j < width ; j++ ) {
-			int		d1, d2, d3, d4;
-			int		a1, a3, a4;
-
-			// FIXME: look at five points?
-
-			// look at three points to estimate the gradient
-			a1 = d1 = depth[ ( i * width + j ) ];
-			d2 = depth[ ( i * width + ( ( j + 1 ) & ( width - 1 ) ) ) ];
-			a3 = d3 = depth[ ( ( ( i + 1 ) & ( height - 1 ) ) * width + j ) ];
-			a4 = d4 = depth[ ( ( ( i + 1 ) & ( height - 1 ) ) * width + ( ( j + 1 ) & ( width - 1 ) ) ) ];
-
-			d2 -= d1;
-			d3 -= d1;
-
-			dir[0] = -d2 * scale;
-			dir[1] = -d3 * scale;
-			dir[2] = 1;
-			dir.NormalizeFast();
-
-			a1 -= a3;
-			a4 -= a3;
-
-			dir2[0] = -a4 * scale;
-			dir2[1] = a1 * scale;
-			dir2[2] = 1;
-			dir2.NormalizeFast();
-
-			dir += dir2;
-			dir.NormalizeFast();
-
-			a1 = ( i * width + j ) * 4;
-			data[ a1 + 0 ] = (byte)(dir[0] * 127 + 128);
-			data[ a1 + 1 ] = (byte)(dir[1] * 127 + 128);
-			data[ a1 + 2 ] = (byte)(dir[2] * 127 + 128);
-			data[ a1 + 3 ] = 255;
-		}
-	}
-
+	// FIXME: look at five points?
+	SIMDProcessor->HeightmapToNormalMap( data, depth, width, height, scale );
 
 	R_StaticFree( depth );
 }
@@ -193,7 +154,6 @@ R_AddNormalMaps
 ===================
 */
 static void R_AddNormalMaps( byte *data1, int width1, int height1, byte *data2, int width2, int height2 ) {
-	int		i, j;
 	byte	*newMap;
 
 	// resample pic2 to the same size as pic1
@@ -205,36 +165,7 @@ static void R_AddNormalMaps( byte *data1, int width1, int height1, byte *data2,
 	}
 
 	// add the normal change from the second and renormalize
-	for ( i = 0 ; i < height1 ; i++ ) {
-		for ( j = 0 ; j < width1 ; j++ ) {
-			byte	*d1, *d2;
-			idVec3	n;
-			float   len;
-
-			d1 = data1 + ( i * width1 + j ) * 4;
-			d2 = data2 + ( i * width1 + j ) * 4;
-
-			n[0] = ( d1[0] - 128 ) / 127.0;
-			n[1] = ( d1[1] - 128 ) / 127.0;
-			n[2] = ( d1[2] - 128 ) / 127.0;
-
-			// There are some normal maps that blend to 0,0,0 at the edges
-			// this screws up compression, so we try to correct that here by instead fading it to 0,0,1
-			len = n.LengthFast();
-			if ( len < 1.0f ) {
-				n[2] = idMath::Sqrt( idMath::ClampFloat( 0.0f, 1.0f, 1.0 - (n[0] * n[0]) - (n[1] * n[1] ) ) );
-			}
-
-			n[0] += ( d2[0] - 128 ) / 127.0;
-			n[1] += ( d2[1] - 128 ) / 127.0;
-			n.Normalize();
-
-			d1[0] = (byte)(n[0] * 127 + 128);
-			d1[1] = (byte)(n[1] * 127 + 128);
-			d1[2] = (byte)(n[2] * 127 + 128);
-			d1[3] = 255;
-		}
-	}
+	SIMDProcessor->AddNormalMaps( data1, data2, width1 * height1 );
 
 	if ( newMap ) {
 		R_StaticFree( newMap );
@@ -248,47 +179,11 @@ R_SmoothNormalMap
 */
 static void R_SmoothNormalMap( byte *data, int width, int height ) {
 	byte	*orig;
-	int		i, j, k, l;
-	idVec3	normal;
-	byte	*out;
-	static float	factors[3][3] = {
-		{ 1, 1, 1 },
-		{ 1, 1, 1 },
-		{ 1, 1, 1 }
-	};
 
 	orig = (byte *)R_StaticAlloc( width * height * 4 );
 	memcpy( orig, data, width * height * 4 );
 
-	for ( i = 0 ; i < width ; i++ ) {
-		for ( j = 0 ; j < height ; j++ ) {
-			normal = vec3_origin;
-			for ( k = -1 ; k < 2 ; k++ ) {
-				for ( l = -1 ; l < 2 ; l++ ) {
-					byte	*in;
-
-					in = orig + ( ((j+l)&(height-1))*width + ((i+k)&(width-1)) ) * 4;
-
-					// ignore 000 and -1 -1 -1
-					if ( in[0] == 0 && in[1] == 0 && in[2] == 0 ) {
-						continue;
-					}
-					if ( in[0] == 128 && in[1] == 128 && in[2] == 128 ) {
-						continue;
-					}
-
-					normal[0] += factors[k+1][l+1] * ( in[0] - 128 );
-					normal[1] += factors[k+1][l+1] * ( in[1] - 128 );
-					normal[2] += factors[k+1][l+1] * ( in[2] - 128 );
-				}
-			}
-			normal.Normalize();
-			out = data + ( j * width + i ) * 4;
-			out[0] = (byte)(128 + 127 * normal[0]);
-			out[1] = (byte)(128 + 127 * normal[1]);
-			out[2] = (byte)(128 + 127 * normal[2]);
-		}
-	}
+	SIMDProcessor->SmoothNormalMap( data, orig, width, height );
 
 	R_StaticFree( orig );
 }
@@ -333,6 +228,9 @@ static void R_ImageAdd( byte *data1, int width1, int height1, byte *data2, int w
 // we build a canonical token form of the image program here
 static char parseBuffer[MAX_IMAGE_NAME];
 
+// when set, R_ParseImageProgram_r appends the timestamp of every source image in program order
+static idList<ID_TIME_T> *	parseSourceTimes;
+
 /*
 ===================
 AppendToken
@@ -599,18 +497,179 @@ static bool R_ParseImageProgram_r( idLexer &src, byte **pic, int *width, int *he
 			*timestamps = timestamp;
 		}
 	}
+	if ( parseSourceTimes ) {
+		parseSourceTimes->Append( timestamp );
+	}
 
 	return true;
 }
 
 
+static const int IMAGE_PROGRAM_CACHE_MAGIC		= ( 'I' << 24 ) | ( 'P' << 16 ) | ( 'R' << 8 ) | 'C';
+static const int IMAGE_PROGRAM_CACHE_VERSION	= 2;
+
+/*
+===================
+R_IsImageProgram
+
+True if the name starts with a function like heightmap( or addnormals(,
+plain image names aren't worth caching.
+===================
+*/
+static bool R_IsImageProgram( const char *name ) {
+	idLexer		src;
+	idToken		token;
+
+	src.LoadMemory( name, strlen(name), name );
+	src.SetFlags( LEXFL_NOFATALERRORS | LEXFL_NOSTRINGCONCAT | LEXFL_NOSTRINGESCAPECHARS | LEXFL_ALLOWPATHNAMES | LEXFL_NOERRORS );
+
+	return src.ReadToken( &token ) && token.type == TT_NAME && src.CheckTokenString( "(" );
+}
+
+/*
+===================
+R_ReadImageProgramCache
+
+Loads the result of an image program written by R_WriteImageProgramCache if
+none of the source images have changed since.  Every source timestamp is compared,
+not just the newest, so a source replaced by an older file is noticed too.
+===================
+*/
+static bool R_ReadImageProgramCache( const char *name, const char *cacheName, const idList<ID_TIME_T> &sourceTimes,
+									byte **pic, int *width, int *height, bool *bump ) {
+	idStr		program;
+	int			magic, version, numSourceTimes, cacheSourceTime, w, h;
+	bool		roundDown;
+
+	idFile *f = fileSystem->OpenFileRead( cacheName );
+	if ( !f ) {
+		return false;
+	}
+
+	f->ReadInt( magic );
+	f->ReadInt( version );
+	if ( magic != IMAGE_PROGRAM_CACHE_MAGIC || version != IMAGE_PROGRAM_CACHE_VERSION ) {
+		fileSystem->CloseFile( f );
+		return false;
+	}
+
+	f->ReadString( program );
+	f->ReadInt( numSourceTimes );
+	if ( program.Cmp( name ) || numSourceTimes != sourceTimes.Num() ) {
+		common->DPrintf( "%s is out of date\n", cacheName );
+		fileSystem->CloseFile( f );
+		return false;
+	}
+	for ( int i = 0 ; i < numSourceTimes ; i++ ) {
+		f->ReadInt( cacheSourceTime );
+		if ( cacheSourceTime != (int)sourceTimes[i] ) {
+			common->DPrintf( "%s is out of date\n", cacheName );
+			fileSystem->CloseFile( f );
+			return false;
+		}
+	}
+	f->ReadBool( roundDown );
+	f->ReadInt( w );
+	f->ReadInt( h );
+	f->ReadBool( *bump );
+
+	// the mangled file name isn't unique, so the program itself is checked
+	if ( roundDown != globalImages->image_roundDown.GetBool()
+			|| w <= 0 || h <= 0 || w > MAX_RESAMPLE_DIMENSION || h > MAX_RESAMPLE_DIMENSION
+			|| f->Length() - f->Tell() != w * h * 4 ) {
+		common->DPrintf( "%s is out of date\n", cacheName );
+		fileSystem->CloseFile( f );
+		return false;
+	}
+
+	*pic = (byte *)R_StaticAlloc( w * h * 4 );
+	if ( f->Read( *pic, w * h * 4 ) != w * h * 4 ) {
+		R_StaticFree( *pic );
+		*pic = NULL;
+		fileSystem->CloseFile( f );
+		return false;
+	}
+	fileSystem->CloseFile( f );
+
+	*width = w;
+	*height = h;
+
+	return true;
+}
+
+/*
+===================
+R_WriteImageProgramCache
+===================
+*/
+static void R_WriteImageProgramCache( const char *name, const char *cacheName, const idList<ID_TIME_T> &sourceTimes,
+									const byte *pic, int width, int height, bool bump ) {
+	idFile *f = fileSystem->OpenFileWrite( cacheName );
+	if ( !f ) {
+		common->Warning( "Couldn't write %s", cacheName );
+		return;
+	}
+
+	f->WriteInt( IMAGE_PROGRAM_CACHE_MAGIC );
+	f->WriteInt( IMAGE_PROGRAM_CACHE_VERSION );
+	f->WriteString( name );
+	f->WriteInt( sourceTimes.Num() );
+	for ( int i = 0 ; i < sourceTimes.Num() ; i++ ) {
+		f->WriteInt( (int)sourceTimes[i] );
+	}
+	f->WriteBool( globalImages->image_roundDown.GetBool() );
+	f->WriteInt( width );
+	f->WriteInt( height );
+	f->WriteBool( bump );
+	f->Write( pic, width * height * 4 );
+
+	fileSystem->CloseFile( f );
+}
+
 /*
 ===================
 R_LoadImageProgram
+
+The results of image programs are cached in IMAGE_PROGRAM_CACHE_DIR, keyed by
+the program and the timestamps of its source images, so reloads skip the
+image math.
 ===================
 */
 void R_LoadImageProgram( const char *name, byte **pic, int *width, int *height, ID_TIME_T *timestamps, textureDepth_t *depth ) {
 	idLexer src;
+	idStr	cacheName;
+	ID_TIME_T	sourceTime = FILE_NOT_FOUND_TIMESTAMP;
+	idList<ID_TIME_T>	sourceTimes;
+	textureDepth_t	programDepth;
+	bool	bump;
+
+	if ( pic && globalImages->image_useProgramCache.GetBool() && R_IsImageProgram( name ) ) {
+		// only the timestamps of the source images
+		src.LoadMemory( name, strlen(name), name );
+		src.SetFlags( LEXFL_NOFATALERRORS | LEXFL_NOSTRINGCONCAT | LEXFL_NOSTRINGESCAPECHARS | LEXFL_ALLOWPATHNAMES );
+		parseBuffer[0] = 0;
+		sourceTime = 0;
+		parseSourceTimes = &sourceTimes;
+		if ( !R_ParseImageProgram_r( src, NULL, NULL, NULL, &sourceTime, NULL ) ) {
+			sourceTime = FILE_NOT_FOUND_TIMESTAMP;
+		}
+		parseSourceTimes = NULL;
+		src.FreeSource();
+
+		if ( sourceTime != FILE_NOT_FOUND_TIMESTAMP ) {
+			R_ImageProgramStringToFileName( name, IMAGE_PROGRAM_CACHE_DIR, IMAGE_PROGRAM_CACHE_EXT, cacheName );
+
+			if ( R_ReadImageProgramCache( name, cacheName, sourceTimes, pic, width, height, &bump ) ) {
+				if ( timestamps ) {
+					*timestamps = sourceTime;
+				}
+				if ( bump && depth ) {
+					*depth = TD_BUMP;
+				}
+				return;
+			}
+		}
+	}
 
 	src.LoadMemory( name, strlen(name), name );
 	src.SetFlags( LEXFL_NOFATALERRORS | LEXFL_NOSTRINGCONCAT | LEXFL_NOSTRINGESCAPECHARS | LEXFL_ALLOWPATHNAMES );
@@ -620,9 +679,19 @@ void R_LoadImageProgram( const char *name, byte **pic, int *width, int *height,
 		*timestamps = 0;
 	}
 
-	R_ParseImageProgram_r( src, pic, width, height, timestamps, depth );
+	// the programs only ever change the depth to TD_BUMP
+	programDepth = TD_DEFAULT;
+	R_ParseImageProgram_r( src, pic, width, height, timestamps, &programDepth );
+	bump = ( programDepth == TD_BUMP );
+	if ( bump && depth ) {
+		*depth = TD_BUMP;
+	}
 
 	src.FreeSource();
+
+	if ( cacheName.Length() && *pic ) {
+		R_WriteImageProgramCache( name, cacheName, sourceTimes, *pic, *width, *height, bump );
+	}
 }
 
 /*
@@ -635,3 +704,170 @@ const char *R_ParsePastImageProgram( idLexer &src ) {
 	R_ParseImageProgram_r( src, NULL, NULL, NULL, NULL, NULL );
 	return parseBuffer;
 }
+
+typedef enum {
+	IMAGE_KERNEL_MIPMAP,
+	IMAGE_KERNEL_RESAMPLE,
+	IMAGE_KERNEL_HEIGHTMAP,
+	IMAGE_KERNEL_ADDNORMALS,
+	IMAGE_KERNEL_SMOOTHNORMALS,
+	IMAGE_KERNEL_COUNT
+} imageKernel_t;
+
+static const char *imageKernelNames[IMAGE_KERNEL_COUNT] = {
+	"mip map",
+	"resample 3/4",
+	"heightmap",
+	"addnormals",
+	"smoothnormals"
+};
+
+/*
+===================
+R_BenchmarkImageKernel
+
+Runs one image processing kernel over a size x size image, in msec per iteration.
+The result is left in out.
+===================
+*/
+static double R_BenchmarkImageKernel( imageKernel_t kernel, const byte *pic, const byte *normals, const byte *heights, byte *out, int size, int iterations ) {
+	const int resampleSize = size * 3 / 4;
+	unsigned int *offsets1 = (unsigned int *)_alloca( resampleSize * sizeof( offsets1[0] ) );
+	unsigned int *offsets2 = (unsigned int *)_alloca( resampleSize * sizeof( offsets2[0] ) );
+	unsigned int frac, fracstep;
+	int i;
+
+	// same offsets as R_ResampleTextureTo
+	fracstep = ( size << 16 ) / resampleSize;
+	frac = fracstep >> 2;
+	for ( i = 0 ; i < resampleSize ; i++ ) {
+		offsets1[i] = 4 * ( frac >> 16 );
+		frac += fracstep;
+	}
+	frac = 3 * ( fracstep >> 2 );
+	for ( i = 0 ; i < resampleSize ; i++ ) {
+		offsets2[i] = 4 * ( frac >> 16 );
+		frac += fracstep;
+	}
+
+	// the SIMD kernels take well under a msec per image, so time in usec
+	const int64_t start = frameProfiler->Microseconds();
+
+	for ( i = 0 ; i < iterations ; i++ ) {
+		switch( kernel ) {
+			case IMAGE_KERNEL_MIPMAP:
+				SIMDProcessor->MipMapImage( out, pic, size, size );
+				break;
+			case IMAGE_KERNEL_RESAMPLE:
+				for ( int j = 0 ; j < resampleSize ; j++ ) {
+					const byte *row1 = pic + size * 4 * (int)( ( j + 0.25f ) * size / resampleSize );
+					const byte *row2 = pic + size * 4 * (int)( ( j + 0.75f ) * size / resampleSize );
+					SIMDProcessor->ResampleImageRow( out + j * resampleSize * 4, row1, row2, offsets1, offsets2, resampleSize );
+				}
+				break;
+			case IMAGE_KERNEL_HEIGHTMAP:
+				SIMDProcessor->HeightmapToNormalMap( out, heights, size, size, 4.0f / 256 );
+				break;
+			case IMAGE_KERNEL_ADDNORMALS:
+				memcpy( out, normals, size * size * 4 );
+				SIMDProcessor->AddNormalMaps( out, pic, size * size );
+				break;
+			case IMAGE_KERNEL_SMOOTHNORMALS:
+				SIMDProcessor->SmoothNormalMap( out, normals, size, size );
+				break;
+			default:
+				break;
+		}
+	}
+
+	const int64_t usec = frameProfiler->Microseconds() - start;
+
+	return usec * 0.001 / iterations;
+}
+
+/*
+===================
+R_BenchmarkImageProcessing_f
+
+Times the mip map, resample and normal map kernels used at image load time
+with the active and the generic SIMD processor on a synthetic texture, and
+reports the largest difference between the two results.
+
+benchmarkImageProcessing [size] [iterations]
+===================
+*/
+void R_BenchmarkImageProcessing_f( const idCmdArgs &args ) {
+	idRandom	random;
+	byte *		pic;
+	byte *		normals;
+	byte *		heights;
+	byte *		out[2];
+	double		msec[2];
+	int			size, iterations;
+	int			i, j;
+
+	size = 1024;
+	if ( args.Argc() > 1 ) {
+		size = MakePowerOfTwo( idMath::ClampInt( 8, MAX_RESAMPLE_DIMENSION, atoi( args.Argv( 1 ) ) ) );
+	}
+	iterations = 10;
+	if ( args.Argc() > 2 ) {
+		iterations = Max( atoi( args.Argv( 2 ) ), 1 );
+	}
+
+	const int numPixels = size * size;
+
+	pic = (byte *)R_StaticAlloc( numPixels * 4 );
+	normals = (byte *)R_StaticAlloc( numPixels * 4 );
+	heights = (byte *)R_StaticAlloc( numPixels );
+	out[0] = (byte *)R_StaticAlloc( numPixels * 4 );
+	out[1] = (byte *)R_StaticAlloc( numPixels * 4 );
+
+	// noise for the color image, a smooth height field with noise on top, and
+	// a normal map with some of the 0,0,0 and 128,128,128 texels smoothing skips
+	for ( i = 0 ; i < numPixels * 4 ; i++ ) {
+		pic[i] = random.RandomInt( 256 );
+	}
+	for ( i = 0 ; i < numPixels ; i++ ) {
+		const float s = idMath::Sin( ( i % size ) * 0.05f ) + idMath::Cos( ( i / size ) * 0.03f );
+		heights[i] = idMath::ClampInt( 0, 255, idMath::FtoiFast( 128.0f + s * 48.0f ) + random.RandomInt( 16 ) );
+	}
+	for ( i = 0 ; i < numPixels ; i++ ) {
+		idVec3 n( random.CRandomFloat(), random.CRandomFloat(), random.RandomFloat() );
+		n.Normalize();
+		normals[i*4+0] = (byte)( n[0] * 127 + 128 );
+		normals[i*4+1] = (byte)( n[1] * 127 + 128 );
+		normals[i*4+2] = (byte)( n[2] * 127 + 128 );
+		normals[i*4+3] = 255;
+		if ( random.RandomInt( 16 ) == 0 ) {
+			memset( normals + i * 4, random.RandomInt( 2 ) ? 128 : 0, 3 );
+		}
+	}
+
+	common->Printf( "%ix%i image, %i iterations\n", size, size, iterations );
+	common->Printf( "msec per iteration     %-12s generic      max difference\n", SIMDProcessor->GetName() );
+
+	for ( i = 0 ; i < IMAGE_KERNEL_COUNT ; i++ ) {
+		int maxDiff = 0;
+
+		memcpy( out[0], normals, numPixels * 4 );
+		memcpy( out[1], normals, numPixels * 4 );
+
+		msec[0] = R_BenchmarkImageKernel( (imageKernel_t)i, pic, normals, heights, out[0], size, iterations );
+		idSIMD::InitProcessor( "benchmarkImageProcessing", true );
+		msec[1] = R_BenchmarkImageKernel( (imageKernel_t)i, pic, normals, heights, out[1], size, iterations );
+		idSIMD::InitProcessor( "benchmarkImageProcessing", cvarSystem->GetCVarBool( "com_forceGenericSIMD" ) );
+
+		for ( j = 0 ; j < numPixels * 4 ; j++ ) {
+			maxDiff = Max( maxDiff, abs( out[0][j] - out[1][j] ) );
+		}
+
+		common->Printf( "%-22s %-12.4f %-12.4f %i\n", imageKernelNames[i], msec[0], msec[1], maxDiff );
+	}
+
+	R_StaticFree( pic );
+	R_StaticFree( normals );
+	R_StaticFree( heights );
+	R_StaticFree( out[0] );
+	R_StaticFree( out[1] );
+}
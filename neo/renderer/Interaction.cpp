@@ -49,9 +49,13 @@ We want to cull a little on the sloppy side, because the pre-clipping
 of geometry to the lights in dmap will give many cases that are right
 at the border we throw things out on the border, because if any one
 vertex is clearly inside, the entire triangle will be accepted.
+
+If cullBits is given it is used instead of allocating the cull bits,
+so this can be called from a parallel job.  The buffer is not used if
+the surface is completely inside the light.
 =====================
 */
-void R_CalcInteractionCullBits( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo ) {
+void R_CalcInteractionCullBits( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo, byte *cullBits ) {
 	int i, frontBits;
 
 	if ( cullInfo.cullBits != NULL ) {
@@ -77,7 +81,11 @@ void R_CalcInteractionCullBits( const idRenderEntityLocal *ent, const srfTriangl
 		return;
 	}
 
-	cullInfo.cullBits = (byte *) R_StaticAlloc( tri->numVerts * sizeof( cullInfo.cullBits[0] ) );
+	if ( cullBits ) {
+		cullInfo.cullBits = cullBits;
+	} else {
+		cullInfo.cullBits = (byte *) R_StaticAlloc( tri->numVerts * sizeof( cullInfo.cullBits[0] ) );
+	}
 	SIMDProcessor->Memset( cullInfo.cullBits, 0, tri->numVerts * sizeof( cullInfo.cullBits[0] ) );
 
 	float *planeSide = (float *) _alloca16( tri->numVerts * sizeof( float ) );
@@ -245,6 +253,7 @@ idInteraction::idInteraction( void ) {
 	lightPrev				= NULL;
 	entityNext				= NULL;
 	entityPrev				= NULL;
+	shadowsPending			= false;
 	dynamicModelFrameCount	= 0;
 	frustumState			= FRUSTUM_UNINITIALIZED;
 	frustumAreas			= NULL;
@@ -272,6 +281,7 @@ idInteraction *idInteraction::AllocAndLink( idRenderEntityLocal *edef, idRenderL
 
 	interaction->numSurfaces = -1;		// not checked yet
 	interaction->surfaces = NULL;
+	interaction->shadowsPending = false;
 
 	interaction->frustumState = idInteraction::FRUSTUM_UNINITIALIZED;
 	interaction->frustumAreas = NULL;
@@ -317,6 +327,11 @@ will be regenerated automatically
 ===============
 */
 void idInteraction::FreeSurfaces( void ) {
+	// queued shadow volumes write to the surfaces
+	if ( this->shadowsPending ) {
+		R_CreatePendingInteractionShadows();
+	}
+
 	if ( this->surfaces ) {
 		for ( int i = 0 ; i < this->numSurfaces ; i++ ) {
 			surfaceInteraction_t *sint = &this->surfaces[i];
@@ -598,6 +613,129 @@ bool idInteraction::CullInteractionByViewFrustum( const idFrustum &viewFrustum )
 	return false;
 }
 
+/*
+===============================================================================
+
+	Pending interaction shadows
+
+	Building the turbo shadow volumes is the expensive part of creating an
+	interaction, and many interactions are created at once when a light or
+	a group of entities moves.  The shadow volumes of those are queued with
+	all of their memory allocated up front, built together in parallel jobs,
+	and only then handed to their interactions on the main thread.
+
+===============================================================================
+*/
+
+typedef struct pendingShadow_s {
+	idInteraction *			inter;
+	surfaceInteraction_t *	sint;
+	turboShadowVolume_t		shadowVolume;
+	struct pendingShadow_s *next;
+} pendingShadow_t;
+
+static pendingShadow_t *	firstPendingShadow;
+static pendingShadow_t *	lastPendingShadow;
+
+/*
+====================
+R_CheckShadowCaps
+====================
+*/
+static void R_CheckShadowCaps( const idRenderEntityLocal *entityDef, surfaceInteraction_t *sint ) {
+	if ( !sint->shadowTris ) {
+		return;
+	}
+	if ( sint->shader->Coverage() != MC_OPAQUE || ( !r_skipSuppress.GetBool() && entityDef->parms.suppressSurfaceInViewID ) ) {
+		// if any surface is a shadow-casting perforated or translucent surface, or the
+		// base surface is suppressed in the view (world weapon shadows) we can't use
+		// the external shadow optimizations because we can see through some of the faces
+		sint->shadowTris->numShadowIndexesNoCaps = sint->shadowTris->numIndexes;
+		sint->shadowTris->numShadowIndexesNoFrontCaps = sint->shadowTris->numIndexes;
+	}
+}
+
+/*
+====================
+R_QueuePendingShadow
+
+Returns false if the shadow volume has to be created right away
+====================
+*/
+static bool R_QueuePendingShadow( idInteraction *inter, surfaceInteraction_t *sint, const srfTriangles_t *tri, shadowGen_t shadowGen ) {
+	turboShadowVolume_t sv;
+
+	if ( !R_AllocTurboShadowVolume( sv, inter->entityDef, tri, inter->lightDef, shadowGen, sint->cullInfo ) ) {
+		return false;
+	}
+
+	pendingShadow_t *pending = (pendingShadow_t *)R_FrameAlloc( sizeof( *pending ) );
+	pending->inter = inter;
+	pending->sint = sint;
+	pending->shadowVolume = sv;
+	pending->next = NULL;
+
+	if ( lastPendingShadow ) {
+		lastPendingShadow->next = pending;
+	} else {
+		firstPendingShadow = pending;
+	}
+	lastPendingShadow = pending;
+
+	inter->shadowsPending = true;
+
+	return true;
+}
+
+/*
+====================
+R_PendingShadowJob
+====================
+*/
+static void R_PendingShadowJob( void *data ) {
+	pendingShadow_t *pending = (pendingShadow_t *)data;
+
+	R_BuildTurboShadowVolume( pending->shadowVolume );
+}
+
+/*
+====================
+R_CreatePendingInteractionShadows
+
+Builds all queued shadow volumes and publishes them to their interactions.
+Called before the new interactions are linked into the view, before
+any queued interaction is freed, and at the end of each frame.
+====================
+*/
+void R_CreatePendingInteractionShadows( void ) {
+	pendingShadow_t *pending;
+
+	if ( !firstPendingShadow ) {
+		return;
+	}
+
+	idParallelJobList jobList( "R_CreatePendingInteractionShadows" );
+	for ( pending = firstPendingShadow; pending; pending = pending->next ) {
+		jobList.AddJob( R_PendingShadowJob, pending );
+	}
+	jobList.Run();
+
+	for ( pending = firstPendingShadow; pending; pending = pending->next ) {
+		surfaceInteraction_t *sint = pending->sint;
+
+		sint->shadowTris = R_FinishTurboShadowVolume( pending->shadowVolume );
+		R_CheckShadowCaps( pending->inter->entityDef, sint );
+
+		// free the cull information when it's no longer needed
+		R_FreeInteractionCullInfo( sint->cullInfo );
+
+		pending->inter->shadowsPending = false;
+	}
+
+	firstPendingShadow = NULL;
+	lastPendingShadow = NULL;
+}
+
 /*
 ====================
 idInteraction::CreateInteraction
@@ -610,9 +748,12 @@ References tr.viewCount so lighting surfaces will only be created if the ambient
 otherwise it will be marked as deferred.
 
 The results of this are cached and valid until the light or entity change.
+
+If deferShadows is set, the turbo shadow volumes are only allocated and queued, and
+R_CreatePendingInteractionShadows() must be called before the interaction is used.
 ====================
 */
-void idInteraction::CreateInteraction( const idRenderModel *model ) {
+void idInteraction::CreateInteraction( const idRenderModel *model, bool deferShadows ) {
 	const idMaterial *	lightShader = lightDef->lightShader;
 	const idMaterial*	shader;
 	bool				interactionGenerated;
@@ -699,19 +840,16 @@ void idInteraction::CreateInteraction( const idRenderModel *model ) {
 
 			// if the light has an optimized shadow volume, don't create shadows for any models that are part of the base areas
 			if ( lightDef->parms.prelightModel == NULL || !model->IsStaticWorldModel() || !r_useOptimizedShadows.GetBool() ) {
+				interactionGenerated = true;
+
+				// the cull info is freed once the queued shadow volume is done
+				if ( deferShadows && R_QueuePendingShadow( this, sint, tri, shadowGen ) ) {
+					continue;
+				}
 
 				// this is the only place during gameplay (outside the utilities) that R_CreateShadowVolume() is called
 				sint->shadowTris = R_CreateShadowVolume( entityDef, tri, lightDef, shadowGen, sint->cullInfo );
-				if ( sint->shadowTris ) {
-					if ( shader->Coverage() != MC_OPAQUE || ( !r_skipSuppress.GetBool() && entityDef->parms.suppressSurfaceInViewID ) ) {
-						// if any surface is a shadow-casting perforated or translucent surface, or the
-						// base surface is suppressed in the view (world weapon shadows) we can't use
-						// the external shadow optimizations because we can see through some of the faces
-						sint->shadowTris->numShadowIndexesNoCaps = sint->shadowTris->numIndexes;
-						sint->shadowTris->numShadowIndexesNoFrontCaps = sint->shadowTris->numIndexes;
-					}
-				}
-				interactionGenerated = true;
+				R_CheckShadowCaps( entityDef, sint );
 			}
 		}
 
@@ -810,12 +948,23 @@ instantiate the dynamic model to find out
 ==================
 */
 void idInteraction::AddActiveInteraction( void ) {
+	idScreenRect	shadowScissor;
+
+	if ( PrepareActiveInteraction( shadowScissor, false ) ) {
+		LinkActiveInteraction( shadowScissor );
+	}
+}
+
+/*
+==================
+idInteraction::PrepareActiveInteraction
+
+Culls the interaction and creates it if needed
+==================
+*/
+bool idInteraction::PrepareActiveInteraction( idScreenRect &shadowScissor, bool deferShadows ) {
 	viewLight_t *	vLight;
 	viewEntity_t *	vEntity;
-	idScreenRect	shadowScissor;
-	idScreenRect	lightScissor;
-	idVec3			localLightOrigin;
-	idVec3			localViewOrigin;
 
 	vLight = lightDef->viewLight;
 	vEntity = entityDef->viewEntity;
@@ -838,7 +987,7 @@ void idInteraction::AddActiveInteraction( void ) {
 		// this will also cull the case where the light origin is inside the
 		// view frustum and the entity bounds are outside the view frustum
 		if ( CullInteractionByViewFrustum( tr.viewDef->viewFrustum ) ) {
-			return;
+			return false;
 		}
 
 		// calculate the shadow scissor rectangle
@@ -847,7 +996,7 @@ void idInteraction::AddActiveInteraction( void ) {
 
 	// get out before making the dynamic model if the shadow scissor rectangle is empty
 	if ( shadowScissor.IsEmpty() ) {
-		return;
+		return false;
 	}
 
 	// We will need the dynamic surface created to make interactions, even if the
@@ -855,7 +1004,7 @@ void idInteraction::AddActiveInteraction( void ) {
 	// has been generated once in the view.
 	idRenderModel *model = R_EntityDefDynamicModel( entityDef );
 	if ( model == NULL || model->NumSurfaces() <= 0 ) {
-		return;
+		return false;
 	}
 
 	// the dynamic model may have changed since we built the surface list
@@ -866,9 +1015,31 @@ void idInteraction::AddActiveInteraction( void ) {
 
 	// actually create the interaction if needed, building light and shadow surfaces as needed
 	if ( IsDeferred() ) {
-		CreateInteraction( model );
+		CreateInteraction( model, deferShadows );
 	}
 
+	return true;
+}
+
+/*
+==================
+idInteraction::LinkActiveInteraction
+
+Adds the light and shadow triangles of a prepared interaction
+==================
+*/
+void idInteraction::LinkActiveInteraction( const idScreenRect &shadowScissor ) {
+	viewLight_t *	vLight;
+	viewEntity_t *	vEntity;
+	idScreenRect	lightScissor;
+	idVec3			localLightOrigin;
+	idVec3			localViewOrigin;
+
+	assert( !shadowsPending );
+
+	vLight = lightDef->viewLight;
+	vEntity = entityDef->viewEntity;
+
 	R_GlobalPointToLocal( vEntity->modelMatrix, lightDef->globalLightOrigin, localLightOrigin );
 	R_GlobalPointToLocal( vEntity->modelMatrix, tr.viewDef->renderView.vieworg, localViewOrigin );
 
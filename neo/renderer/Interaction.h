@@ -106,6 +106,9 @@ public:
 	idInteraction *			entityNext;				// for entityDef chains
 	idInteraction *			entityPrev;
 
+	// shadow volumes are still queued for R_CreatePendingInteractionShadows()
+	bool					shadowsPending;
+
 public:
 							idInteraction( void );
 
@@ -142,6 +145,12 @@ public:
 	// calls R_LinkLightSurf() for each one
 	void					AddActiveInteraction( void );
 
+	// AddActiveInteraction() in two steps, so the shadow volumes of new interactions
+	// can be built together in parallel jobs by R_CreatePendingInteractionShadows().
+	// Returns false if nothing has to be linked for the interaction.
+	bool					PrepareActiveInteraction( idScreenRect &shadowScissor, bool deferShadows );
+	void					LinkActiveInteraction( const idScreenRect &shadowScissor );
+
 private:
 	enum {
 		FRUSTUM_UNINITIALIZED,
@@ -155,8 +164,8 @@ private:
 	int						dynamicModelFrameCount;	// so we can tell if a callback model animated
 
 private:
-	// actually create the interaction
-	void					CreateInteraction( const idRenderModel *model );
+	// actually create the interaction, optionally queueing the turbo shadow volumes
+	void					CreateInteraction( const idRenderModel *model, bool deferShadows );
 
 	// unlink from entity and light lists
 	void					Unlink( void );
@@ -171,10 +180,13 @@ private:
 };
 
 
-void R_CalcInteractionFacing( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo );
-void R_CalcInteractionCullBits( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo );
+void R_CalcInteractionFacing( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo, byte *facing = NULL );
+void R_CalcInteractionCullBits( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo, byte *cullBits = NULL );
 void R_FreeInteractionCullInfo( srfCullInfo_t &cullInfo );
 
+// builds all queued interaction shadow volumes in parallel jobs
+void R_CreatePendingInteractionShadows( void );
+
 void R_ShowInteractionMemory_f( const idCmdArgs &args );
 
 #endif /* !__INTERACTION_H__ */
@@ -42,6 +42,10 @@ idCVar idRenderModelStatic::r_mergeModelSurfaces( "r_mergeModelSurfaces", "1", C
 idCVar idRenderModelStatic::r_slopVertex( "r_slopVertex", "0.01", CVAR_RENDERER, "merge xyz coordinates this far apart" );
 idCVar idRenderModelStatic::r_slopTexCoord( "r_slopTexCoord", "0.001", CVAR_RENDERER, "merge texture coordinates this far apart" );
 idCVar idRenderModelStatic::r_slopNormal( "r_slopNormal", "0.02", CVAR_RENDERER, "merge normals that dot less than this" );
+idCVar idRenderModelStatic::r_useModelCache( "r_useModelCache", "1", CVAR_BOOL|CVAR_RENDERER, "read and write the finished surfaces of static models in " MODEL_CACHE_DIR );
+
+static const int MODEL_CACHE_MAGIC		= ( 'M' << 24 ) | ( 'D' << 16 ) | ( 'L' << 8 ) | 'C';
+static const int MODEL_CACHE_VERSION	= 1;
 
 /*
 ================
@@ -262,6 +266,23 @@ void idRenderModelStatic::MakeDefaultModel() {
 	FinishSurfaces();
 }
 
+/*
+================
+R_AddSurfaceArea
+
+Adds the area of a surface to its material for development information.
+================
+*/
+static void R_AddSurfaceArea( const modelSurface_t *surf ) {
+	const srfTriangles_t *tri = surf->geometry;
+
+	for ( int j = 0 ; j < tri->numIndexes ; j += 3 ) {
+		float	area = idWinding::TriangleArea( tri->verts[tri->indexes[j]].xyz,
+			 tri->verts[tri->indexes[j+1]].xyz,  tri->verts[tri->indexes[j+2]].xyz );
+		const_cast<idMaterial *>(surf->shader)->AddToSurfaceArea( area );
+	}
+}
+
 /*
 ================
 idRenderModelStatic::PartialInitFromFile
@@ -287,6 +308,12 @@ void idRenderModelStatic::InitFromFile( const char *fileName ) {
 
 	name.ExtractFileExtension( extension );
 
+	// the surfaces finished by an earlier load skip the parsing and cleanup
+	if ( ReadModelCache() ) {
+		reloadable	= true;
+		return;
+	}
+
 	if ( extension.Icmp( "ase" ) == 0 ) {
 		loaded		= LoadASE( name );
 		reloadable	= true;
@@ -320,6 +347,200 @@ void idRenderModelStatic::InitFromFile( const char *fileName ) {
 
 	// create the bounds for culling and dynamic surface creation
 	FinishSurfaces();
+
+	WriteModelCache();
+}
+
+/*
+================
+R_ModelCacheMaterialBits
+
+The material settings that change the finished surfaces, a cached model
+is only used while they are the same.
+================
+*/
+static int R_ModelCacheMaterialBits( const idMaterial *shader ) {
+	int bits = 0;
+
+	if ( shader->ShouldCreateBackSides() ) {
+		bits |= 1;
+	}
+	if ( shader->UseUnsmoothedTangents() ) {
+		bits |= 2;
+	}
+	if ( shader->UseMikkTSpace() ) {
+		bits |= 4;
+	}
+	if ( shader->Deform() != DFRM_NONE ) {
+		bits |= 8;
+	}
+	return bits;
+}
+
+/*
+================
+idRenderModelStatic::ModelCacheName
+================
+*/
+void idRenderModelStatic::ModelCacheName( idStr &cacheName ) const {
+	cacheName = MODEL_CACHE_DIR;
+	cacheName += name;
+	cacheName += MODEL_CACHE_EXT;
+}
+
+/*
+================
+idRenderModelStatic::ReadModelCache
+
+Restores the surfaces written by WriteModelCache if the source file and the
+settings used to finish them haven't changed.
+================
+*/
+bool idRenderModelStatic::ReadModelCache() {
+	ID_TIME_T	sourceTime;
+	idStr		cacheName;
+	idStr		shaderName;
+	int			magic, version, vertSize, indexSize, silEdgeSize, dominantTriSize;
+	int			cacheSourceTime, numSurfaces;
+	bool		mergeSurfaces;
+	float		slop[3];
+	int			i;
+
+	if ( fastLoad || !r_useModelCache.GetBool() ) {
+		return false;
+	}
+
+	fileSystem->ReadFile( name, NULL, &sourceTime );
+	if ( sourceTime == FILE_NOT_FOUND_TIMESTAMP ) {
+		return false;
+	}
+
+	ModelCacheName( cacheName );
+	const void *buffer;
+	int length = fileSystem->MapFile( cacheName, &buffer );
+	if ( length < 0 ) {
+		return false;
+	}
+
+	// read the surfaces straight from the mapped file
+	idFile_Memory file( cacheName, (const char *)buffer, length );
+	idFile *f = &file;
+
+	f->ReadInt( magic );
+	f->ReadInt( version );
+	f->ReadInt( vertSize );
+	f->ReadInt( indexSize );
+	f->ReadInt( silEdgeSize );
+	f->ReadInt( dominantTriSize );
+	f->ReadInt( cacheSourceTime );
+	f->ReadBool( mergeSurfaces );
+	f->ReadFloat( slop[0] );
+	f->ReadFloat( slop[1] );
+	f->ReadFloat( slop[2] );
+
+	if ( magic != MODEL_CACHE_MAGIC || version != MODEL_CACHE_VERSION ||
+			vertSize != sizeof( idDrawVert ) || indexSize != sizeof( glIndex_t ) ||
+			silEdgeSize != sizeof( silEdge_t ) || dominantTriSize != sizeof( dominantTri_t ) ||
+			cacheSourceTime != (int)sourceTime || mergeSurfaces != r_mergeModelSurfaces.GetBool() ||
+			slop[0] != r_slopVertex.GetFloat() || slop[1] != r_slopTexCoord.GetFloat() || slop[2] != r_slopNormal.GetFloat() ) {
+		fileSystem->UnmapFile( buffer );
+		return false;
+	}
+
+	f->ReadInt( numSurfaces );
+	f->ReadVec3( bounds[0] );
+	f->ReadVec3( bounds[1] );
+
+	for ( i = 0 ; i < numSurfaces ; i++ ) {
+		modelSurface_t	surf;
+		int				materialBits;
+
+		f->ReadInt( surf.id );
+		f->ReadString( shaderName );
+		f->ReadInt( materialBits );
+
+		surf.shader = declManager->FindMaterial( shaderName );
+		if ( R_ModelCacheMaterialBits( surf.shader ) != materialBits ) {
+			break;
+		}
+
+		surf.geometry = R_ReadStaticTriSurf( f );
+		if ( !surf.geometry ) {
+			break;
+		}
+		AddSurface( surf );
+	}
+
+	fileSystem->UnmapFile( buffer );
+
+	if ( i < numSurfaces || numSurfaces <= 0 ) {
+		common->DPrintf( "%s is out of date\n", cacheName.c_str() );
+		PurgeModel();
+		bounds.Zero();
+		return false;
+	}
+
+	for ( i = 0 ; i < surfaces.Num() ; i++ ) {
+		R_AddSurfaceArea( &surfaces[i] );
+	}
+
+	timeStamp = sourceTime;
+	purged = false;
+
+	return true;
+}
+
+/*
+================
+idRenderModelStatic::WriteModelCache
+================
+*/
+void idRenderModelStatic::WriteModelCache() const {
+	ID_TIME_T	sourceTime;
+	idStr		cacheName;
+
+	if ( fastLoad || defaulted || !r_useModelCache.GetBool() || surfaces.Num() == 0 ) {
+		return;
+	}
+
+	fileSystem->ReadFile( name, NULL, &sourceTime );
+	if ( sourceTime == FILE_NOT_FOUND_TIMESTAMP ) {
+		return;
+	}
+
+	ModelCacheName( cacheName );
+	idFile *f = fileSystem->OpenFileWrite( cacheName );
+	if ( !f ) {
+		common->Warning( "Couldn't write %s", cacheName.c_str() );
+		return;
+	}
+
+	f->WriteInt( MODEL_CACHE_MAGIC );
+	f->WriteInt( MODEL_CACHE_VERSION );
+	f->WriteInt( sizeof( idDrawVert ) );
+	f->WriteInt( sizeof( glIndex_t ) );
+	f->WriteInt( sizeof( silEdge_t ) );
+	f->WriteInt( sizeof( dominantTri_t ) );
+	f->WriteInt( (int)sourceTime );
+	f->WriteBool( r_mergeModelSurfaces.GetBool() );
+	f->WriteFloat( r_slopVertex.GetFloat() );
+	f->WriteFloat( r_slopTexCoord.GetFloat() );
+	f->WriteFloat( r_slopNormal.GetFloat() );
+
+	f->WriteInt( surfaces.Num() );
+	f->WriteVec3( bounds[0] );
+	f->WriteVec3( bounds[1] );
+
+	for ( int i = 0 ; i < surfaces.Num() ; i++ ) {
+		const modelSurface_t *surf = &surfaces[i];
+
+		f->WriteInt( surf->id );
+		f->WriteString( surf->shader->GetName() );
+		f->WriteInt( R_ModelCacheMaterialBits( surf->shader ) );
+		R_WriteStaticTriSurf( f, surf->geometry );
+	}
+
+	fileSystem->CloseFile( f );
 }
 
 /*
@@ -669,14 +890,7 @@ void idRenderModelStatic::FinishSurfaces() {
 
 	// add up the total surface area for development information
 	for ( i = 0 ; i < surfaces.Num() ; i++ ) {
-		const modelSurface_t	*surf = &surfaces[i];
-		srfTriangles_t	*tri = surf->geometry;
-
-		for ( int j = 0 ; j < tri->numIndexes ; j += 3 ) {
-			float	area = idWinding::TriangleArea( tri->verts[tri->indexes[j]].xyz,
-				 tri->verts[tri->indexes[j+1]].xyz,  tri->verts[tri->indexes[j+2]].xyz );
-			const_cast<idMaterial *>(surf->shader)->AddToSurfaceArea( area );
-		}
+		R_AddSurfaceArea( &surfaces[i] );
 	}
 
 	// calculate the bounds
@@ -239,6 +239,7 @@ typedef struct srfTriangles_s {
 	idPlane *					facePlanes;				// [numIndexes/3] plane equations
 
 	dominantTri_t *				dominantTris;			// [numVerts] for deformed surface fast tangent calculation
+	int							skinCacheId;			// md5 skin cache pose the deformed vertexes belong to, 0 if none
 
 	int							numShadowIndexesNoFrontCaps;	// shadow volumes with front caps omitted
 	int							numShadowIndexesNoCaps;			// shadow volumes with the front and rear caps omitted
@@ -29,6 +29,10 @@ If you have questions concerning this license or the applicable additional terms
 #ifndef __MODEL_LOCAL_H__
 #define __MODEL_LOCAL_H__
 
+// finished static model surfaces are cached as MODEL_CACHE_DIR + model name + MODEL_CACHE_EXT
+#define MODEL_CACHE_DIR			"modelcache/"
+#define MODEL_CACHE_EXT			".bmodel"
+
 /*
 ===============================================================================
 
@@ -104,6 +108,10 @@ public:
 
 	struct aseModel_s *			ConvertLWOToASE( const struct st_lwObject *obj, const char *fileName );
 
+	bool						ReadModelCache();
+	void						WriteModelCache() const;
+	void						ModelCacheName( idStr &cacheName ) const;
+
 	bool						DeleteSurfaceWithId( int id );
 	void						DeleteSurfacesWithNegativeId( void );
 	bool						FindSurfaceWithId( int id, int &surfaceNum );
@@ -131,6 +139,7 @@ protected:
 	static idCVar				r_slopVertex;			// merge xyz coordinates this far apart
 	static idCVar				r_slopTexCoord;			// merge texture coordinates this far apart
 	static idCVar				r_slopNormal;			// merge normals that dot less than this
+	static idCVar				r_useModelCache;		// read and write the finished surfaces in MODEL_CACHE_DIR
 };
 
 /*
@@ -167,7 +176,9 @@ public:
 	void						ParseMesh(idLexer& parser, int numJoints, const idJointMat* joints);
 	#endif
 
-	void						UpdateSurface( const struct renderEntity_s *ent, const idJointMat *joints, modelSurface_t *surf );
+	bool						UpdateSurface( const struct renderEntity_s *ent, const idJointMat *joints, unsigned int poseHash, modelSurface_t *surf, bool skin, struct md5SkinCacheEntry_s **storeEntry );
+	void						SkinSurface( const struct renderEntity_s *ent, const idJointMat *joints, srfTriangles_t *tri, struct md5SkinCacheEntry_s *storeEntry );
+	void						FreeSkinCache( void );
 	idBounds					CalcBounds( const idJointMat *joints );
 	int							NearestJoint( int a, int b, int c ) const;
 	int							NumVerts( void ) const;
@@ -195,8 +206,13 @@ private:
 	float                       lodUpper;
 	#endif
 
+	idList<struct md5SkinCacheEntry_s *> skinCache;	// earlier poses with their transformed vertexes
+
 	void						TransformVerts( idDrawVert *verts, const idJointMat *joints );
 	void						TransformScaledVerts( idDrawVert *verts, const idJointMat *joints, float scale );
+	struct md5SkinCacheEntry_s *FindSkinCacheEntry( const struct renderEntity_s *ent, unsigned int poseHash ) const;
+	struct md5SkinCacheEntry_s *AllocSkinCacheEntry( const struct renderEntity_s *ent, unsigned int poseHash );
+	void						StoreSkinCacheTangents( const srfTriangles_t *tri );
 };
 
 class idRenderModelMD5 : public idRenderModelStatic {
@@ -229,6 +245,10 @@ private:
 	void						ParseJoint( idLexer &parser, idMD5Joint *joint, idJointQuat *defaultPose );
 };
 
+// skin the md5 models instantiated in between in parallel jobs
+void							R_BeginDeferredSkinning( void );
+void							R_EndDeferredSkinning( void );
+
 /*
 ===============================================================================
 
@@ -34,6 +34,78 @@ If you have questions concerning this license or the applicable additional terms
 
 static const char *MD5_SnapshotName = "_MD5_Snapshot_";
 
+/*
+	The skin cache keeps the transformed vertexes of recently seen joint poses for
+	every mesh, so entities that are in a pose that has been skinned before, like
+	monsters in looping idle animations, just copy the vertexes.  The tangents are
+	added to a pose once they have been derived for it, which is noticed the next
+	time the surface is updated.  Memory use is bounded by r_md5SkinCacheMegs and
+	the least recently used poses are dropped first.
+*/
+typedef struct md5SkinCacheEntry_s {
+	idMD5Mesh *				mesh;
+	int						id;				// for srfTriangles_t::skinCacheId
+	unsigned int			poseHash;
+	float					skinScale;
+	bool					valid;			// false until the vertexes have been written by a skinning job
+	bool					tangents;		// the vertexes have normals and tangents
+	int						numJoints;
+	idJointMat *			joints;
+	int						numVerts;
+	idDrawVert *			verts;
+	idBounds				bounds;
+	int						size;			// counted against r_md5SkinCacheMegs
+	idLinkList<md5SkinCacheEntry_s> lruNode;	// most recently used first
+} md5SkinCacheEntry_t;
+
+static idLinkList<md5SkinCacheEntry_t> md5SkinCacheLRU;
+static int					md5SkinCacheBytes = 0;
+static int					md5SkinCacheNextId = 1;
+
+typedef struct {
+	idMD5Mesh *				mesh;
+	const renderEntity_t *	ent;
+	srfTriangles_t *		tri;
+	idRenderModelStatic *	model;
+	md5SkinCacheEntry_t *	storeEntry;
+} md5SkinJob_t;
+
+// set between R_BeginDeferredSkinning and R_EndDeferredSkinning
+static bool					md5DeferSkinning = false;
+static idList<md5SkinJob_t>	md5SkinJobs;
+
+/*
+====================
+R_MD5PoseHash
+====================
+*/
+static unsigned int R_MD5PoseHash( const renderEntity_t *ent ) {
+	const unsigned int *data = (const unsigned int *)ent->joints;
+	const int num = ent->numJoints * sizeof( idJointMat ) / sizeof( data[0] );
+	float skinScale = ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ];
+	unsigned int hash = 2166136261u ^ *(unsigned int *)&skinScale;
+
+	for ( int i = 0; i < num; i++ ) {
+		hash = ( hash ^ data[i] ) * 16777619u;
+	}
+	return hash;
+}
+
+/*
+====================
+R_FreeSkinCacheEntry
+====================
+*/
+static void R_FreeSkinCacheEntry( md5SkinCacheEntry_t *entry ) {
+	assert( entry->valid );
+
+	md5SkinCacheBytes -= entry->size;
+	entry->lruNode.Remove();
+	Mem_Free16( entry->joints );
+	Mem_Free16( entry->verts );
+	delete entry;
+}
+
 /***********************************************************************
 
 	idMD5Mesh
@@ -84,6 +156,7 @@ idMD5Mesh::~idMD5Mesh
 ====================
 */
 idMD5Mesh::~idMD5Mesh() {
+	FreeSkinCache();
 	Mem_Free16( scaledWeights );
 	Mem_Free16( weightIndex );
 	if ( deformInfo ) {
@@ -573,12 +646,162 @@ void idMD5Mesh::TransformScaledVerts( idDrawVert *verts, const idJointMat *entJo
 
 /*
 ====================
-idMD5Mesh::UpdateSurface
+idMD5Mesh::SkinSurface
+
+Transforms the vertexes of a surface set up by UpdateSurface and bounds them,
+and copies them to storeEntry if not NULL.  Only writes the surface and the
+skin cache entry, so it can run in a job.
 ====================
 */
-void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMat *entJoints, modelSurface_t *surf ) {
+void idMD5Mesh::SkinSurface( const struct renderEntity_s *ent, const idJointMat *entJoints, srfTriangles_t *tri, md5SkinCacheEntry_t *storeEntry ) {
 	int i, base;
+
+	if ( ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] != 0.0f ) {
+		TransformScaledVerts( tri->verts, entJoints, ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] );
+	} else {
+		TransformVerts( tri->verts, entJoints );
+	}
+
+	// replicate the mirror seam vertexes
+	base = deformInfo->numOutputVerts - deformInfo->numMirroredVerts;
+	for ( i = 0; i < deformInfo->numMirroredVerts; i++ ) {
+		tri->verts[base + i] = tri->verts[deformInfo->mirroredVerts[i]];
+	}
+
+	R_BoundTriSurf( tri );
+
+	if ( storeEntry ) {
+		memcpy( storeEntry->verts, tri->verts, tri->numVerts * sizeof( tri->verts[0] ) );
+		storeEntry->bounds = tri->bounds;
+	}
+}
+
+/*
+====================
+idMD5Mesh::FindSkinCacheEntry
+
+Returns the skin cache entry for the joints of the entity, which may still be waiting for its vertexes.
+====================
+*/
+md5SkinCacheEntry_t *idMD5Mesh::FindSkinCacheEntry( const struct renderEntity_s *ent, unsigned int poseHash ) const {
+	for ( int i = 0; i < skinCache.Num(); i++ ) {
+		md5SkinCacheEntry_t *entry = skinCache[i];
+
+		if ( entry->poseHash != poseHash || entry->numJoints != ent->numJoints || entry->skinScale != ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] ) {
+			continue;
+		}
+		if ( memcmp( entry->joints, ent->joints, ent->numJoints * sizeof( entry->joints[0] ) ) != 0 ) {
+			continue;
+		}
+		return entry;
+	}
+	return NULL;
+}
+
+/*
+====================
+idMD5Mesh::AllocSkinCacheEntry
+
+Adds an entry for the joints of the entity to the skin cache, the vertexes have to be
+written by SkinSurface.  Returns NULL if the pose doesn't fit in r_md5SkinCacheMegs.
+====================
+*/
+md5SkinCacheEntry_t *idMD5Mesh::AllocSkinCacheEntry( const struct renderEntity_s *ent, unsigned int poseHash ) {
+	md5SkinCacheEntry_t *entry, *prev;
+	const int numVerts = deformInfo->numOutputVerts;
+	const int size = sizeof( md5SkinCacheEntry_t ) + ent->numJoints * sizeof( idJointMat ) + numVerts * sizeof( idDrawVert );
+	const int budget = r_md5SkinCacheMegs.GetInteger() * 1024 * 1024;
+
+	// drop the least recently used poses, the ones still waiting for a skinning job have to stay
+	for ( entry = md5SkinCacheLRU.Prev(); entry != NULL && md5SkinCacheBytes + size > budget; entry = prev ) {
+		prev = entry->lruNode.Prev();
+		if ( entry->valid ) {
+			entry->mesh->skinCache.Remove( entry );
+			R_FreeSkinCacheEntry( entry );
+		}
+	}
+
+	if ( md5SkinCacheBytes + size > budget ) {
+		return NULL;
+	}
+
+	entry = new md5SkinCacheEntry_t;
+	entry->mesh = this;
+	entry->id = md5SkinCacheNextId++;
+	entry->poseHash = poseHash;
+	entry->skinScale = ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ];
+	entry->valid = false;
+	entry->tangents = false;
+	entry->numJoints = ent->numJoints;
+	entry->joints = (idJointMat *)Mem_Alloc16( ent->numJoints * sizeof( entry->joints[0] ) );
+	memcpy( entry->joints, ent->joints, ent->numJoints * sizeof( entry->joints[0] ) );
+	entry->numVerts = numVerts;
+	entry->verts = (idDrawVert *)Mem_Alloc16( numVerts * sizeof( entry->verts[0] ) );
+	entry->bounds.Clear();
+	entry->size = size;
+	entry->lruNode.SetOwner( entry );
+	entry->lruNode.AddToFront( md5SkinCacheLRU );
+
+	skinCache.Append( entry );
+	md5SkinCacheBytes += size;
+
+	if ( md5SkinCacheNextId <= 0 ) {
+		md5SkinCacheNextId = 1;
+	}
+
+	return entry;
+}
+
+/*
+====================
+idMD5Mesh::StoreSkinCacheTangents
+
+Adds the tangents derived for a surface to the skin cache entry its vertexes belong to.
+====================
+*/
+void idMD5Mesh::StoreSkinCacheTangents( const srfTriangles_t *tri ) {
+	for ( int i = 0; i < skinCache.Num(); i++ ) {
+		md5SkinCacheEntry_t *entry = skinCache[i];
+
+		if ( entry->id != tri->skinCacheId ) {
+			continue;
+		}
+		if ( entry->valid && !entry->tangents && entry->numVerts == tri->numVerts ) {
+			memcpy( entry->verts, tri->verts, tri->numVerts * sizeof( tri->verts[0] ) );
+			entry->tangents = true;
+		}
+		return;
+	}
+}
+
+/*
+====================
+idMD5Mesh::FreeSkinCache
+====================
+*/
+void idMD5Mesh::FreeSkinCache( void ) {
+	for ( int i = 0; i < skinCache.Num(); i++ ) {
+		R_FreeSkinCacheEntry( skinCache[i] );
+	}
+	skinCache.Clear();
+}
+
+/*
+====================
+idMD5Mesh::UpdateSurface
+
+Sets up the surface for the current joints.  The vertexes are only
+transformed if skin is set, otherwise SkinSurface has to be called later
+with storeEntry.  Returns false if the vertexes have been copied from the
+skin cache instead, then they are already bounded and SkinSurface must not
+be called.
+====================
+*/
+bool idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMat *entJoints, unsigned int poseHash, modelSurface_t *surf, bool skin, md5SkinCacheEntry_t **storeEntry ) {
+	int i;
 	srfTriangles_t *tri;
+	md5SkinCacheEntry_t *entry;
+	bool needSkinning;
 
 	tr.pc.c_deformedSurfaces++;
 	tr.pc.c_deformedVerts += deformInfo->numOutputVerts;
@@ -587,6 +810,11 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 	surf->shader = shader;
 
 	if ( surf->geometry ) {
+		// keep the tangents derived for the last pose before the vertexes are replaced
+		if ( surf->geometry->skinCacheId && surf->geometry->tangentsCalculated ) {
+			StoreSkinCacheTangents( surf->geometry );
+		}
+
 		// if the number of verts and indexes are the same we can re-use the triangle surface
 		// the number of indexes must be the same to assure the correct amount of memory is allocated for the facePlanes
 		if ( surf->geometry->numVerts == deformInfo->numOutputVerts && surf->geometry->numIndexes == deformInfo->numIndexes ) {
@@ -626,27 +854,55 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 		}
 	}
 
-	if ( ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] != 0.0f ) {
-		TransformScaledVerts( tri->verts, entJoints, ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] );
-	} else {
-		TransformVerts( tri->verts, entJoints );
+	tri->skinCacheId = 0;
+	if ( storeEntry ) {
+		*storeEntry = NULL;
 	}
 
-	// replicate the mirror seam vertexes
-	base = deformInfo->numOutputVerts - deformInfo->numMirroredVerts;
-	for ( i = 0; i < deformInfo->numMirroredVerts; i++ ) {
-		tri->verts[base + i] = tri->verts[deformInfo->mirroredVerts[i]];
+	entry = NULL;
+	if ( r_useMD5SkinCache.GetBool() ) {
+		entry = FindSkinCacheEntry( ent, poseHash );
+	} else if ( skinCache.Num() && !md5DeferSkinning ) {
+		FreeSkinCache();
 	}
 
-	R_BoundTriSurf( tri );
+	if ( entry && entry->valid ) {
+		// this pose has been skinned before
+		memcpy( tri->verts, entry->verts, tri->numVerts * sizeof( tri->verts[0] ) );
+		tri->bounds = entry->bounds;
+		tri->tangentsCalculated = entry->tangents;
+		tri->skinCacheId = entry->id;
+		entry->lruNode.AddToFront( md5SkinCacheLRU );
+		needSkinning = false;
+	} else {
+		// a pose that is still waiting for a skinning job is just skinned again
+		if ( entry == NULL && r_useMD5SkinCache.GetBool() ) {
+			entry = AllocSkinCacheEntry( ent, poseHash );
+			if ( entry ) {
+				tri->skinCacheId = entry->id;
+			}
+		} else {
+			entry = NULL;
+		}
+		needSkinning = true;
+	}
+
+	if ( skin && needSkinning ) {
+		SkinSurface( ent, entJoints, tri, entry );
+		if ( entry ) {
+			entry->valid = true;
+		}
 
-	// If a surface is going to be have a lighting interaction generated, it will also have to call
-	// R_DeriveTangents() to get normals, tangents, and face planes.  If it only
-	// needs shadows generated, it will only have to generate face planes.  If it only
-	// has ambient drawing, or is culled, no additional work will be necessary
-	if ( !r_useDeferredTangents.GetBool() ) {
-		// set face planes, vertex normals, tangents
-		R_DeriveTangents( tri );
+		// If a surface is going to be have a lighting interaction generated, it will also have to call
+		// R_DeriveTangents() to get normals, tangents, and face planes.  If it only
+		// needs shadows generated, it will only have to generate face planes.  If it only
+		// has ambient drawing, or is culled, no additional work will be necessary
+		if ( !r_useDeferredTangents.GetBool() ) {
+			// set face planes, vertex normals, tangents
+			R_DeriveTangents( tri );
+		}
+	} else if ( storeEntry ) {
+		*storeEntry = entry;
 	}
 
 	#if MD5_ENABLE_GIBS > 0 // HINTS
@@ -656,6 +912,7 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 	}
 	#endif
 
+	return needSkinning;
 }
 
 /*
@@ -1156,6 +1413,9 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 
 	staticModel->bounds.Clear();
 
+	// identical poses share the transformed vertexes of the skin cache
+	unsigned int poseHash = r_useMD5SkinCache.GetBool() ? R_MD5PoseHash( ent ) : 0;
+
 	#if MD5_ENABLE_GIBS > 0
 	staticModel->gibParts = gibParts;
 //	staticModel->gibBlood = gibBlood;
@@ -1279,7 +1539,22 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 			surf->id = i;
 		}
 
-		mesh->UpdateSurface( ent, ent->joints, surf );
+		if ( md5DeferSkinning ) {
+			md5SkinCacheEntry_t *storeEntry;
+
+			// the vertexes are transformed and added to the bounds by R_EndDeferredSkinning
+			if ( mesh->UpdateSurface( ent, ent->joints, poseHash, surf, false, &storeEntry ) ) {
+				md5SkinJob_t &job = md5SkinJobs.Alloc();
+				job.mesh = mesh;
+				job.ent = ent;
+				job.tri = surf->geometry;
+				job.model = staticModel;
+				job.storeEntry = storeEntry;
+				continue;
+			}
+		} else {
+			mesh->UpdateSurface( ent, ent->joints, poseHash, surf, true, NULL );
+		}
 
 		staticModel->bounds.AddPoint( surf->geometry->bounds[0] );
 		staticModel->bounds.AddPoint( surf->geometry->bounds[1] );
@@ -1288,6 +1563,69 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 	return staticModel;
 }
 
+/*
+====================
+R_MD5SkinJob
+====================
+*/
+static void R_MD5SkinJob( void *data ) {
+	md5SkinJob_t *job = (md5SkinJob_t *)data;
+
+	job->mesh->SkinSurface( job->ent, job->ent->joints, job->tri, job->storeEntry );
+}
+
+/*
+====================
+R_BeginDeferredSkinning
+
+Until R_EndDeferredSkinning, instantiating an md5 model only sets up its
+surfaces and queues the vertex transforms, so all md5 models of a view
+can be skinned together in parallel jobs.  The vertexes and bounds of
+the instantiated models are not valid before R_EndDeferredSkinning.
+Requires r_useDeferredTangents, because deriving tangents allocates.
+====================
+*/
+void R_BeginDeferredSkinning( void ) {
+	assert( !md5DeferSkinning );
+	assert( r_useDeferredTangents.GetBool() );
+
+	md5SkinJobs.SetNum( 0, false );
+	md5DeferSkinning = true;
+}
+
+/*
+====================
+R_EndDeferredSkinning
+
+Skins all queued surfaces in parallel jobs and sets the bounds of their models.
+====================
+*/
+void R_EndDeferredSkinning( void ) {
+	assert( md5DeferSkinning );
+
+	md5DeferSkinning = false;
+
+	if ( md5SkinJobs.Num() == 0 ) {
+		return;
+	}
+
+	idParallelJobList jobList( "R_EndDeferredSkinning" );
+	for ( int i = 0 ; i < md5SkinJobs.Num() ; i++ ) {
+		jobList.AddJob( R_MD5SkinJob, &md5SkinJobs[i] );
+	}
+	jobList.Run();
+
+	for ( int i = 0 ; i < md5SkinJobs.Num() ; i++ ) {
+		const md5SkinJob_t &job = md5SkinJobs[i];
+		if ( job.storeEntry ) {
+			job.storeEntry->valid = true;
+		}
+		job.model->bounds.AddPoint( job.tri->bounds[0] );
+		job.model->bounds.AddPoint( job.tri->bounds[1] );
+	}
+	md5SkinJobs.SetNum( 0, false );
+}
+
 /*
 ====================
 idRenderModelMD5::IsDynamicModel
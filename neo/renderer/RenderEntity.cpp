@@ -38,6 +38,7 @@ idRenderEntityLocal::idRenderEntityLocal() {
 	world					= NULL;
 	index					= 0;
 	lastModifiedFrameNum	= 0;
+	lastMovedFrameNum		= 0;
 	archived				= false;
 	dynamicModel			= NULL;
 	dynamicModelFrameCount	= 0;
@@ -90,6 +91,7 @@ idRenderLightLocal::idRenderLightLocal() {
 	index					= 0;
 	areaNum					= 0;
 	lastModifiedFrameNum	= 0;
+	lastMovedFrameNum		= 0;
 	archived				= false;
 	lightShader				= NULL;
 	falloffImage			= NULL;
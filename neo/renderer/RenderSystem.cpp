@@ -133,6 +133,9 @@ static void R_IssueRenderCommands( void ) {
 		return;
 	}
 
+	// upload the frame temp vertexes the front end created since the last time
+	vertexCache.UploadFrameTemp();
+
 	// r_skipBackEnd allows the entire time of the back end
 	// to be removed from performance measurements, although
 	// nothing will be drawn to the screen.  If the prints
@@ -83,9 +83,13 @@ idCVar r_useShadowVertexProgram( "r_useShadowVertexProgram", "1", CVAR_RENDERER
 idCVar r_useShadowSurfaceScissor( "r_useShadowSurfaceScissor", "1", CVAR_RENDERER | CVAR_BOOL, "scissor shadows by the scissor rect of the interaction surfaces" );
 idCVar r_useInteractionTable( "r_useInteractionTable", "1", CVAR_RENDERER | CVAR_BOOL, "create a full entityDefs * lightDefs table to make finding interactions faster" );
 idCVar r_useTurboShadow( "r_useTurboShadow", "1", CVAR_RENDERER | CVAR_BOOL, "use the infinite projection with W technique for dynamic shadows" );
+idCVar r_useTurboShadowCache( "r_useTurboShadowCache", "1", CVAR_RENDERER | CVAR_BOOL, "reuse the turbo shadow volumes of static models when interactions are re-created" );
+idCVar r_turboShadowCacheMegs( "r_turboShadowCacheMegs", "16", CVAR_RENDERER | CVAR_INTEGER, "size limit of the turbo shadow cache in megabytes" );
 idCVar r_useTwoSidedStencil( "r_useTwoSidedStencil", "1", CVAR_RENDERER | CVAR_BOOL, "do stencil shadows in one pass with different ops on each side" );
 idCVar r_useDeferredTangents( "r_useDeferredTangents", "1", CVAR_RENDERER | CVAR_BOOL, "defer tangents calculations after deform" );
 idCVar r_useCachedDynamicModels( "r_useCachedDynamicModels", "1", CVAR_RENDERER | CVAR_BOOL, "cache snapshots of dynamic models" );
+idCVar r_useMD5SkinCache( "r_useMD5SkinCache", "1", CVAR_RENDERER | CVAR_BOOL, "reuse the transformed vertexes and tangents of md5 meshes for identical joint poses" );
+idCVar r_md5SkinCacheMegs( "r_md5SkinCacheMegs", "8", CVAR_RENDERER | CVAR_INTEGER, "memory budget of the md5 skin cache in megabytes", 0, 256 );
 
 idCVar r_useVertexBuffers( "r_useVertexBuffers", "1", CVAR_RENDERER | CVAR_INTEGER, "use ARB_vertex_buffer_object for vertexes", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1>  );
 idCVar r_useIndexBuffers( "r_useIndexBuffers", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "use ARB_vertex_buffer_object for indexes", 0, 1, idCmdSystem::ArgCompletion_Integer<0,1>  );
@@ -136,10 +140,12 @@ idCVar r_useLightCulling( "r_useLightCulling", "3", CVAR_RENDERER | CVAR_INTEGER
 idCVar r_useLightScissors( "r_useLightScissors", "1", CVAR_RENDERER | CVAR_BOOL, "1 = use custom scissor rectangle for each light" );
 idCVar r_useClippedLightScissors( "r_useClippedLightScissors", "1", CVAR_RENDERER | CVAR_INTEGER, "0 = full screen when near clipped, 1 = exact when near clipped, 2 = exact always", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
 idCVar r_useEntityCulling( "r_useEntityCulling", "1", CVAR_RENDERER | CVAR_BOOL, "0 = none, 1 = box" );
+idCVar r_useAreaRefTree( "r_useAreaRefTree", "1", CVAR_RENDERER | CVAR_BOOL, "cull the entities and lights of large areas with a bounds tree instead of walking the area lists" );
 idCVar r_useEntityScissors( "r_useEntityScissors", "0", CVAR_RENDERER | CVAR_BOOL, "1 = use custom scissor rectangle for each entity" );
 idCVar r_useInteractionCulling( "r_useInteractionCulling", "1", CVAR_RENDERER | CVAR_BOOL, "1 = cull interactions" );
 idCVar r_useInteractionScissors( "r_useInteractionScissors", "2", CVAR_RENDERER | CVAR_INTEGER, "1 = use a custom scissor rectangle for each shadow interaction, 2 = also crop using portal scissors", -2, 2, idCmdSystem::ArgCompletion_Integer<-2,2> );
 idCVar r_useShadowCulling( "r_useShadowCulling", "1", CVAR_RENDERER | CVAR_BOOL, "try to cull shadows from partially visible lights" );
+idCVar r_useParallelFrontEnd( "r_useParallelFrontEnd", "1", CVAR_RENDERER | CVAR_BOOL, "1 = flood portals, skin md5 models, calculate scissor rectangles and cull static surfaces in parallel jobs" );
 idCVar r_useFrustumFarDistance( "r_useFrustumFarDistance", "0", CVAR_RENDERER | CVAR_FLOAT, "if != 0 force the view frustum far distance to this distance" );
 idCVar r_clear( "r_clear", "2", CVAR_RENDERER, "force screen clear every frame, 1 = purple, 2 = black, 'r g b' = custom" );
 idCVar r_offsetFactor( "r_offsetfactor", "0", CVAR_RENDERER | CVAR_FLOAT, "polygon offset parameter" );
@@ -1225,6 +1231,141 @@ void R_Benchmark_f( const idCmdArgs &args ) {
 	r_skipRenderContext.SetBool( false );
 }
 
+/*
+================
+R_LoadBenchmarkPath
+
+Reads a camera path for benchmarkFrontEnd, one view per line:
+origin x y z, then angles pitch yaw roll.
+================
+*/
+static bool R_LoadBenchmarkPath( const char *fileName, idList<idVec3> &origins, idList<idAngles> &angles ) {
+	idLexer		src( LEXFL_NOSTRINGCONCAT | LEXFL_NOSTRINGESCAPECHARS | LEXFL_ALLOWPATHNAMES );
+	idToken		token;
+	idVec3		org;
+	idAngles	ang;
+
+	if ( !src.LoadFile( fileName ) ) {
+		return false;
+	}
+	while ( src.PeekTokenType( TT_NUMBER, 0, &token ) || src.PeekTokenType( TT_PUNCTUATION, P_SUB, &token ) ) {
+		org.x = src.ParseFloat();
+		org.y = src.ParseFloat();
+		org.z = src.ParseFloat();
+		ang.pitch = src.ParseFloat();
+		ang.yaw = src.ParseFloat();
+		ang.roll = src.ParseFloat();
+		origins.Append( org );
+		angles.Append( ang );
+	}
+	return true;
+}
+
+/*
+================
+R_BenchmarkFrontEnd_f
+
+Renders a fixed sequence of views with the back end disabled and reports
+the front end cost, so culling, interaction and drawSurf changes can be
+measured without the driver and GPU in the numbers.  It still goes through
+BeginFrame and EndFrame, so it needs a live GL context and a loaded map.
+
+benchmarkFrontEnd [numFrames] [cameraPathFile]
+
+Without a camera path the current view is spun a full turn around its origin.
+================
+*/
+void R_BenchmarkFrontEnd_f( const idCmdArgs &args ) {
+	idList<idVec3>		pathOrigins;
+	idList<idAngles>	pathAngles;
+	renderView_t		view;
+	int					numFrames;
+
+	if ( !tr.primaryView ) {
+		common->Printf( "No primaryView for benchmarking\n" );
+		return;
+	}
+
+	numFrames = 0;
+	if ( args.Argc() > 1 ) {
+		numFrames = atoi( args.Argv( 1 ) );
+	}
+	if ( args.Argc() > 2 ) {
+		if ( !R_LoadBenchmarkPath( args.Argv( 2 ), pathOrigins, pathAngles ) ) {
+			common->Printf( "Couldn't load camera path '%s'\n", args.Argv( 2 ) );
+			return;
+		}
+		if ( pathOrigins.Num() == 0 ) {
+			common->Printf( "Camera path '%s' has no views\n", args.Argv( 2 ) );
+			return;
+		}
+		if ( numFrames <= 0 ) {
+			numFrames = pathOrigins.Num();
+		}
+	}
+	if ( numFrames <= 0 ) {
+		numFrames = 360;
+	}
+
+	const bool skipBackEnd = r_skipBackEnd.GetBool();
+	r_skipBackEnd.SetBool( true );
+
+	// the per frame counters are cleared in EndFrame, so sum them here
+	int64_t		totalUsec = 0;
+	int64_t		minUsec = 0;
+	int64_t		maxUsec = 0;
+	int64_t		totalDrawSurfs = 0;
+	int64_t		totalViewEntities = 0;
+	int64_t		totalViewLights = 0;
+	int64_t		totalCreateInteractions = 0;
+	int64_t		totalCreateShadowVolumes = 0;
+	int64_t		totalViews = 0;
+
+	view = tr.primaryRenderView;
+	const idAngles startAngles = view.viewaxis.ToAngles();
+
+	for ( int i = 0 ; i < numFrames ; i++ ) {
+		if ( pathOrigins.Num() ) {
+			const int j = i % pathOrigins.Num();
+			view.vieworg = pathOrigins[j];
+			view.viewaxis = pathAngles[j].ToMat3();
+		} else {
+			idAngles ang = startAngles;
+			ang.yaw += 360.0f * i / numFrames;
+			view.viewaxis = ang.Normalize360().ToMat3();
+		}
+
+		renderSystem->BeginFrame( glConfig.vidWidth, glConfig.vidHeight );
+
+		// a front end frame is often only a few msec, so time it in usec
+		const int64_t start = frameProfiler->Microseconds();
+		tr.primaryWorld->RenderScene( &view );
+		const int64_t usec = frameProfiler->Microseconds() - start;
+
+		totalUsec += usec;
+		minUsec = ( i == 0 ) ? usec : Min( minUsec, usec );
+		maxUsec = Max( maxUsec, usec );
+		totalDrawSurfs += tr.pc.c_drawSurfs;
+		totalViewEntities += tr.pc.c_visibleViewEntities;
+		totalViewLights += tr.pc.c_viewLights;
+		totalCreateInteractions += tr.pc.c_createInteractions;
+		totalCreateShadowVolumes += tr.pc.c_createShadowVolumes;
+		totalViews += tr.pc.c_numViews;
+
+		renderSystem->EndFrame( NULL, NULL );
+	}
+
+	r_skipBackEnd.SetBool( skipBackEnd );
+
+	common->Printf( "%i frames, %s\n", numFrames, pathOrigins.Num() ? args.Argv( 2 ) : "spin" );
+	common->Printf( "front end msec: %.3f avg, %.3f min, %.3f max\n", totalUsec * 0.001 / numFrames, minUsec * 0.001, maxUsec * 0.001 );
+	common->Printf( "per frame: %.1f views, %.1f drawSurfs, %.1f viewEntities, %.1f viewLights\n",
+		(double)totalViews / numFrames, (double)totalDrawSurfs / numFrames,
+		(double)totalViewEntities / numFrames, (double)totalViewLights / numFrames );
+	common->Printf( "created: %lld interactions, %lld shadow volumes\n",
+		(long long)totalCreateInteractions, (long long)totalCreateShadowVolumes );
+}
+
 
 /*
 ==============================================================================
@@ -2198,6 +2339,7 @@ void R_InitCommands( void ) {
 	cmdSystem->AddCommand( "envshot", R_EnvShot_f, CMD_FL_RENDERER, "takes an environment shot" );
 	cmdSystem->AddCommand( "makeAmbientMap", R_MakeAmbientMap_f, CMD_FL_RENDERER|CMD_FL_CHEAT, "makes an ambient map" );
 	cmdSystem->AddCommand( "benchmark", R_Benchmark_f, CMD_FL_RENDERER, "benchmark" );
+	cmdSystem->AddCommand( "benchmarkFrontEnd", R_BenchmarkFrontEnd_f, CMD_FL_RENDERER, "times the renderer front end over a spin or camera path with the back end disabled, needs a GL context and a loaded map" );
 	cmdSystem->AddCommand( "gfxInfo", GfxInfo_f, CMD_FL_RENDERER, "show graphics info" );
 	cmdSystem->AddCommand( "modulateLights", R_ModulateLights_f, CMD_FL_RENDERER | CMD_FL_CHEAT, "modifies shader parms on all lights" );
 	cmdSystem->AddCommand( "testImage", R_TestImage_f, CMD_FL_RENDERER | CMD_FL_CHEAT, "displays the given image centered on screen", idCmdSystem::ArgCompletion_ImageName );
@@ -2207,6 +2349,8 @@ void R_InitCommands( void ) {
 	cmdSystem->AddCommand( "regenerateWorld", R_RegenerateWorld_f, CMD_FL_RENDERER, "regenerates all interactions" );
 	cmdSystem->AddCommand( "showInteractionMemory", R_ShowInteractionMemory_f, CMD_FL_RENDERER, "shows memory used by interactions" );
 	cmdSystem->AddCommand( "showTriSurfMemory", R_ShowTriSurfMemory_f, CMD_FL_RENDERER, "shows memory used by triangle surfaces" );
+	cmdSystem->AddCommand( "benchmarkTangents", R_BenchmarkTangents_f, CMD_FL_RENDERER, "times the tangent space derivation of a model with the SIMD and generic code" );
+	cmdSystem->AddCommand( "benchmarkImageProcessing", R_BenchmarkImageProcessing_f, CMD_FL_RENDERER, "times the image load kernels with the SIMD and generic code" );
 	cmdSystem->AddCommand( "vid_restart", R_VidRestart_f, CMD_FL_RENDERER, "restarts renderSystem" );
 	cmdSystem->AddCommand( "listRenderEntityDefs", R_ListRenderEntityDefs_f, CMD_FL_RENDERER, "lists the entity defs" );
 	cmdSystem->AddCommand( "listRenderLightDefs", R_ListRenderLightDefs_f, CMD_FL_RENDERER, "lists the light defs" );
@@ -139,6 +139,10 @@ idRenderWorldLocal::idRenderWorldLocal() {
 	doublePortals = NULL;
 	numInterAreaPortals = 0;
 
+	maxPortalFlowAreas = 256;
+
+	portalStateCount = 0;
+
 	interactionTable = 0;
 	interactionTableWidth = 0;
 	interactionTableHeight = 0;
@@ -253,6 +257,10 @@ void idRenderWorldLocal::UpdateEntityDef( qhandle_t entityHandle, const renderEn
 			}
 		}
 
+		if ( re->origin != def->parms.origin || re->axis != def->parms.axis ) {
+			def->lastMovedFrameNum = tr.frameCount;
+		}
+
 		// save any decals if the model is the same, allowing marks to move with entities
 		if ( def->parms.hModel == re->hModel ) {
 			R_FreeEntityDefDerivedData( def, true, true );
@@ -266,6 +274,9 @@ void idRenderWorldLocal::UpdateEntityDef( qhandle_t entityHandle, const renderEn
 
 		def->world = this;
 		def->index = entityHandle;
+
+		// a def freed and added again every frame counts as moving
+		def->lastMovedFrameNum = tr.frameCount;
 	}
 
 	def->parms = *re;
@@ -411,6 +422,9 @@ void idRenderWorldLocal::UpdateLightDef( qhandle_t lightHandle, const renderLigh
 		} else {
 			// if we are updating shadows, the prelight model is no longer valid
 			light->lightHasMoved = true;
+			if ( rlight->origin != light->parms.origin || rlight->axis != light->parms.axis ) {
+				light->lastMovedFrameNum = tr.frameCount;
+			}
 			R_FreeLightDefDerivedData( light );
 		}
 	} else {
@@ -420,6 +434,9 @@ void idRenderWorldLocal::UpdateLightDef( qhandle_t lightHandle, const renderLigh
 
 		light->world = this;
 		light->index = lightHandle;
+
+		// a def freed and added again every frame counts as moving
+		light->lastMovedFrameNum = tr.frameCount;
 	}
 
 	light->parms = *rlight;
@@ -688,6 +705,8 @@ void idRenderWorldLocal::RenderScene( const renderView_t *renderView ) {
 		return;
 	}
 
+	idProfileScope profile( "RenderScene" );
+
 	copy = *renderView;
 
 	// skip front end rendering work, which will result
@@ -1454,6 +1473,21 @@ void idRenderWorldLocal::AddEntityRefToArea( idRenderEntityLocal *def, portalAre
 	ref->areaPrev = area->entityRefs.areaPrev;
 	ref->areaNext->areaPrev = ref;
 	ref->areaPrev->areaNext = ref;
+
+	// the world bounds of the reference bounds, which are all the portal culling uses
+	idVec3		v, transformed;
+	idBounds	bounds;
+
+	bounds.Clear();
+	for ( int i = 0 ; i < 8 ; i++ ) {
+		v[0] = def->referenceBounds[i&1][0];
+		v[1] = def->referenceBounds[(i>>1)&1][1];
+		v[2] = def->referenceBounds[(i>>2)&1][2];
+
+		R_LocalPointToGlobal( def->modelMatrix, v, transformed );
+		bounds.AddPoint( transformed );
+	}
+	ref->treeNode = area->entityTree.Insert( ref, bounds );
 }
 
 /*
@@ -1478,6 +1512,8 @@ void idRenderWorldLocal::AddLightRefToArea( idRenderLightLocal *light, portalAre
 	lref->areaNext = area->lightRefs.areaNext;
 	lref->areaPrev = &area->lightRefs;
 	area->lightRefs.areaNext = lref;
+
+	lref->treeNode = area->lightTree.Insert( lref, light->frustumTris->bounds );
 }
 
 /*
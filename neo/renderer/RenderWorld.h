@@ -345,6 +345,10 @@ public:
 	virtual	void			SetPortalState( qhandle_t portal, int blockingBits ) = 0;
 	virtual int				GetPortalState( qhandle_t portal ) = 0;
 
+	// changes every time SetPortalState changes the state of a portal, so
+	// anything derived from portal states can tell when to recompute it
+	virtual int				GetPortalStateCount( void ) const = 0;
+
 	// returns true only if a chain of portals without the given connection bits set
 	// exists between the two areas (a door doesn't separate them, etc)
 	virtual	bool			AreasAreConnected( int areaNum1, int areaNum2, portalConnection_t connection ) = 0;
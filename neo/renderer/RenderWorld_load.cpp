@@ -62,6 +62,9 @@ void idRenderWorldLocal::FreeWorld() {
 		if ( area->entityRefs.areaNext != &area->entityRefs ) {
 			common->Error( "FreeWorld: unexpected remaining entityRefs" );
 		}
+
+		area->entityTree.Shutdown();
+		area->lightTree.Shutdown();
 	}
 
 	if ( portalAreas ) {
@@ -261,6 +264,8 @@ void idRenderWorldLocal::SetupAreaRefs() {
 		portalAreas[i].entityRefs.areaNext =
 		portalAreas[i].entityRefs.areaPrev =
 			&portalAreas[i].entityRefs;
+		portalAreas[i].entityTree.Init();
+		portalAreas[i].lightTree.Init();
 	}
 }
 
@@ -32,6 +32,9 @@ If you have questions concerning this license or the applicable additional terms
 // assume any lightDef or entityDef index above this is an internal error
 const int LUDICROUS_INDEX	= 10000;
 
+// areas with fewer references just walk the linked lists
+const int AREA_REF_TREE_MIN_REFS	= 16;
+
 typedef struct portal_s {
 	int						intoArea;		// area this portal leads to
 	idWinding *				w;				// winding points have counter clockwise ordering seen this area
@@ -61,9 +64,21 @@ typedef struct portalArea_s {
 	portal_t *		portals;		// never changes after load
 	areaReference_t	entityRefs;		// head/tail of doubly linked list, may change
 	areaReference_t	lightRefs;		// head/tail of doubly linked list, may change
+	idAreaRefTree	entityTree;		// world bounds of the entityRefs for culling large areas
+	idAreaRefTree	lightTree;		// world bounds of the lightRefs
 } portalArea_t;
 
 
+// the areas reached by one job of a parallel portal flood
+typedef struct {
+	struct portalFlowArea_s *areas;
+	int				numAreas;
+	int				maxAreas;
+	bool			overflowed;
+	const bool *	foggedOut;		// by doublePortal, NULL if no portal is fogged
+} portalFlow_t;
+
+
 static const int	CHILDREN_HAVE_MULTIPLE_AREAS = -2;
 static const int	AREANUM_SOLID = -1;
 typedef struct {
@@ -142,6 +157,7 @@ public:
 	portalArea_t *			portalAreas;
 	int						numPortalAreas;
 	int						connectedAreaNum;		// incremented every time a door portal state changes
+	int						portalStateCount;		// incremented by SetPortalState, never reset
 
 	idScreenRect *			areaScreenRect;
 
@@ -154,6 +170,9 @@ public:
 	idList<idRenderLightLocal*>		lightDefs;
 
 	idBlockAlloc<areaReference_t, 1024> areaReferenceAllocator;
+	idList<areaReference_t *>	areaRefCandidates;		// area tree query results, reused between areas
+	idList<struct portalFlowArea_s>	portalFlowAreas;		// records of the parallel portal flood jobs
+	int						maxPortalFlowAreas;		// records per job, grows when a job runs out
 	idBlockAlloc<idInteraction, 256>	interactionAllocator;
 	idBlockAlloc<areaNumRef_t, 1024>	areaNumRefAllocator;
 
@@ -191,15 +210,20 @@ public:
 
 	idScreenRect			ScreenRectFromWinding( const idWinding *w, viewEntity_t *space );
 	bool					PortalIsFoggedOut( const portal_t *p );
-	void					FloodViewThroughArea_r( const idVec3 origin, int areaNum, const struct portalStack_s *ps );
+	void					VisitFlowArea( int areaNum, const struct portalStack_s *ps, portalFlow_t *flow );
+	void					FloodViewThroughArea_r( const idVec3 origin, int areaNum, const struct portalStack_s *ps, portalFlow_t *flow );
+	void					FloodViewThroughPortal( const idVec3 origin, portal_t *p, const struct portalStack_s *ps, portalFlow_t *flow );
+	bool					FloodViewThroughPortalsParallel( const idVec3 origin, const struct portalStack_s *ps );
 	void					FlowViewThroughPortals( const idVec3 origin, int numPlanes, const idPlane *planes );
 	void					FloodLightThroughArea_r( idRenderLightLocal *light, int areaNum, const struct portalStack_s *ps );
 	void					FlowLightThroughPortals( idRenderLightLocal *light );
 	areaNumRef_t *			FloodFrustumAreas_r( const idFrustum &frustum, const int areaNum, const idBounds &bounds, areaNumRef_t *areas );
 	areaNumRef_t *			FloodFrustumAreas( const idFrustum &frustum, areaNumRef_t *areas );
 	bool					CullEntityByPortals( const idRenderEntityLocal *entity, const struct portalStack_s *ps );
+	void					AddAreaEntityRef( const areaReference_t *ref, const struct portalStack_s *ps );
 	void					AddAreaEntityRefs( int areaNum, const struct portalStack_s *ps );
 	bool					CullLightByPortals( const idRenderLightLocal *light, const struct portalStack_s *ps );
+	void					AddAreaLightRef( const areaReference_t *lref, const struct portalStack_s *ps );
 	void					AddAreaLightRefs( int areaNum, const struct portalStack_s *ps );
 	void					AddAreaRefs( int areaNum, const struct portalStack_s *ps );
 	void					BuildConnectedAreas_r( int areaNum );
@@ -210,6 +234,7 @@ public:
 	qhandle_t				FindPortal( const idBounds &b ) const;
 	void					SetPortalState( qhandle_t portal, int blockingBits );
 	int						GetPortalState( qhandle_t portal );
+	int						GetPortalStateCount( void ) const;
 	bool					AreasAreConnected( int areaNum1, int areaNum2, portalConnection_t connection );
 	void					FloodConnectedAreas( portalArea_t *area, int portalAttributeIndex );
 	idScreenRect &			GetAreaScreenRect( int areaNum ) const { return areaScreenRect[areaNum]; }
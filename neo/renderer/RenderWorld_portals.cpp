@@ -56,6 +56,11 @@ typedef struct portalStack_s {
 	// positive side is outside the visible frustum
 } portalStack_t;
 
+typedef struct portalFlowArea_s {
+	int				areaNum;
+	portalStack_t	stack;
+} portalFlowArea_t;
+
 
 //====================================================================
 
@@ -144,16 +149,68 @@ bool idRenderWorldLocal::PortalIsFoggedOut( const portal_t *p ) {
 	return true;
 }
 
+/*
+===================
+VisitFlowArea
+
+Either adds the refs of an area reached by the portal flow right away,
+or records the area and stack so a parallel flow can add them later in
+the same order as a serial one.
+===================
+*/
+void idRenderWorldLocal::VisitFlowArea( int areaNum, const portalStack_t *ps, portalFlow_t *flow ) {
+	if ( flow ) {
+		if ( flow->numAreas == flow->maxAreas ) {
+			flow->overflowed = true;
+			return;
+		}
+		portalFlowArea_t *fa = &flow->areas[flow->numAreas++];
+		fa->areaNum = areaNum;
+		fa->stack = *ps;
+		fa->stack.next = NULL;
+		return;
+	}
+
+	// cull models and lights to the current collection of planes
+	AddAreaRefs( areaNum, ps );
+
+	if ( areaScreenRect[areaNum].IsEmpty() ) {
+		areaScreenRect[areaNum] = ps->rect;
+	} else {
+		areaScreenRect[areaNum].Union( ps->rect );
+	}
+}
+
 /*
 ===================
 FloodViewThroughArea_r
 ===================
 */
 void idRenderWorldLocal::FloodViewThroughArea_r( const idVec3 origin, int areaNum,
-								 const struct portalStack_s *ps ) {
+								 const struct portalStack_s *ps, portalFlow_t *flow ) {
 	portal_t*		p;
-	float			d;
 	portalArea_t *	area;
+
+	area = &portalAreas[ areaNum ];
+
+	VisitFlowArea( areaNum, ps, flow );
+
+	// go through all the portals
+	for ( p = area->portals; p; p = p->next ) {
+		FloodViewThroughPortal( origin, p, ps, flow );
+	}
+}
+
+/*
+===================
+FloodViewThroughPortal
+
+Continues the flood into the area on the other side of the portal if any of it is visible.
+===================
+*/
+void idRenderWorldLocal::FloodViewThroughPortal( const idVec3 origin, portal_t *p,
+								 const struct portalStack_s *ps, portalFlow_t *flow ) {
+	float			d;
 	const portalStack_t	*check;
 	portalStack_t	newStack;
 	int				i, j;
@@ -161,115 +218,211 @@ void idRenderWorldLocal::FloodViewThroughArea_r( const idVec3 origin, int areaNu
 	int				addPlanes;
 	idFixedWinding	w;		// we won't overflow because MAX_PORTAL_PLANES = 20
 
-	area = &portalAreas[ areaNum ];
-
-	// cull models and lights to the current collection of planes
-	AddAreaRefs( areaNum, ps );
+	// an enclosing door may have sealed the portal off
+	if ( p->doublePortal->blockingBits & PS_BLOCK_VIEW ) {
+		return;
+	}
 
-	if ( areaScreenRect[areaNum].IsEmpty() ) {
-		areaScreenRect[areaNum] = ps->rect;
-	} else {
-		areaScreenRect[areaNum].Union( ps->rect );
+	// make sure this portal is facing away from the view
+	d = p->plane.Distance( origin );
+	if ( d < -0.1f ) {
+		return;
 	}
 
-	// go through all the portals
-	for ( p = area->portals; p; p = p->next ) {
-		// an enclosing door may have sealed the portal off
-		if ( p->doublePortal->blockingBits & PS_BLOCK_VIEW ) {
-			continue;
+	// make sure the portal isn't in our stack trace,
+	// which would cause an infinite loop
+	for ( check = ps; check; check = check->next ) {
+		if ( check->p == p ) {
+			break;		// don't recursively enter a stack
 		}
+	}
+	if ( check ) {
+		return;	// already in stack
+	}
 
-		// make sure this portal is facing away from the view
-		d = p->plane.Distance( origin );
-		if ( d < -0.1f ) {
-			continue;
-		}
+	// if we are very close to the portal surface, don't bother clipping
+	// it, which tends to give epsilon problems that make the area vanish
+	if ( d < 1.0f ) {
 
-		// make sure the portal isn't in our stack trace,
-		// which would cause an infinite loop
-		for ( check = ps; check; check = check->next ) {
-			if ( check->p == p ) {
-				break;		// don't recursively enter a stack
-			}
+		// go through this portal
+		newStack = *ps;
+		newStack.p = p;
+		newStack.next = ps;
+		FloodViewThroughArea_r( origin, p->intoArea, &newStack, flow );
+		return;
+	}
+
+	// clip the portal winding to all of the planes
+	w = *p->w;
+	for ( j = 0; j < ps->numPortalPlanes; j++ ) {
+		if ( !w.ClipInPlace( -ps->portalPlanes[j], 0 ) ) {
+			break;
 		}
-		if ( check ) {
-			continue;	// already in stack
+	}
+	if ( !w.GetNumPoints() ) {
+		return;	// portal not visible
+	}
+
+	// see if it is fogged out, parallel flows have it evaluated up front
+	if ( flow ) {
+		if ( flow->foggedOut && flow->foggedOut[ p->doublePortal - doublePortals ] ) {
+			return;
 		}
+	} else if ( PortalIsFoggedOut( p ) ) {
+		return;
+	}
 
-		// if we are very close to the portal surface, don't bother clipping
-		// it, which tends to give epsilon problems that make the area vanish
-		if ( d < 1.0f ) {
+	// go through this portal
+	newStack.p = p;
+	newStack.next = ps;
 
-			// go through this portal
-			newStack = *ps;
-			newStack.p = p;
-			newStack.next = ps;
-			FloodViewThroughArea_r( origin, p->intoArea, &newStack );
-			continue;
-		}
+	// find the screen pixel bounding box of the remaining portal
+	// so we can scissor things outside it
+	newStack.rect = ScreenRectFromWinding( &w, &tr.identitySpace );
 
-		// clip the portal winding to all of the planes
-		w = *p->w;
-		for ( j = 0; j < ps->numPortalPlanes; j++ ) {
-			if ( !w.ClipInPlace( -ps->portalPlanes[j], 0 ) ) {
-				break;
-			}
-		}
-		if ( !w.GetNumPoints() ) {
-			continue;	// portal not visible
+	// slop might have spread it a pixel outside, so trim it back
+	newStack.rect.Intersect( ps->rect );
+
+	// generate a set of clipping planes that will further restrict
+	// the visible view beyond just the scissor rect
+
+	addPlanes = w.GetNumPoints();
+	if ( addPlanes > MAX_PORTAL_PLANES ) {
+		addPlanes = MAX_PORTAL_PLANES;
+	}
+
+	newStack.numPortalPlanes = 0;
+	for ( i = 0; i < addPlanes; i++ ) {
+		j = i+1;
+		if ( j == w.GetNumPoints() ) {
+			j = 0;
 		}
 
-		// see if it is fogged out
-		if ( PortalIsFoggedOut( p ) ) {
+		v1 = origin - w[i].ToVec3();
+		v2 = origin - w[j].ToVec3();
+
+		newStack.portalPlanes[newStack.numPortalPlanes].Normal().Cross( v2, v1 );
+
+		// if it is degenerate, skip the plane
+		if ( newStack.portalPlanes[newStack.numPortalPlanes].Normalize() < 0.01f ) {
 			continue;
 		}
+		newStack.portalPlanes[newStack.numPortalPlanes].FitThroughPoint( origin );
 
-		// go through this portal
-		newStack.p = p;
-		newStack.next = ps;
+		newStack.numPortalPlanes++;
+	}
 
-		// find the screen pixel bounding box of the remaining portal
-		// so we can scissor things outside it
-		newStack.rect = ScreenRectFromWinding( &w, &tr.identitySpace );
+	// the last stack plane is the portal plane
+	newStack.portalPlanes[newStack.numPortalPlanes] = p->plane;
+	newStack.numPortalPlanes++;
 
-		// slop might have spread it a pixel outside, so trim it back
-		newStack.rect.Intersect( ps->rect );
+	FloodViewThroughArea_r( origin, p->intoArea, &newStack, flow );
+}
 
-		// generate a set of clipping planes that will further restrict
-		// the visible view beyond just the scissor rect
+typedef struct {
+	idRenderWorldLocal *	world;
+	idVec3					origin;
+	portal_t *				p;
+	const portalStack_t *	ps;
+	portalFlow_t			flow;
+} portalFlowJob_t;
 
-		addPlanes = w.GetNumPoints();
-		if ( addPlanes > MAX_PORTAL_PLANES ) {
-			addPlanes = MAX_PORTAL_PLANES;
-		}
+/*
+===================
+R_PortalFlowJob
+===================
+*/
+static void R_PortalFlowJob( void *data ) {
+	portalFlowJob_t *job = (portalFlowJob_t *)data;
 
-		newStack.numPortalPlanes = 0;
-		for ( i = 0; i < addPlanes; i++ ) {
-			j = i+1;
-			if ( j == w.GetNumPoints() ) {
-				j = 0;
-			}
+	job->world->FloodViewThroughPortal( job->origin, job->p, job->ps, &job->flow );
+}
 
-			v1 = origin - w[i].ToVec3();
-			v2 = origin - w[j].ToVec3();
+/*
+===================
+FloodViewThroughPortalsParallel
 
-			newStack.portalPlanes[newStack.numPortalPlanes].Normal().Cross( v2, v1 );
+Floods each portal out of the view area in its own job.  The jobs only
+record the areas they reach, which are then added in portal order, so
+the viewEntities and viewLights come out the same as with a serial flood.
+A job that runs out of record space has its portal flooded again serially.
+Returns false if the flood should be done serially.
+===================
+*/
+bool idRenderWorldLocal::FloodViewThroughPortalsParallel( const idVec3 origin, const portalStack_t *ps ) {
+	if ( !r_useParallelFrontEnd.GetBool() || parallelJobManager->GetNumWorkers() == 0 ) {
+		return false;
+	}
 
-			// if it is degenerate, skip the plane
-			if ( newStack.portalPlanes[newStack.numPortalPlanes].Normalize() < 0.01f ) {
-				continue;
+	portalArea_t *area = &portalAreas[ tr.viewDef->areaNum ];
+
+	int numPortals = 0;
+	for ( portal_t *p = area->portals ; p ; p = p->next ) {
+		if ( !( p->doublePortal->blockingBits & PS_BLOCK_VIEW ) ) {
+			numPortals++;
+		}
+	}
+	if ( numPortals < 2 ) {
+		return false;
+	}
+
+	// evaluating fog calls into the material and sound code, so do it here
+	bool *foggedOut = NULL;
+	for ( int i = 0 ; i < numInterAreaPortals ; i++ ) {
+		if ( doublePortals[i].fogLight ) {
+			if ( !foggedOut ) {
+				foggedOut = (bool *)R_ClearedFrameAlloc( numInterAreaPortals * sizeof( foggedOut[0] ) );
 			}
-			newStack.portalPlanes[newStack.numPortalPlanes].FitThroughPoint( origin );
+			foggedOut[i] = PortalIsFoggedOut( doublePortals[i].portals[0] );
+		}
+	}
 
-			newStack.numPortalPlanes++;
+	portalFlowAreas.SetNum( numPortals * maxPortalFlowAreas, false );
+	portalFlowJob_t *jobs = (portalFlowJob_t *)R_FrameAlloc( numPortals * sizeof( jobs[0] ) );
+
+	idParallelJobList jobList( "FloodViewThroughPortals" );
+	numPortals = 0;
+	for ( portal_t *p = area->portals ; p ; p = p->next ) {
+		if ( p->doublePortal->blockingBits & PS_BLOCK_VIEW ) {
+			continue;
 		}
+		portalFlowJob_t *job = &jobs[numPortals];
+		job->world = this;
+		job->origin = origin;
+		job->p = p;
+		job->ps = ps;
+		job->flow.areas = portalFlowAreas.Ptr() + numPortals * maxPortalFlowAreas;
+		job->flow.numAreas = 0;
+		job->flow.maxAreas = maxPortalFlowAreas;
+		job->flow.overflowed = false;
+		job->flow.foggedOut = foggedOut;
+		jobList.AddJob( R_PortalFlowJob, job );
+		numPortals++;
+	}
+	jobList.Run();
 
-		// the last stack plane is the portal plane
-		newStack.portalPlanes[newStack.numPortalPlanes] = p->plane;
-		newStack.numPortalPlanes++;
+	VisitFlowArea( tr.viewDef->areaNum, ps, NULL );
 
-		FloodViewThroughArea_r( origin, p->intoArea, &newStack );
+	bool overflowed = false;
+	for ( int i = 0 ; i < numPortals ; i++ ) {
+		const portalFlow_t &flow = jobs[i].flow;
+
+		if ( flow.overflowed ) {
+			FloodViewThroughPortal( origin, jobs[i].p, ps, NULL );
+			overflowed = true;
+			continue;
+		}
+		for ( int j = 0 ; j < flow.numAreas ; j++ ) {
+			VisitFlowArea( flow.areas[j].areaNum, &flow.areas[j].stack, NULL );
+		}
+	}
+
+	// give the next flood more room
+	if ( overflowed ) {
+		maxPortalFlowAreas *= 2;
 	}
+
+	return true;
 }
 
 /*
@@ -313,7 +466,9 @@ void idRenderWorldLocal::FlowViewThroughPortals( const idVec3 origin, int numPla
 		}
 
 		// flood out through portals, setting area viewCount
-		FloodViewThroughArea_r( origin, tr.viewDef->areaNum, &ps );
+		if ( !FloodViewThroughPortalsParallel( origin, &ps ) ) {
+			FloodViewThroughArea_r( origin, tr.viewDef->areaNum, &ps, NULL );
+		}
 	}
 }
 
@@ -579,57 +734,78 @@ bool idRenderWorldLocal::CullEntityByPortals( const idRenderEntityLocal *entity,
 	return false;
 }
 
+/*
+===================
+AddAreaEntityRef
+===================
+*/
+void idRenderWorldLocal::AddAreaEntityRef( const areaReference_t *ref, const portalStack_t *ps ) {
+	idRenderEntityLocal	*entity;
+	viewEntity_t		*vEnt;
+
+	entity = ref->entity;
+
+	// debug tool to allow viewing of only one entity at a time
+	if ( r_singleEntity.GetInteger() >= 0 && r_singleEntity.GetInteger() != entity->index ) {
+		return;
+	}
+
+	// remove decals that are completely faded away
+	R_FreeEntityDefFadedDecals( entity, tr.viewDef->renderView.time );
+
+	// check for completely suppressing the model
+	if ( !r_skipSuppress.GetBool() ) {
+		if ( entity->parms.suppressSurfaceInViewID
+				&& entity->parms.suppressSurfaceInViewID == tr.viewDef->renderView.viewID ) {
+			return;
+		}
+		if ( entity->parms.allowSurfaceInViewID
+				&& entity->parms.allowSurfaceInViewID != tr.viewDef->renderView.viewID ) {
+			return;
+		}
+	}
+
+	// cull reference bounds
+	if ( CullEntityByPortals( entity, ps ) ) {
+		// we are culled out through this portal chain, but it might
+		// still be visible through others
+		return;
+	}
+
+	vEnt = R_SetEntityDefViewEntity( entity );
+
+	// possibly expand the scissor rect
+	vEnt->scissorRect.Union( ps->rect );
+}
+
 /*
 ===================
 AddAreaEntityRefs
 
 Any models that are visible through the current portalStack will
 have their scissor
+
+Areas with many references only visit the entityTree nodes that
+are not outside the portal planes.
 ===================
 */
 void idRenderWorldLocal::AddAreaEntityRefs( int areaNum, const portalStack_t *ps ) {
 	areaReference_t		*ref;
-	idRenderEntityLocal	*entity;
 	portalArea_t		*area;
-	viewEntity_t		*vEnt;
-	idBounds			b;
 
 	area = &portalAreas[ areaNum ];
 
-	for ( ref = area->entityRefs.areaNext ; ref != &area->entityRefs ; ref = ref->areaNext ) {
-		entity = ref->entity;
-
-		// debug tool to allow viewing of only one entity at a time
-		if ( r_singleEntity.GetInteger() >= 0 && r_singleEntity.GetInteger() != entity->index ) {
-			continue;
+	if ( r_useAreaRefTree.GetBool() && r_useEntityCulling.GetBool() && area->entityTree.Num() >= AREA_REF_TREE_MIN_REFS ) {
+		areaRefCandidates.SetNum( 0, false );
+		area->entityTree.CullByPlanes( ps->numPortalPlanes, ps->portalPlanes, areaRefCandidates );
+		for ( int i = 0 ; i < areaRefCandidates.Num() ; i++ ) {
+			AddAreaEntityRef( areaRefCandidates[i], ps );
 		}
+		return;
+	}
 
-		// remove decals that are completely faded away
-		R_FreeEntityDefFadedDecals( entity, tr.viewDef->renderView.time );
-
-		// check for completely suppressing the model
-		if ( !r_skipSuppress.GetBool() ) {
-			if ( entity->parms.suppressSurfaceInViewID
-					&& entity->parms.suppressSurfaceInViewID == tr.viewDef->renderView.viewID ) {
-				continue;
-			}
-			if ( entity->parms.allowSurfaceInViewID
-					&& entity->parms.allowSurfaceInViewID != tr.viewDef->renderView.viewID ) {
-				continue;
-			}
-		}
-
-		// cull reference bounds
-		if ( CullEntityByPortals( entity, ps ) ) {
-			// we are culled out through this portal chain, but it might
-			// still be visible through others
-			continue;
-		}
-
-		vEnt = R_SetEntityDefViewEntity( entity );
-
-		// possibly expand the scissor rect
-		vEnt->scissorRect.Union( ps->rect );
+	for ( ref = area->entityRefs.areaNext ; ref != &area->entityRefs ; ref = ref->areaNext ) {
+		AddAreaEntityRef( ref, ps );
 	}
 }
 
@@ -712,6 +888,43 @@ bool idRenderWorldLocal::CullLightByPortals( const idRenderLightLocal *light, co
 	return false;
 }
 
+/*
+===================
+AddAreaLightRef
+===================
+*/
+void idRenderWorldLocal::AddAreaLightRef( const areaReference_t *lref, const portalStack_t *ps ) {
+	idRenderLightLocal			*light;
+	viewLight_t			*vLight;
+
+	light = lref->light;
+
+	// debug tool to allow viewing of only one light at a time
+	if ( r_singleLight.GetInteger() >= 0 && r_singleLight.GetInteger() != light->index ) {
+		return;
+	}
+
+	// check for being closed off behind a door
+	// a light that doesn't cast shadows will still light even if it is behind a door
+	if ( r_useLightCulling.GetInteger() >= 3 &&
+			!light->parms.noShadows && light->lightShader->LightCastsShadows()
+				&& light->areaNum != -1 && !tr.viewDef->connectedAreas[ light->areaNum ] ) {
+		return;
+	}
+
+	// cull frustum
+	if ( CullLightByPortals( light, ps ) ) {
+		// we are culled out through this portal chain, but it might
+		// still be visible through others
+		return;
+	}
+
+	vLight = R_SetLightDefViewLight( light );
+
+	// expand the scissor rect
+	vLight->scissorRect.Union( ps->rect );
+}
+
 /*
 ===================
 AddAreaLightRefs
@@ -722,38 +935,21 @@ This is the only point where lights get added to the viewLights list
 void idRenderWorldLocal::AddAreaLightRefs( int areaNum, const portalStack_t *ps ) {
 	areaReference_t		*lref;
 	portalArea_t		*area;
-	idRenderLightLocal			*light;
-	viewLight_t			*vLight;
 
 	area = &portalAreas[ areaNum ];
 
-	for ( lref = area->lightRefs.areaNext ; lref != &area->lightRefs ; lref = lref->areaNext ) {
-		light = lref->light;
-
-		// debug tool to allow viewing of only one light at a time
-		if ( r_singleLight.GetInteger() >= 0 && r_singleLight.GetInteger() != light->index ) {
-			continue;
-		}
-
-		// check for being closed off behind a door
-		// a light that doesn't cast shadows will still light even if it is behind a door
-		if ( r_useLightCulling.GetInteger() >= 3 &&
-				!light->parms.noShadows && light->lightShader->LightCastsShadows()
-					&& light->areaNum != -1 && !tr.viewDef->connectedAreas[ light->areaNum ] ) {
-			continue;
-		}
-
-		// cull frustum
-		if ( CullLightByPortals( light, ps ) ) {
-			// we are culled out through this portal chain, but it might
-			// still be visible through others
-			continue;
+	// the last stack plane is not used because lights are not near clipped
+	if ( r_useAreaRefTree.GetBool() && r_useLightCulling.GetInteger() != 0 && area->lightTree.Num() >= AREA_REF_TREE_MIN_REFS ) {
+		areaRefCandidates.SetNum( 0, false );
+		area->lightTree.CullByPlanes( ps->numPortalPlanes - 1, ps->portalPlanes, areaRefCandidates );
+		for ( int i = 0 ; i < areaRefCandidates.Num() ; i++ ) {
+			AddAreaLightRef( areaRefCandidates[i], ps );
 		}
+		return;
+	}
 
-		vLight = R_SetLightDefViewLight( light );
-
-		// expand the scissor rect
-		vLight->scissorRect.Union( ps->rect );
+	for ( lref = area->lightRefs.areaNext ; lref != &area->lightRefs ; lref = lref->areaNext ) {
+		AddAreaLightRef( lref, ps );
 	}
 }
 
@@ -837,6 +1033,8 @@ they were considered, but not actually visible.
 =============
 */
 void idRenderWorldLocal::FindViewLightsAndEntities( void ) {
+	idProfileScope profile( "FindViewLightsAndEntities" );
+
 	// clear the visible lightDef and entityDef lists
 	tr.viewDef->viewLights = NULL;
 	tr.viewDef->viewEntitys = NULL;
@@ -994,6 +1192,7 @@ void		idRenderWorldLocal::SetPortalState( qhandle_t portal, int blockTypes ) {
 		return;
 	}
 	doublePortals[portal-1].blockingBits = blockTypes;
+	portalStateCount++;
 
 	// leave the connectedAreaGroup the same on one side,
 	// then flood fill from the other side with a new number for each changed attribute
@@ -1012,6 +1211,15 @@ void		idRenderWorldLocal::SetPortalState( qhandle_t portal, int blockTypes ) {
 	}
 }
 
+/*
+==============
+GetPortalStateCount
+==============
+*/
+int		idRenderWorldLocal::GetPortalStateCount( void ) const {
+	return portalStateCount;
+}
+
 /*
 ==============
 GetPortalState
@@ -32,6 +32,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "tr_local.h"
 
 static const int	FRAME_MEMORY_BYTES = 0x200000;
+static const int	FRAME_TEMP_HEADERS = 4096;
 static const int	EXPAND_HEADERS = 1024;
 
 idCVar idVertexCache::r_showVertexCache( "r_showVertexCache", "0", CVAR_INTEGER|CVAR_RENDERER, "" );
@@ -170,15 +171,18 @@ void idVertexCache::Init() {
 	// initialize the cache memory blocks
 	freeStaticHeaders.next = freeStaticHeaders.prev = &freeStaticHeaders;
 	staticHeaders.next = staticHeaders.prev = &staticHeaders;
-	freeDynamicHeaders.next = freeDynamicHeaders.prev = &freeDynamicHeaders;
-	dynamicHeaders.next = dynamicHeaders.prev = &dynamicHeaders;
 	deferredFreeList.next = deferredFreeList.prev = &deferredFreeList;
 
 	// set up the dynamic frame memory
 	frameBytes = FRAME_MEMORY_BYTES;
+	frameTempHeaders = FRAME_TEMP_HEADERS;
 	staticAllocTotal = 0;
+	dynamicAllocThisFrame = 0;
+	dynamicCountThisFrame = 0;
+	overflowHeaders = NULL;
+	overflowUploaded = NULL;
 
-	byte	*junk = (byte *)Mem_Alloc( frameBytes );
+	byte	*junk = (byte *)Mem_ClearedAlloc( frameBytes );
 	for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
 		allocatingTempBuffer = true;	// force the alloc to use GL_STREAM_DRAW_ARB
 		Alloc( junk, frameBytes, &tempBuffers[i] );
@@ -187,6 +191,10 @@ void idVertexCache::Init() {
 		// unlink these from the static list, so they won't ever get purged
 		tempBuffers[i]->next->prev = tempBuffers[i]->prev;
 		tempBuffers[i]->prev->next = tempBuffers[i]->next;
+
+		// with vertex buffers the temps are staged in system memory and uploaded in one go
+		tempStaging[i] = virtualMemory ? NULL : (byte *)Mem_Alloc16( frameBytes );
+		tempHeaders[i] = (vertCache_t *)Mem_ClearedAlloc( frameTempHeaders * sizeof( vertCache_t ) );
 	}
 	Mem_Free( junk );
 
@@ -215,6 +223,15 @@ idVertexCache::Shutdown
 void idVertexCache::Shutdown() {
 //	PurgeAll();	// !@#: also purge the temp buffers
 
+	FreeFrameTempOverflow();
+
+	for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
+		Mem_Free16( tempStaging[i] );
+		tempStaging[i] = NULL;
+		Mem_Free( tempHeaders[i] );
+		tempHeaders[i] = NULL;
+	}
+
 	headerAllocator.Shutdown();
 }
 
@@ -364,70 +381,170 @@ idVertexCache::AllocFrameTemp
 A frame temp allocation must never be allowed to fail due to overflow.
 We can't simply sync with the GPU and overwrite what we have, because
 there may still be future references to dynamically created surfaces.
+
+The space in the temp buffer and the header are reserved with atomic adds,
+so multiple threads can allocate at the same time without locking.  Data
+that doesn't fit goes through AllocFrameTempOverflow, and the temp buffers
+are grown to the high water mark at the end of the frame.
 ===========
 */
 vertCache_t	*idVertexCache::AllocFrameTemp( void *data, int size ) {
-	vertCache_t	*block;
-
 	if ( size <= 0 ) {
 		common->Error( "idVertexCache::AllocFrameTemp: size = %i\n", size );
 	}
 
-	if ( dynamicAllocThisFrame + size > frameBytes ) {
-		// if we don't have enough room in the temp block, allocate a static block,
-		// but immediately free it so it will get freed at the next frame
-		tempOverflow = true;
-		Alloc( data, size, &block );
-		Free( block);
-		return block;
-	}
+	// keep every allocation 16 byte aligned
+	const int alignedSize = ( size + 15 ) & ~15;
 
-	// this data is just going on the shared dynamic list
+	const int offset = dynamicAllocThisFrame.fetch_add( alignedSize, std::memory_order_relaxed );
+	const int headerNum = dynamicCountThisFrame.fetch_add( 1, std::memory_order_relaxed );
 
-	// if we don't have any remaining unused headers, allocate some more
-	if ( freeDynamicHeaders.next == &freeDynamicHeaders ) {
-
-		for ( int i = 0; i < EXPAND_HEADERS; i++ ) {
-			block = headerAllocator.Alloc();
-			block->next = freeDynamicHeaders.next;
-			block->prev = &freeDynamicHeaders;
-			block->next->prev = block;
-			block->prev->next = block;
-		}
+	if ( offset + alignedSize > frameBytes || headerNum >= frameTempHeaders ) {
+		return AllocFrameTempOverflow( data, size );
 	}
 
-	// move it from the freeDynamicHeaders list to the dynamicHeaders list
-	block = freeDynamicHeaders.next;
-	block->next->prev = block->prev;
-	block->prev->next = block->next;
-	block->next = dynamicHeaders.next;
-	block->prev = &dynamicHeaders;
-	block->next->prev = block;
-	block->prev->next = block;
+	vertCache_t *block = &tempHeaders[listNum][headerNum];
 
 	block->size = size;
 	block->tag = TAG_TEMP;
 	block->indexBuffer = false;
-	block->offset = dynamicAllocThisFrame;
-	dynamicAllocThisFrame += block->size;
-	dynamicCountThisFrame++;
+	block->offset = offset;
 	block->user = NULL;
+	block->next = block->prev = NULL;
 	block->frameUsed = 0;
-
-	// copy the data
 	block->virtMem = tempBuffers[listNum]->virtMem;
 	block->vbo = tempBuffers[listNum]->vbo;
 
+	// copy the data, vertex buffers are updated in UploadFrameTemp
 	if ( block->vbo ) {
-		glBindBufferARB( GL_ARRAY_BUFFER_ARB, block->vbo );
-		glBufferSubDataARB( GL_ARRAY_BUFFER_ARB, block->offset, (GLsizeiptrARB)size, data );
+		SIMDProcessor->Memcpy( tempStaging[listNum] + offset, data, size );
 	} else {
-		SIMDProcessor->Memcpy( (byte *)block->virtMem + block->offset, data, size );
+		SIMDProcessor->Memcpy( (byte *)block->virtMem + offset, data, size );
 	}
 
 	return block;
 }
 
+/*
+===========
+idVertexCache::AllocFrameTempOverflow
+
+Called when the temp buffer is full.  The data is copied to its own block of
+system memory, which is moved into a static vertex buffer by UploadFrameTemp.
+This uses the C library allocator because it is thread safe and the engine heap isn't.
+===========
+*/
+vertCache_t *idVertexCache::AllocFrameTempOverflow( void *data, int size ) {
+	vertCache_t *block = (vertCache_t *)malloc( sizeof( vertCache_t ) );
+	memset( block, 0, sizeof( *block ) );
+
+	block->size = size;
+	block->tag = TAG_TEMP;
+	block->virtMem = malloc( size );
+	memcpy( block->virtMem, data, size );
+
+	Sys_EnterCriticalSection( CRITICAL_SECTION_TWO );
+	tempOverflow = true;
+	block->next = overflowHeaders;
+	overflowHeaders = block;
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_TWO );
+
+	return block;
+}
+
+/*
+===========
+idVertexCache::FreeFrameTempOverflow
+===========
+*/
+void idVertexCache::FreeFrameTempOverflow() {
+	vertCache_t *block, *next;
+
+	for ( block = overflowHeaders; block; block = next ) {
+		next = block->next;
+		free( block->virtMem );
+		free( block );
+	}
+	overflowHeaders = NULL;
+	overflowUploaded = NULL;
+}
+
+/*
+===========
+idVertexCache::UploadFrameTemp
+
+Called from the main thread before the back end runs, when
+no parallel job can be allocating frame temp memory.
+===========
+*/
+void idVertexCache::UploadFrameTemp() {
+	const int end = Min( dynamicAllocThisFrame.load(), frameBytes );
+
+	if ( !virtualMemory && end > dynamicUploadedThisFrame ) {
+		glBindBufferARB( GL_ARRAY_BUFFER_ARB, tempBuffers[listNum]->vbo );
+		glBufferSubDataARB( GL_ARRAY_BUFFER_ARB, dynamicUploadedThisFrame, (GLsizeiptrARB)( end - dynamicUploadedThisFrame ),
+							tempStaging[listNum] + dynamicUploadedThisFrame );
+		dynamicUploadedThisFrame = end;
+	}
+
+	// the overflow blocks are already usable from system memory
+	if ( virtualMemory ) {
+		return;
+	}
+
+	// allocate a static block for each new overflow temp,
+	// but immediately free it so it will get freed at the next frame
+	for ( vertCache_t *block = overflowHeaders; block != overflowUploaded; block = block->next ) {
+		vertCache_t *staticBlock;
+
+		allocatingTempBuffer = true;	// force the alloc to use GL_STREAM_DRAW_ARB
+		Alloc( block->virtMem, block->size, &staticBlock );
+		allocatingTempBuffer = false;
+		Free( staticBlock );
+
+		block->vbo = staticBlock->vbo;
+		block->offset = staticBlock->offset;
+	}
+	overflowUploaded = overflowHeaders;
+}
+
+/*
+===========
+idVertexCache::ResizeFrameTemp
+
+Grows all the temp buffers, only called at the end of a frame.
+===========
+*/
+void idVertexCache::ResizeFrameTemp( int bytes, int numHeaders ) {
+	if ( r_showVertexCache.GetBool() ) {
+		common->Printf( "vertex cache: growing frame temp memory to %ik and %i headers\n", bytes / 1024, numHeaders );
+	}
+
+	for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
+		if ( bytes != frameBytes ) {
+			vertCache_t *block = tempBuffers[i];
+			if ( block->vbo ) {
+				glBindBufferARB( GL_ARRAY_BUFFER_ARB, block->vbo );
+				glBufferDataARB( GL_ARRAY_BUFFER_ARB, (GLsizeiptrARB)bytes, NULL, GL_STREAM_DRAW_ARB );
+				Mem_Free16( tempStaging[i] );
+				tempStaging[i] = (byte *)Mem_Alloc16( bytes );
+			} else {
+				Mem_Free( block->virtMem );
+				block->virtMem = Mem_Alloc( bytes );
+			}
+			staticAllocTotal += bytes - block->size;
+			block->size = bytes;
+		}
+		if ( numHeaders != frameTempHeaders ) {
+			Mem_Free( tempHeaders[i] );
+			tempHeaders[i] = (vertCache_t *)Mem_ClearedAlloc( numHeaders * sizeof( vertCache_t ) );
+		}
+	}
+
+	frameBytes = bytes;
+	frameTempHeaders = numHeaders;
+}
+
 /*
 ===========
 idVertexCache::EndFrame
@@ -449,7 +566,7 @@ void idVertexCache::EndFrame() {
 		const char *frameOverflow = tempOverflow ? "(OVERFLOW)" : "";
 
 		common->Printf( "vertex dynamic:%i=%ik%s, static alloc:%i=%ik used:%i=%ik total:%i=%ik\n",
-			dynamicCountThisFrame, dynamicAllocThisFrame/1024, frameOverflow,
+			dynamicCountThisFrame.load(), dynamicAllocThisFrame.load()/1024, frameOverflow,
 			staticCountThisFrame, staticAllocThisFrame/1024,
 			staticUseCount, staticUseSize/1024,
 			staticCountTotal, staticAllocTotal/1024 );
@@ -471,12 +588,27 @@ void idVertexCache::EndFrame() {
 	}
 
 
+	// grow the temp buffers to the high water mark, with some room to spare,
+	// so a spike only goes through the slow overflow path for a single frame
+	int newFrameBytes = frameBytes;
+	while ( newFrameBytes < dynamicAllocThisFrame.load() ) {
+		newFrameBytes += newFrameBytes >> 1;
+	}
+	int newFrameTempHeaders = frameTempHeaders;
+	while ( newFrameTempHeaders < dynamicCountThisFrame.load() ) {
+		newFrameTempHeaders += newFrameTempHeaders >> 1;
+	}
+	if ( newFrameBytes != frameBytes || newFrameTempHeaders != frameTempHeaders ) {
+		ResizeFrameTemp( ( newFrameBytes + 15 ) & ~15, newFrameTempHeaders );
+	}
+
 	currentFrame = tr.frameCount;
 	listNum = currentFrame % NUM_VERTEX_FRAMES;
 	staticAllocThisFrame = 0;
 	staticCountThisFrame = 0;
 	dynamicAllocThisFrame = 0;
 	dynamicCountThisFrame = 0;
+	dynamicUploadedThisFrame = 0;
 	tempOverflow = false;
 
 	// free all the deferred free headers
@@ -484,16 +616,8 @@ void idVertexCache::EndFrame() {
 		ActuallyFree( deferredFreeList.next );
 	}
 
-	// free all the frame temp headers
-	vertCache_t	*block = dynamicHeaders.next;
-	if ( block != &dynamicHeaders ) {
-		block->prev = &freeDynamicHeaders;
-		dynamicHeaders.prev->next = freeDynamicHeaders.next;
-		freeDynamicHeaders.next->prev = dynamicHeaders.prev;
-		freeDynamicHeaders.next = block;
-
-		dynamicHeaders.next = dynamicHeaders.prev = &dynamicHeaders;
-	}
+	// free all the frame temp overflow headers
+	FreeFrameTempOverflow();
 }
 
 /*
@@ -521,16 +645,11 @@ void idVertexCache::List( void ) {
 		numFreeStaticHeaders++;
 	}
 
-	int	numFreeDynamicHeaders = 0;
-	for ( block = freeDynamicHeaders.next ; block != &freeDynamicHeaders ; block = block->next ) {
-		numFreeDynamicHeaders++;
-	}
-
 	common->Printf( "%i megs working set\n", r_vertexBufferMegs.GetInteger() );
 	common->Printf( "%i dynamic temp buffers of %ik\n", NUM_VERTEX_FRAMES, frameBytes / 1024 );
 	common->Printf( "%5i active static headers\n", numActive );
 	common->Printf( "%5i free static headers\n", numFreeStaticHeaders );
-	common->Printf( "%5i free dynamic headers\n", numFreeDynamicHeaders );
+	common->Printf( "%5i dynamic headers per frame\n", frameTempHeaders );
 
 	if ( !virtualMemory  ) {
 		common->Printf( "Vertex cache is in ARB_vertex_buffer_object memory (FAST).\n");
@@ -86,10 +86,16 @@ public:
 	// automatically freed at the end of the next frame
 	// used for specular texture coordinates and gui drawing, which
 	// will change every frame.
-	// will return NULL if the vertex cache is completely full
+	// This can be called from parallel jobs, the data is staged in system
+	// memory and only uploaded by UploadFrameTemp().  It never fails, if the
+	// temp buffers overflow the frame temp memory is grown at the end of the frame.
 	// As with Position(), this may not actually be a pointer you can access.
 	vertCache_t	*	AllocFrameTemp( void *data, int bytes );
 
+	// uploads the frame temp data allocated since the last call,
+	// must be called on the main thread before the back end draws
+	void			UploadFrameTemp();
+
 	// notes that a buffer is used this frame, so it can't be purged
 	// out from under the GPU
 	void			Touch( vertCache_t *buffer );
@@ -110,6 +116,9 @@ public:
 private:
 	void			InitMemoryBlocks( int size );
 	void			ActuallyFree( vertCache_t *block );
+	vertCache_t *	AllocFrameTempOverflow( void *data, int bytes );
+	void			FreeFrameTempOverflow();
+	void			ResizeFrameTemp( int bytes, int numHeaders );
 
 	static idCVar	r_showVertexCache;
 	static idCVar	r_vertexBufferMegs;
@@ -119,8 +128,9 @@ private:
 
 	int				staticAllocThisFrame;	// debug counter
 	int				staticCountThisFrame;
-	int				dynamicAllocThisFrame;
-	int				dynamicCountThisFrame;
+	std::atomic<int>	dynamicAllocThisFrame;	// bytes reserved in the temp buffer, may be more than frameBytes
+	std::atomic<int>	dynamicCountThisFrame;	// headers reserved, may be more than frameTempHeaders
+	int				dynamicUploadedThisFrame;	// bytes of the temp buffer already uploaded
 
 	int				currentFrame;			// for purgable block tracking
 	int				listNum;				// currentFrame % NUM_VERTEX_FRAMES, determines which tempBuffers to use
@@ -130,18 +140,22 @@ private:
 	bool			allocatingTempBuffer;	// force GL_STREAM_DRAW_ARB
 
 	vertCache_t		*tempBuffers[NUM_VERTEX_FRAMES];		// allocated at startup
+	byte			*tempStaging[NUM_VERTEX_FRAMES];		// system memory copies of the temp buffers, NULL with virtual memory
+	vertCache_t		*tempHeaders[NUM_VERTEX_FRAMES];		// headers for the allocations in each temp buffer
 	bool			tempOverflow;			// had to alloc a temp in static memory
 
+	vertCache_t		*overflowHeaders;		// temps that didn't fit in the temp buffer this frame
+	vertCache_t		*overflowUploaded;		// first of the overflowHeaders that is already uploaded
+
 	idBlockAlloc<vertCache_t,1024>	headerAllocator;
 
 	vertCache_t		freeStaticHeaders;		// head of doubly linked list
-	vertCache_t		freeDynamicHeaders;		// head of doubly linked list
-	vertCache_t		dynamicHeaders;			// head of doubly linked list
 	vertCache_t		deferredFreeList;		// head of doubly linked list
 	vertCache_t		staticHeaders;			// head of doubly linked list in MRU order,
 											// staticHeaders.next is most recently used
 
 	int				frameBytes;				// for each of NUM_VERTEX_FRAMES frames
+	int				frameTempHeaders;		// for each of NUM_VERTEX_FRAMES frames
 };
 
 extern	idVertexCache	vertexCache;
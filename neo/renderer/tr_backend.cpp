@@ -649,6 +649,8 @@ void RB_ExecuteBackEndCommands( const emptyCommand_t *cmds ) {
 		return;
 	}
 
+	idProfileScope profile( "RB_ExecuteBackEndCommands" );
+
 	backEndStartTime = Sys_Milliseconds();
 
 	// needed for editor rendering
@@ -1235,6 +1235,12 @@ void R_DeformDrawSurf( drawSurf_t *drawSurf ) {
 	if ( r_skipDeforms.GetBool() ) {
 		return;
 	}
+	if ( drawSurf->material->Deform() == DFRM_NONE ) {
+		return;
+	}
+
+	idProfileScope profile( "R_DeformDrawSurf" );
+
 	switch ( drawSurf->material->Deform() ) {
 	case DFRM_NONE:
 		return;
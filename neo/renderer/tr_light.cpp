@@ -730,10 +730,10 @@ R_CalcLightScissorRectangle
 
 The light screen bounds will be used to crop the scissor rect during
 stencil clears and interaction drawing
+
+Only reads the view and the light, so this can run in a parallel job
 ==================
 */
-int	c_clippedLight, c_unclippedLight;
-
 idScreenRect	R_CalcLightScissorRectangle( viewLight_t *vLight ) {
 	idScreenRect	r;
 	srfTriangles_t *tri;
@@ -760,7 +760,6 @@ idScreenRect	R_CalcLightScissorRectangle( viewLight_t *vLight ) {
 
 		// if it is near clipped, clip the winding polygons to the view frustum
 		if ( clip[3] <= 1 ) {
-			c_clippedLight++;
 			if ( r_useClippedLightScissors.GetInteger() ) {
 				return R_ClippedLightScissorRectangle( vLight );
 			} else {
@@ -793,11 +792,133 @@ idScreenRect	R_CalcLightScissorRectangle( viewLight_t *vLight ) {
 	// add the fudge boundary
 	r.Expand();
 
-	c_unclippedLight++;
-
 	return r;
 }
 
+/*
+===============================================================================
+
+	Parallel front end
+
+	The parts of R_AddLightSurfaces and R_AddModelSurfaces that only read the
+	view and the light / entity definitions are split into jobs before the
+	lists are walked: the light and entity scissor rectangles, and the view
+	frustum culling of the surfaces of static models. The job results are
+	stored per list entry in frame memory allocated up front, and the serial
+	walk consumes them in list order, so draw surfaces are created in exactly
+	the same order as without jobs.
+
+	Everything that allocates, touches the vertex cache, evaluates material
+	registers, issues entity callbacks or instantiates dynamic models stays
+	on the main thread.
+
+===============================================================================
+*/
+
+static const int	FRONTEND_LIGHTS_PER_JOB		= 4;
+static const int	FRONTEND_ENTITIES_PER_JOB	= 16;
+
+typedef struct {
+	viewLight_t **			vLights;
+	idScreenRect *			scissorRects;
+	int						numLights;
+} frontEndLightJob_t;
+
+typedef struct {
+	const modelSurface_t *	surf;
+	const idMaterial *		shader;		// remapped by the skin, but without the global override
+} frontEndSurf_t;
+
+typedef struct {
+	viewEntity_t *			vEntity;
+	const idRenderModel *	model;		// static model the surfaces were culled for
+	frontEndSurf_t *		surfs;		// NULL if the surfaces have to be culled on the main thread
+	int						numSurfs;
+} frontEndEntity_t;
+
+typedef struct {
+	frontEndEntity_t *		entities;
+	int						numEntities;
+	performanceCounters_t	pc;
+} frontEndEntityJob_t;
+
+typedef struct {
+	viewEntity_t *			vEntity;
+	idInteraction *			inter;
+	idScreenRect			shadowScissor;
+} frontEndInteraction_t;
+
+// the entities whose new dynamic models wait for R_EndDeferredSkinning, NULL when not skinning in parallel
+static idList<idRenderEntityLocal *> *	deferredDynamicModels = NULL;
+
+/*
+=================
+R_UseParallelFrontEnd
+=================
+*/
+static bool R_UseParallelFrontEnd( void ) {
+	return r_useParallelFrontEnd.GetBool() && parallelJobManager->GetNumWorkers() > 0;
+}
+
+/*
+=================
+R_FrontEndLightJob
+=================
+*/
+static void R_FrontEndLightJob( void *data ) {
+	frontEndLightJob_t *job = (frontEndLightJob_t *)data;
+
+	for ( int i = 0 ; i < job->numLights ; i++ ) {
+		job->scissorRects[i] = R_CalcLightScissorRectangle( job->vLights[i] );
+	}
+}
+
+/*
+=================
+R_CalcLightScissorRectangles
+
+Calculates the scissor rectangles of all view lights in parallel jobs.
+Returns an array in viewLights order, or NULL if the lights should be
+handled serially.
+=================
+*/
+static idScreenRect *R_CalcLightScissorRectangles( void ) {
+	if ( !r_useLightScissors.GetBool() || !R_UseParallelFrontEnd() ) {
+		return NULL;
+	}
+
+	int numLights = 0;
+	for ( viewLight_t *vLight = tr.viewDef->viewLights ; vLight ; vLight = vLight->next ) {
+		numLights++;
+	}
+	if ( numLights < 2 ) {
+		return NULL;
+	}
+
+	viewLight_t **vLights = (viewLight_t **)R_FrameAlloc( numLights * sizeof( vLights[0] ) );
+	idScreenRect *scissorRects = (idScreenRect *)R_FrameAlloc( numLights * sizeof( scissorRects[0] ) );
+
+	numLights = 0;
+	for ( viewLight_t *vLight = tr.viewDef->viewLights ; vLight ; vLight = vLight->next ) {
+		vLights[numLights++] = vLight;
+	}
+
+	int numJobs = ( numLights + FRONTEND_LIGHTS_PER_JOB - 1 ) / FRONTEND_LIGHTS_PER_JOB;
+	frontEndLightJob_t *jobs = (frontEndLightJob_t *)R_FrameAlloc( numJobs * sizeof( jobs[0] ) );
+
+	idParallelJobList jobList( "R_CalcLightScissorRectangles" );
+	for ( int i = 0 ; i < numJobs ; i++ ) {
+		int first = i * FRONTEND_LIGHTS_PER_JOB;
+		jobs[i].vLights = vLights + first;
+		jobs[i].scissorRects = scissorRects + first;
+		jobs[i].numLights = Min( FRONTEND_LIGHTS_PER_JOB, numLights - first );
+		jobList.AddJob( R_FrontEndLightJob, &jobs[i] );
+	}
+	jobList.Run();
+
+	return scissorRects;
+}
+
 /*
 =================
 R_AddLightSurfaces
@@ -820,10 +941,16 @@ void R_AddLightSurfaces( void ) {
 	viewLight_t		*vLight;
 	idRenderLightLocal *light;
 	viewLight_t		**ptr;
+	int				lightNum;
+
+	idProfileScope profile( "R_AddLightSurfaces" );
+
+	// the scissor rectangles are calculated up front in parallel jobs if possible
+	idScreenRect *scissorRects = R_CalcLightScissorRectangles();
 
 	// go through each visible light, possibly removing some from the list
 	ptr = &tr.viewDef->viewLights;
-	while ( *ptr ) {
+	for ( lightNum = 0 ; *ptr ; lightNum++ ) {
 		vLight = *ptr;
 		light = vLight->lightDef;
 
@@ -904,7 +1031,7 @@ void R_AddLightSurfaces( void ) {
 		if ( r_useLightScissors.GetBool() ) {
 			// calculate the screen area covered by the light frustum
 			// which will be used to crop the stencil cull
-			idScreenRect scissorRect = R_CalcLightScissorRectangle( vLight );
+			idScreenRect scissorRect = scissorRects ? scissorRects[lightNum] : R_CalcLightScissorRectangle( vLight );
 			// intersect with the portal crossing scissor rectangle
 			vLight->scissorRect.Intersect( scissorRect );
 
@@ -1039,24 +1166,41 @@ bool R_IssueEntityDefCallback( idRenderEntityLocal *def ) {
 
 /*
 ===================
-R_EntityDefDynamicModel
+R_FinishEntityDefDynamicModel
 
-Issues a deferred entity callback if necessary.
-If the model isn't dynamic, it returns the original.
-Returns the cached dynamic model if present, otherwise creates
-it and any necessary overlays
+Adds the overlays to a new snapshot of the dynamic model.
 ===================
 */
-idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
-	bool callbackUpdate;
-
-	// allow deferred entities to construct themselves
-	if ( def->parms.callback ) {
-		callbackUpdate = R_IssueEntityDefCallback( def );
+static void R_FinishEntityDefDynamicModel( idRenderEntityLocal *def ) {
+	// add any overlays to the snapshot of the dynamic model
+	if ( def->overlay && !r_skipOverlays.GetBool() ) {
+		def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
 	} else {
-		callbackUpdate = false;
+		idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
+	}
+
+	if ( r_checkBounds.GetBool() ) {
+		idBounds b = def->cachedDynamicModel->Bounds();
+		if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
+				b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
+				b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
+				b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
+				b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
+				b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
+			common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
+		}
 	}
+}
 
+/*
+===================
+R_InstantiateEntityDefDynamicModel
+
+The part of R_EntityDefDynamicModel after the callback, it never calls
+back into the game.
+===================
+*/
+static idRenderModel *R_InstantiateEntityDefDynamicModel( idRenderEntityLocal *def, bool callbackUpdate ) {
 	idRenderModel *model = def->parms.hModel;
 
 	if ( !model ) {
@@ -1080,24 +1224,11 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 		// instantiate the snapshot of the dynamic model, possibly reusing memory from the cached snapshot
 		def->cachedDynamicModel = model->InstantiateDynamicModel( &def->parms, tr.viewDef, def->cachedDynamicModel );
 		if ( def->cachedDynamicModel ) {
-
-			// add any overlays to the snapshot of the dynamic model
-			if ( def->overlay && !r_skipOverlays.GetBool() ) {
-				def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
+			if ( deferredDynamicModels ) {
+				// the vertexes aren't skinned yet
+				deferredDynamicModels->Append( def );
 			} else {
-				idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
-			}
-
-			if ( r_checkBounds.GetBool() ) {
-				idBounds b = def->cachedDynamicModel->Bounds();
-				if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
-						b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
-						b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
-						b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
-						b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
-						b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
-					common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
-				}
+				R_FinishEntityDefDynamicModel( def );
 			}
 		}
 
@@ -1120,6 +1251,29 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 	return def->dynamicModel;
 }
 
+/*
+===================
+R_EntityDefDynamicModel
+
+Issues a deferred entity callback if necessary.
+If the model isn't dynamic, it returns the original.
+Returns the cached dynamic model if present, otherwise creates
+it and any necessary overlays
+===================
+*/
+idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
+	bool callbackUpdate;
+
+	// allow deferred entities to construct themselves
+	if ( def->parms.callback ) {
+		callbackUpdate = R_IssueEntityDefCallback( def );
+	} else {
+		callbackUpdate = false;
+	}
+
+	return R_InstantiateEntityDefDynamicModel( def, callbackUpdate );
+}
+
 /*
 =================
 R_AddDrawSurf
@@ -1280,6 +1434,58 @@ void R_AddDrawSurf( const srfTriangles_t *tri, const viewEntity_t *space, const
 	// adds for this view
 }
 
+/*
+===============
+R_AddAmbientSurface
+
+Adds a single visible surface of the given viewEntity for drawing.
+Returns false if the vertex cache was too full to give us an ambient cache.
+===============
+*/
+static bool R_AddAmbientSurface( viewEntity_t *vEntity, const modelSurface_t *surf, const idMaterial *shader ) {
+	idRenderEntityLocal	*def = vEntity->entityDef;
+	srfTriangles_t		*tri = surf->geometry;
+
+	def->visibleCount = tr.viewCount;
+
+	// make sure we have an ambient cache
+	if ( !R_CreateAmbientCache( tri, shader->ReceivesLighting() ) ) {
+		// don't add anything if the vertex cache was too full to give us an ambient cache
+		return false;
+	}
+	// touch it so it won't get purged
+	vertexCache.Touch( tri->ambientCache );
+
+	if ( r_useIndexBuffers.GetBool() && !tri->indexCache ) {
+		vertexCache.Alloc( tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ), &tri->indexCache, true );
+	}
+	if ( tri->indexCache ) {
+		vertexCache.Touch( tri->indexCache );
+	}
+
+	// Soft Particles -- SteveL #3878
+	float particle_radius = -1.0f;		// Default = disallow softening, but allow modelDepthHack if specified in the decl.
+	if ( r_useSoftParticles.GetBool() && r_enableDepthCapture.GetInteger() != 0
+		&& !shader->ReceivesLighting()          // don't soften surfaces that are meant to be solid
+		&& tr.viewDef->renderView.viewID >= 0 ) // Skip during "invisible" rendering passes (e.g. lightgem)
+	{
+		const idRenderModelPrt* prt = dynamic_cast<const idRenderModelPrt*>( def->parms.hModel ); // yuck.
+		if ( prt )
+		{
+			particle_radius = prt->SofteningRadius( surf->id );
+		}
+	}
+
+	// add the surface for drawing
+	R_AddDrawSurf( tri, vEntity, &vEntity->entityDef->parms, shader, vEntity->scissorRect, particle_radius );
+
+	// ambientViewCount is used to allow light interactions to be rejected
+	// if the ambient surface isn't visible at all
+	tri->ambientViewCount = tr.viewCount;
+
+	return true;
+}
+
 /*
 ===============
 R_AddAmbientDrawsurfs
@@ -1360,43 +1566,89 @@ static void R_AddAmbientDrawsurfs( viewEntity_t *vEntity ) {
 		}
 
 		if ( !R_CullLocalBox( tri->bounds, vEntity->modelMatrix, 5, tr.viewDef->frustum ) ) {
-
-			def->visibleCount = tr.viewCount;
-
-			// make sure we have an ambient cache
-			if ( !R_CreateAmbientCache( tri, shader->ReceivesLighting() ) ) {
-				// don't add anything if the vertex cache was too full to give us an ambient cache
+			if ( !R_AddAmbientSurface( vEntity, surf, shader ) ) {
 				return;
 			}
-			// touch it so it won't get purged
-			vertexCache.Touch( tri->ambientCache );
+		}
+	}
 
-			if ( r_useIndexBuffers.GetBool() && !tri->indexCache ) {
-				vertexCache.Alloc( tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ), &tri->indexCache, true );
-			}
-			if ( tri->indexCache ) {
-				vertexCache.Touch( tri->indexCache );
-			}
+	// add the lightweight decal surfaces
+	for ( idRenderModelDecal *decal = def->decals; decal; decal = decal->Next() ) {
+		decal->AddDecalDrawSurf( vEntity );
+	}
+}
 
-			// Soft Particles -- SteveL #3878
-			float particle_radius = -1.0f;		// Default = disallow softening, but allow modelDepthHack if specified in the decl.
-			if ( r_useSoftParticles.GetBool() && r_enableDepthCapture.GetInteger() != 0
-				&& !shader->ReceivesLighting()          // don't soften surfaces that are meant to be solid
-				&& tr.viewDef->renderView.viewID >= 0 ) // Skip during "invisible" rendering passes (e.g. lightgem)
-			{
-				const idRenderModelPrt* prt = dynamic_cast<const idRenderModelPrt*>( def->parms.hModel ); // yuck.
-				if ( prt )
-				{
-					particle_radius = prt->SofteningRadius( surf->id );
-				}
-			}
+/*
+===============
+R_CullAmbientSurfaces
+
+Parallel version of the culling in R_AddAmbientDrawsurfs for static models.
+The global shader override and everything that allocates is left to
+R_AddCulledAmbientDrawsurfs on the main thread.
+===============
+*/
+static int R_CullAmbientSurfaces( const viewEntity_t *vEntity, const idRenderModel *model, frontEndSurf_t *surfs, performanceCounters_t *pc ) {
+	const idRenderEntityLocal *def = vEntity->entityDef;
+	int numSurfs = 0;
+
+	int total = model->NumSurfaces();
+	for ( int i = 0 ; i < total ; i++ ) {
+		const modelSurface_t	*surf = model->Surface( i );
+
+		// for debugging, only show a single surface at a time
+		if ( r_singleSurface.GetInteger() >= 0 && i != r_singleSurface.GetInteger() ) {
+			continue;
+		}
+
+		const srfTriangles_t *tri = surf->geometry;
+		if ( !tri || !tri->numIndexes ) {
+			continue;
+		}
+
+		#if MD5_ENABLE_GIBS > 1 // SKINS
+		const idMaterial *shader = R_RemapShaderBySkin(surf->shader, def->parms.customSkin, def->parms.customShader, model);
+		#else
+		const idMaterial *shader = R_RemapShaderBySkin(surf->shader, def->parms.customSkin, def->parms.customShader);
+		#endif
+
+		// the global override only replaces drawn shaders
+		if ( !shader || !shader->IsDrawn() ) {
+			continue;
+		}
+
+		if ( R_CullLocalBox( tri->bounds, vEntity->modelMatrix, 5, tr.viewDef->frustum, pc ) ) {
+			continue;
+		}
+
+		surfs[numSurfs].surf = surf;
+		surfs[numSurfs].shader = shader;
+		numSurfs++;
+	}
+
+	return numSurfs;
+}
+
+/*
+===============
+R_AddCulledAmbientDrawsurfs
+
+Adds the surfaces found by R_CullAmbientSurfaces
+===============
+*/
+static void R_AddCulledAmbientDrawsurfs( viewEntity_t *vEntity, const frontEndEntity_t *feEntity ) {
+	idRenderEntityLocal *def = vEntity->entityDef;
+
+	for ( int i = 0 ; i < feEntity->numSurfs ; i++ ) {
+		const idMaterial *shader = feEntity->surfs[i].shader;
+
+		R_GlobalShaderOverride( &shader );
 
-			// add the surface for drawing
-			R_AddDrawSurf( tri, vEntity, &vEntity->entityDef->parms, shader, vEntity->scissorRect, particle_radius );
+		if ( !shader || !shader->IsDrawn() ) {
+			continue;
+		}
 
-			// ambientViewCount is used to allow light interactions to be rejected
-			// if the ambient surface isn't visible at all
-			tri->ambientViewCount = tr.viewCount;
+		if ( !R_AddAmbientSurface( vEntity, feEntity->surfs[i].surf, shader ) ) {
+			return;
 		}
 	}
 
@@ -1420,6 +1672,257 @@ idScreenRect R_CalcEntityScissorRectangle( viewEntity_t *vEntity ) {
 	return R_ScreenRectFromViewFrustumBounds( bounds );
 }
 
+/*
+=================
+R_FrontEndEntityJob
+=================
+*/
+static void R_FrontEndEntityJob( void *data ) {
+	frontEndEntityJob_t *job = (frontEndEntityJob_t *)data;
+
+	for ( int i = 0 ; i < job->numEntities ; i++ ) {
+		frontEndEntity_t *feEntity = &job->entities[i];
+		viewEntity_t *vEntity = feEntity->vEntity;
+
+		if ( r_useEntityScissors.GetBool() ) {
+			// calculate the screen area covered by the entity
+			// and intersect with the portal crossing scissor rectangle
+			vEntity->scissorRect.Intersect( R_CalcEntityScissorRectangle( vEntity ) );
+		}
+
+		// only entities with a visible rectangle add ambient surfaces
+		if ( feEntity->surfs && !vEntity->scissorRect.IsEmpty() ) {
+			feEntity->numSurfs = R_CullAmbientSurfaces( vEntity, feEntity->model, feEntity->surfs, &job->pc );
+		}
+	}
+}
+
+/*
+=================
+R_CullViewEntities
+
+Calculates the entity scissor rectangles and culls the surfaces of static
+models in parallel jobs. Returns an array in viewEntitys order, or NULL if
+the entities should be handled serially.
+=================
+*/
+static frontEndEntity_t *R_CullViewEntities( void ) {
+	if ( !R_UseParallelFrontEnd() ) {
+		return NULL;
+	}
+
+	int numEntities = 0;
+	for ( viewEntity_t *vEntity = tr.viewDef->viewEntitys ; vEntity ; vEntity = vEntity->next ) {
+		numEntities++;
+	}
+	if ( numEntities < 2 ) {
+		return NULL;
+	}
+
+	frontEndEntity_t *entities = (frontEndEntity_t *)R_FrameAlloc( numEntities * sizeof( entities[0] ) );
+
+	// the surface lists are allocated here, the jobs can't use the frame allocator
+	numEntities = 0;
+	for ( viewEntity_t *vEntity = tr.viewDef->viewEntitys ; vEntity ; vEntity = vEntity->next ) {
+		frontEndEntity_t *feEntity = &entities[numEntities++];
+		const idRenderEntityLocal *def = vEntity->entityDef;
+		const idRenderModel *model = def->parms.hModel;
+
+		feEntity->vEntity = vEntity;
+		feEntity->model = model;
+		feEntity->surfs = NULL;
+		feEntity->numSurfs = 0;
+
+		// dynamic models and models changed by callbacks are only known after R_EntityDefDynamicModel,
+		// and bounds checking prints, so these are culled on the main thread
+		if ( def->parms.callback || !model || model->IsDynamicModel() != DM_STATIC || model->NumSurfaces() <= 0 || r_checkBounds.GetBool() ) {
+			continue;
+		}
+		feEntity->surfs = (frontEndSurf_t *)R_FrameAlloc( model->NumSurfaces() * sizeof( feEntity->surfs[0] ) );
+	}
+
+	int numJobs = ( numEntities + FRONTEND_ENTITIES_PER_JOB - 1 ) / FRONTEND_ENTITIES_PER_JOB;
+	frontEndEntityJob_t *jobs = (frontEndEntityJob_t *)R_FrameAlloc( numJobs * sizeof( jobs[0] ) );
+
+	idParallelJobList jobList( "R_CullViewEntities" );
+	for ( int i = 0 ; i < numJobs ; i++ ) {
+		int first = i * FRONTEND_ENTITIES_PER_JOB;
+		jobs[i].entities = entities + first;
+		jobs[i].numEntities = Min( FRONTEND_ENTITIES_PER_JOB, numEntities - first );
+		memset( &jobs[i].pc, 0, sizeof( jobs[i].pc ) );
+		jobList.AddJob( R_FrontEndEntityJob, &jobs[i] );
+	}
+	jobList.Run();
+
+	for ( int i = 0 ; i < numJobs ; i++ ) {
+		tr.pc.c_box_cull_in += jobs[i].pc.c_box_cull_in;
+		tr.pc.c_box_cull_out += jobs[i].pc.c_box_cull_out;
+	}
+
+	return entities;
+}
+
+/*
+=================
+R_AddFrontEndInteraction
+=================
+*/
+static void R_AddFrontEndInteraction( idList<frontEndInteraction_t> &list, viewEntity_t *vEntity, idInteraction *inter, const idScreenRect &shadowScissor ) {
+	frontEndInteraction_t &fe = list.Alloc();
+	fe.vEntity = vEntity;
+	fe.inter = inter;
+	fe.shadowScissor = shadowScissor;
+}
+
+/*
+=================
+R_LinkFrontEndInteractions
+
+Links the interactions prepared during the walk over the viewEntitys,
+in the same order AddActiveInteraction would have linked them
+=================
+*/
+static void R_LinkFrontEndInteractions( const idList<frontEndInteraction_t> &list ) {
+	int i = 0;
+	while ( i < list.Num() ) {
+		viewEntity_t *vEntity = list[i].vEntity;
+
+		float oldFloatTime = 0.0f;
+		int oldTime = 0;
+
+		// the light shader registers are evaluated in the entity's time group
+		game->SelectTimeGroup( vEntity->entityDef->parms.timeGroup );
+
+		if ( vEntity->entityDef->parms.timeGroup ) {
+			oldFloatTime = tr.viewDef->floatTime;
+			oldTime = tr.viewDef->renderView.time;
+
+			tr.viewDef->floatTime = game->GetTimeGroupTime( vEntity->entityDef->parms.timeGroup ) * 0.001;
+			tr.viewDef->renderView.time = game->GetTimeGroupTime( vEntity->entityDef->parms.timeGroup );
+		}
+
+		for ( ; i < list.Num() && list[i].vEntity == vEntity; i++ ) {
+			list[i].inter->LinkActiveInteraction( list[i].shadowScissor );
+		}
+
+		if ( vEntity->entityDef->parms.timeGroup ) {
+			tr.viewDef->floatTime = oldFloatTime;
+			tr.viewDef->renderView.time = oldTime;
+		}
+	}
+}
+
+/*
+=================
+R_SelectEntityDefTimeGroup
+
+Switches the view time to the time group of the entity, returns the view
+time to put back with R_RestoreEntityDefTimeGroup.
+=================
+*/
+static void R_SelectEntityDefTimeGroup( const idRenderEntityLocal *def, float &oldFloatTime, int &oldTime ) {
+	game->SelectTimeGroup( def->parms.timeGroup );
+
+	if ( def->parms.timeGroup ) {
+		oldFloatTime = tr.viewDef->floatTime;
+		oldTime = tr.viewDef->renderView.time;
+
+		tr.viewDef->floatTime = game->GetTimeGroupTime( def->parms.timeGroup ) * 0.001;
+		tr.viewDef->renderView.time = game->GetTimeGroupTime( def->parms.timeGroup );
+	}
+}
+
+/*
+=================
+R_RestoreEntityDefTimeGroup
+=================
+*/
+static void R_RestoreEntityDefTimeGroup( const idRenderEntityLocal *def, float oldFloatTime, int oldTime ) {
+	if ( def->parms.timeGroup ) {
+		tr.viewDef->floatTime = oldFloatTime;
+		tr.viewDef->renderView.time = oldTime;
+	}
+}
+
+/*
+=================
+R_InstantiateViewDynamicModels
+
+Instantiates the dynamic models of all visible md5 entities up front and
+skins them together in parallel jobs, instead of one at a time when
+R_AddModelSurfaces reaches them.  The entity callbacks are still issued
+here on the main thread, only the vertex transforms are run in jobs.
+
+All callbacks are issued before the first model is instantiated.  A
+callback may update other entity defs, which would clear or reinstantiate
+a model whose skin job is already queued.
+=================
+*/
+static void R_InstantiateViewDynamicModels( void ) {
+	if ( !R_UseParallelFrontEnd() || !r_useDeferredTangents.GetBool() ) {
+		return;
+	}
+
+	idList<idRenderEntityLocal *> candidates;
+	candidates.SetGranularity( 64 );
+
+	for ( viewEntity_t *vEntity = tr.viewDef->viewEntitys ; vEntity ; vEntity = vEntity->next ) {
+		idRenderEntityLocal *def = vEntity->entityDef;
+
+		// only the ambient surfaces of visible entities instantiate the model in R_AddModelSurfaces
+		if ( vEntity->scissorRect.IsEmpty() || def->dynamicModel ) {
+			continue;
+		}
+		if ( dynamic_cast<const idRenderModelMD5 *>( def->parms.hModel ) == NULL ) {
+			continue;
+		}
+		if ( tr.viewDef->isXraySubview ? ( def->parms.xrayIndex == 1 ) : ( def->parms.xrayIndex == 2 ) ) {
+			continue;
+		}
+		candidates.Append( def );
+	}
+
+	float oldFloatTime = 0.0f;
+	int oldTime = 0;
+
+	// the callbacks may animate the entities in their time groups
+	for ( int i = 0 ; i < candidates.Num() ; i++ ) {
+		idRenderEntityLocal *def = candidates[i];
+
+		if ( !def->parms.callback ) {
+			continue;
+		}
+
+		R_SelectEntityDefTimeGroup( def, oldFloatTime, oldTime );
+		if ( R_IssueEntityDefCallback( def ) ) {
+			R_ClearEntityDefDynamicModel( def );
+		}
+		R_RestoreEntityDefTimeGroup( def, oldFloatTime, oldTime );
+	}
+
+	idList<idRenderEntityLocal *> defs;
+	defs.SetGranularity( 64 );
+
+	deferredDynamicModels = &defs;
+	R_BeginDeferredSkinning();
+
+	for ( int i = 0 ; i < candidates.Num() ; i++ ) {
+		idRenderEntityLocal *def = candidates[i];
+
+		R_SelectEntityDefTimeGroup( def, oldFloatTime, oldTime );
+		R_InstantiateEntityDefDynamicModel( def, false );
+		R_RestoreEntityDefTimeGroup( def, oldFloatTime, oldTime );
+	}
+
+	R_EndDeferredSkinning();
+	deferredDynamicModels = NULL;
+
+	// the overlays are placed on the skinned vertexes
+	for ( int i = 0 ; i < defs.Num() ; i++ ) {
+		R_FinishEntityDefDynamicModel( defs[i] );
+	}
+}
+
 /*
 ===================
 R_AddModelSurfaces
@@ -1435,20 +1938,39 @@ void R_AddModelSurfaces( void ) {
 	viewEntity_t		*vEntity;
 	idInteraction		*inter, *next;
 	idRenderModel		*model;
+	int					entityNum;
+	idScreenRect		shadowScissor;
+
+	idProfileScope profile( "R_AddModelSurfaces" );
 
 	// clear the ambient surface list
 	tr.viewDef->numDrawSurfs = 0;
 	tr.viewDef->maxDrawSurfs = 0;	// will be set to INITIAL_DRAWSURFS on R_AddDrawSurf
 
+	// the scissor rectangles and static surface culling are done up front in parallel jobs if possible
+	frontEndEntity_t *feEntities = R_CullViewEntities();
+
+	// skin the visible md5 models in parallel jobs before they are needed
+	R_InstantiateViewDynamicModels();
+
+	// with parallel jobs, the shadow volumes of new interactions are built together
+	// after all entities have been walked, and the interactions are linked after that
+	const bool deferShadows = R_UseParallelFrontEnd();
+	idList<frontEndInteraction_t> activeInteractions;
+	activeInteractions.SetGranularity( 256 );
+
 	// go through each entity that is either visible to the view, or to
 	// any light that intersects the view (for shadows)
-	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
+	for ( vEntity = tr.viewDef->viewEntitys, entityNum = 0; vEntity; vEntity = vEntity->next, entityNum++ ) {
+		const frontEndEntity_t *feEntity = feEntities ? &feEntities[entityNum] : NULL;
 
 		if ( r_useEntityScissors.GetBool() ) {
-			// calculate the screen area covered by the entity
-			idScreenRect scissorRect = R_CalcEntityScissorRectangle( vEntity );
-			// intersect with the portal crossing scissor rectangle
-			vEntity->scissorRect.Intersect( scissorRect );
+			if ( !feEntity ) {
+				// calculate the screen area covered by the entity
+				idScreenRect scissorRect = R_CalcEntityScissorRectangle( vEntity );
+				// intersect with the portal crossing scissor rectangle
+				vEntity->scissorRect.Intersect( scissorRect );
+			}
 
 			if ( r_showEntityScissors.GetBool() ) {
 				R_ShowColoredScreenRect( vEntity->scissorRect, vEntity->entityDef->index );
@@ -1501,7 +2023,11 @@ void R_AddModelSurfaces( void ) {
 				continue;
 			}
 
-			R_AddAmbientDrawsurfs( vEntity );
+			if ( feEntity && feEntity->surfs && feEntity->model == model ) {
+				R_AddCulledAmbientDrawsurfs( vEntity, feEntity );
+			} else {
+				R_AddAmbientDrawsurfs( vEntity );
+			}
 			tr.pc.c_visibleViewEntities++;
 		} else {
 			tr.pc.c_shadowViewEntities++;
@@ -1517,7 +2043,13 @@ void R_AddModelSurfaces( void ) {
 					if ( inter->lightDef->viewCount != tr.viewCount ) {
 						continue;
 					}
-					inter->AddActiveInteraction();
+					if ( deferShadows ) {
+						if ( inter->PrepareActiveInteraction( shadowScissor, true ) ) {
+							R_AddFrontEndInteraction( activeInteractions, vEntity, inter, shadowScissor );
+						}
+					} else {
+						inter->AddActiveInteraction();
+					}
 				}
 			}
 		} else {
@@ -1532,7 +2064,13 @@ void R_AddModelSurfaces( void ) {
 				if ( inter->lightDef->viewCount != tr.viewCount ) {
 					continue;
 				}
-				inter->AddActiveInteraction();
+				if ( deferShadows ) {
+					if ( inter->PrepareActiveInteraction( shadowScissor, true ) ) {
+						R_AddFrontEndInteraction( activeInteractions, vEntity, inter, shadowScissor );
+					}
+				} else {
+					inter->AddActiveInteraction();
+				}
 			}
 		}
 
@@ -1542,6 +2080,13 @@ void R_AddModelSurfaces( void ) {
 		}
 
 	}
+
+	if ( deferShadows ) {
+		// build all queued shadow volumes before any of the interactions is used
+		R_CreatePendingInteractionShadows();
+
+		R_LinkFrontEndInteractions( activeInteractions );
+	}
 }
 
 /*
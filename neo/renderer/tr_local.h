@@ -153,6 +153,7 @@ typedef struct areaReference_s {
 	idRenderEntityLocal *	entity;					// only one of entity / light will be non-NULL
 	idRenderLightLocal *	light;					// only one of entity / light will be non-NULL
 	struct portalArea_s	*	area;					// so owners can find all the areas they are in
+	int						treeNode;				// leaf in the entityTree or lightTree of the area
 } areaReference_t;
 
 
@@ -212,6 +213,8 @@ public:
 	int						lastModifiedFrameNum;	// to determine if it is constantly changing,
 													// and should go in the dynamic frame memory, or kept
 													// in the cached memory
+	int						lastMovedFrameNum;		// last frame the origin or axis changed, the turbo shadow
+													// cache skips lights and entities that keep moving
 	bool					archived;				// for demo writing
 
 
@@ -266,6 +269,8 @@ public:
 	int						lastModifiedFrameNum;	// to determine if it is constantly changing,
 													// and should go in the dynamic frame memory, or kept
 													// in the cached memory
+	int						lastMovedFrameNum;		// last frame the origin or axis changed, the turbo shadow
+													// cache skips lights and entities that keep moving
 	bool					archived;				// for demo writing
 
 	idRenderModel *			dynamicModel;			// if parms.model->IsDynamicModel(), this is the generated data
@@ -598,6 +603,7 @@ typedef struct {
 	int		c_tangentIndexes;	// R_DeriveTangents()
 	int		c_entityUpdates, c_lightUpdates, c_entityReferences, c_lightReferences;
 	int		c_guiSurfs;
+	int		c_drawSurfs;		// ambient drawSurfs added by all views
 	int		frontEndMsec;		// sum of time in all RE_RenderScene's in a frame
 } performanceCounters_t;
 
@@ -857,19 +863,25 @@ extern idCVar r_useLightCulling;		// 0 = none, 1 = box, 2 = exact clip of polyhe
 extern idCVar r_useLightScissors;		// 1 = use custom scissor rectangle for each light
 extern idCVar r_useClippedLightScissors;// 0 = full screen when near clipped, 1 = exact when near clipped, 2 = exact always
 extern idCVar r_useEntityCulling;		// 0 = none, 1 = box
+extern idCVar r_useAreaRefTree;			// cull the refs of large areas with the area bounds trees
 extern idCVar r_useEntityScissors;		// 1 = use custom scissor rectangle for each entity
 extern idCVar r_useInteractionCulling;	// 1 = cull interactions
 extern idCVar r_useInteractionScissors;	// 1 = use a custom scissor rectangle for each interaction
 extern idCVar r_useFrustumFarDistance;	// if != 0 force the view frustum far distance to this distance
 extern idCVar r_useShadowCulling;		// try to cull shadows from partially visible lights
+extern idCVar r_useParallelFrontEnd;	// flood portals, skin md5 models, calculate scissor rectangles and cull static surfaces in parallel jobs
 extern idCVar r_usePreciseTriangleInteractions;	// 1 = do winding clipping to determine if each ambiguous tri should be lit
 extern idCVar r_useTurboShadow;			// 1 = use the infinite projection with W technique for dynamic shadows
+extern idCVar r_useTurboShadowCache;	// 1 = reuse the turbo shadow volumes of static models when interactions are re-created
+extern idCVar r_turboShadowCacheMegs;	// size limit of the turbo shadow cache
 extern idCVar r_useExternalShadows;		// 1 = skip drawing caps when outside the light volume
 extern idCVar r_useOptimizedShadows;	// 1 = use the dmap generated static shadow volumes
 extern idCVar r_useShadowVertexProgram;	// 1 = do the shadow projection in the vertex program on capable cards
 extern idCVar r_useShadowProjectedCull;	// 1 = discard triangles outside light volume before shadowing
 extern idCVar r_useDeferredTangents;	// 1 = don't always calc tangents after deform
 extern idCVar r_useCachedDynamicModels;	// 1 = cache snapshots of dynamic models
+extern idCVar r_useMD5SkinCache;		// 1 = reuse the transformed vertexes of identical md5 poses
+extern idCVar r_md5SkinCacheMegs;		// memory budget of the md5 skin cache
 extern idCVar r_useTwoSidedStencil;		// 1 = do stencil shadows in one pass with different ops on each side
 extern idCVar r_useInfiniteFarZ;		// 1 = use the no-far-clip-plane trick
 extern idCVar r_useScissor;				// 1 = scissor clip as portals and lights are processed
@@ -1150,9 +1162,9 @@ MAIN
 void R_RenderView( viewDef_t *parms );
 
 // performs radius cull first, then corner cull
-bool R_CullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes );
+bool R_CullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes, performanceCounters_t *pc = NULL );
 bool R_RadiusCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes );
-bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes );
+bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes, performanceCounters_t *pc = NULL );
 
 void R_AxisToModelMatrix( const idMat3 &axis, const idVec3 &origin, float modelMatrix[16] );
 
@@ -1445,6 +1457,29 @@ srfTriangles_t *R_CreateTurboShadowVolume( const idRenderEntityLocal *ent,
 									 const srfTriangles_t *tri, const idRenderLightLocal *light,
 									 srfCullInfo_t &cullInfo );
 
+// turbo shadow volume creation split up so the building can run in a parallel job
+typedef struct {
+	const idRenderEntityLocal *	ent;
+	const srfTriangles_t *		tri;
+	const idRenderLightLocal *	light;
+	srfCullInfo_t *				cullInfo;
+	bool						vertexProgram;
+	bool						projectedCull;
+	byte *						facing;				// preallocated for R_CalcInteractionFacing
+	byte *						cullBits;			// preallocated for R_CalcInteractionCullBits
+	srfTriangles_t *			newTri;				// allocated for the maximum size
+	int							numShadowingFaces;
+} turboShadowVolume_t;
+
+bool R_AllocTurboShadowVolume( turboShadowVolume_t &sv, const idRenderEntityLocal *ent, const srfTriangles_t *tri,
+									 const idRenderLightLocal *light, shadowGen_t optimize, srfCullInfo_t &cullInfo );
+void R_BuildTurboShadowVolume( turboShadowVolume_t &sv );
+srfTriangles_t *R_FinishTurboShadowVolume( turboShadowVolume_t &sv );
+
+// cache of the turbo shadow volumes of static model surfaces
+void R_PurgeTurboShadowCache( const srfTriangles_t *tri );
+void R_PrintTurboShadowCacheStats( void );
+
 /*
 ============================================================
 
@@ -1518,6 +1553,10 @@ void				R_DeriveFacePlanes( srfTriangles_t *tri );		// also called by renderbump
 void				R_CleanupTriangles( srfTriangles_t *tri, bool createNormals, bool identifySilEdges, bool useUnsmoothedTangents, bool useMikktspace = false ); // RBMIKKT_TANGENT
 void				R_ReverseTriangles( srfTriangles_t *tri );
 
+// the model cache stores surfaces after R_CleanupTriangles, with all their derived data
+void				R_WriteStaticTriSurf( idFile *f, const srfTriangles_t *tri );
+srfTriangles_t *	R_ReadStaticTriSurf( idFile *f );
+
 // Only deals with vertexes and indexes, not silhouettes, planes, etc.
 // Does NOT perform a cleanup triangles, so there may be duplicated verts in the result.
 srfTriangles_t *	R_MergeSurfaceList( const srfTriangles_t **surfaces, int numSurfaces );
@@ -1526,6 +1565,7 @@ srfTriangles_t *	R_MergeTriangles( const srfTriangles_t *tri1, const srfTriangle
 // if the deformed verts have significant enough texture coordinate changes to reverse the texture
 // polarity of a triangle, the tangents will be incorrect
 void				R_DeriveTangents( srfTriangles_t *tri, bool allocFacePlanes = true );
+void				R_BenchmarkTangents_f( const idCmdArgs &args );
 
 // deformable meshes precalculate as much as possible from a base frame, then generate
 // complete srfTriangles_t from just a new set of vertexes
@@ -1737,6 +1777,7 @@ void R_DoneFreeType();
 
 //=============================================
 
+#include "AreaRefTree.h"
 #include "RenderWorld_local.h"
 #include "GuiModel.h"
 #include "VertexCache.h"
@@ -183,6 +183,10 @@ R_ToggleSmpFrame
 ====================
 */
 void R_ToggleSmpFrame( void ) {
+	// queued interaction shadows live in frame memory, normally
+	// there are none left unless a view was aborted by an error
+	R_CreatePendingInteractionShadows();
+
 	R_FreeDeferredTriSurfs( frameData );
 
 	// clear frame-temporary data
@@ -618,9 +622,10 @@ R_CornerCullLocalBox
 Tests all corners against the frustum.
 Can still generate a few false positives when the box is outside a corner.
 Returns true if the box is outside the given global frustum, (positive sides are out)
+The cull counts go to pc if given, so parallel jobs don't have to touch tr.pc
 =================
 */
-bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes ) {
+bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes, performanceCounters_t *pc ) {
 	int			i, j;
 	idVec3		transformed[8];
 	float		dists[8];
@@ -632,6 +637,10 @@ bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16],
 		return false;
 	}
 
+	if ( !pc ) {
+		pc = &tr.pc;
+	}
+
 	// transform into world space
 	for ( i = 0 ; i < 8 ; i++ ) {
 		v[0] = bounds[i&1][0];
@@ -652,12 +661,12 @@ bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16],
 		}
 		if ( j == 8 ) {
 			// all points were behind one of the planes
-			tr.pc.c_box_cull_out++;
+			pc->c_box_cull_out++;
 			return true;
 		}
 	}
 
-	tr.pc.c_box_cull_in++;
+	pc->c_box_cull_in++;
 
 	return false;		// not culled
 }
@@ -670,11 +679,11 @@ Performs quick test before expensive test
 Returns true if the box is outside the given global frustum, (positive sides are out)
 =================
 */
-bool R_CullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes ) {
+bool R_CullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes, performanceCounters_t *pc ) {
 	if ( R_RadiusCullLocalBox( bounds, modelMatrix, numPlanes, planes ) ) {
 		return true;
 	}
-	return R_CornerCullLocalBox( bounds, modelMatrix, numPlanes, planes );
+	return R_CornerCullLocalBox( bounds, modelMatrix, numPlanes, planes, pc );
 }
 
 /*
@@ -1041,35 +1050,96 @@ DRAWSURF SORTING
 
 /*
 =======================
-R_QsortSurfaces
+R_DrawSurfSortKey
 
+Maps the float sort value to an unsigned value with the same ordering,
+negative sorts included, and puts it above the index of the surface.
 =======================
 */
-static int R_QsortSurfaces( const void *a, const void *b ) {
-	const drawSurf_t	*ea, *eb;
-
-	ea = *(drawSurf_t **)a;
-	eb = *(drawSurf_t **)b;
-
-	if ( ea->sort < eb->sort ) {
-		return -1;
-	}
-	if ( ea->sort > eb->sort ) {
-		return 1;
+static ID_INLINE uint64_t R_DrawSurfSortKey( const float sort, const int index ) {
+	union {
+		float		f;
+		uint32_t	u;
+	} bits;
+
+	bits.f = sort;
+	if ( bits.u & 0x80000000u ) {
+		bits.u = ~bits.u;
+	} else {
+		bits.u |= 0x80000000u;
 	}
-	return 0;
+	return ( (uint64_t)bits.u << 32 ) | (uint32_t)index;
 }
 
-
 /*
 =================
 R_SortDrawSurfs
+
+Sorts the drawsurfs by sort type, then orientation, then shader.
+
+The sort values are pulled into a separate array of 64 bit keys with
+the surface index in the low bits, so the sort never touches the
+drawSurfs themselves.  The keys are radix sorted on the sort value one
+byte at a time.  Each pass is stable, so surfaces with equal sort values
+keep the order they were added in, which the small sortOffset bumps
+can't guarantee once float precision runs out.  Passes where every key
+has the same byte are skipped, which with the few distinct material
+sorts in a view is most of them.
 =================
 */
 static void R_SortDrawSurfs( void ) {
-	// sort the drawsurfs by sort type, then orientation, then shader
-	qsort( tr.viewDef->drawSurfs, tr.viewDef->numDrawSurfs, sizeof( tr.viewDef->drawSurfs[0] ),
-		R_QsortSurfaces );
+	const int numDrawSurfs = tr.viewDef->numDrawSurfs;
+
+	if ( numDrawSurfs < 2 ) {
+		return;
+	}
+
+	drawSurf_t **drawSurfs = tr.viewDef->drawSurfs;
+	uint64_t *keys = (uint64_t *)R_FrameAlloc( numDrawSurfs * sizeof( keys[0] ) );
+	uint64_t *swap = (uint64_t *)R_FrameAlloc( numDrawSurfs * sizeof( swap[0] ) );
+	int counts[4][256];
+
+	memset( counts, 0, sizeof( counts ) );
+	for ( int i = 0 ; i < numDrawSurfs ; i++ ) {
+		const uint64_t key = R_DrawSurfSortKey( drawSurfs[i]->sort, i );
+		keys[i] = key;
+		counts[0][ ( key >> 32 ) & 255 ]++;
+		counts[1][ ( key >> 40 ) & 255 ]++;
+		counts[2][ ( key >> 48 ) & 255 ]++;
+		counts[3][ ( key >> 56 ) & 255 ]++;
+	}
+
+	for ( int pass = 0 ; pass < 4 ; pass++ ) {
+		const int shift = 32 + pass * 8;
+		int *count = counts[pass];
+
+		if ( count[ ( keys[0] >> shift ) & 255 ] == numDrawSurfs ) {
+			continue;
+		}
+
+		// turn the counts into the first output slot of each byte value
+		int offset = 0;
+		for ( int i = 0 ; i < 256 ; i++ ) {
+			const int c = count[i];
+			count[i] = offset;
+			offset += c;
+		}
+
+		for ( int i = 0 ; i < numDrawSurfs ; i++ ) {
+			swap[ count[ ( keys[i] >> shift ) & 255 ]++ ] = keys[i];
+		}
+
+		uint64_t *temp = keys;
+		keys = swap;
+		swap = temp;
+	}
+
+	// the drawSurfs were only read to build the keys, so swap can hold the old order
+	drawSurf_t **unsorted = (drawSurf_t **)swap;
+	memcpy( unsorted, drawSurfs, numDrawSurfs * sizeof( drawSurfs[0] ) );
+	for ( int i = 0 ; i < numDrawSurfs ; i++ ) {
+		drawSurfs[i] = unsorted[ (uint32_t)keys[i] ];
+	}
 }
 
 
@@ -1098,6 +1168,8 @@ void R_RenderView( viewDef_t *parms ) {
 		return;
 	}
 
+	idProfileScope profile( "R_RenderView" );
+
 	tr.viewCount++;
 
 	// save view in case we are a subview
@@ -1140,6 +1212,8 @@ void R_RenderView( viewDef_t *parms ) {
 	// sort all the ambient surfaces for translucency ordering
 	R_SortDrawSurfs();
 
+	tr.pc.c_drawSurfs += tr.viewDef->numDrawSurfs;
+
 	// generate any subviews (mirrors, cameras, etc) before adding this view
 	if ( R_GenerateSubViews() ) {
 		// if we are debugging subviews, allow the skipping of the
@@ -751,8 +751,6 @@ Also inits the remap[] array to all -1
 static void R_CalcPointCull( const srfTriangles_t *tri, const idPlane frustum[6], unsigned short *pointCull ) {
 	int i;
 	int frontBits;
-	float *planeSide;
-	byte *side1, *side2;
 
 	SIMDProcessor->Memset( remap, -1, tri->numVerts * sizeof( remap[0] ) );
 
@@ -763,35 +761,16 @@ static void R_CalcPointCull( const srfTriangles_t *tri, const idPlane frustum[6]
 		}
 	}
 
-	// initialize point cull
-	for ( i = 0; i < tri->numVerts; i++ ) {
-		pointCull[i] = frontBits;
-	}
-
-	// if the surface is not completely inside the light frustum
+	// if the surface is completely inside the light frustum
 	if ( frontBits == ( ( ( 1 << 6 ) - 1 ) ) << 6 ) {
+		for ( i = 0; i < tri->numVerts; i++ ) {
+			pointCull[i] = frontBits;
+		}
 		return;
 	}
 
-	planeSide = (float *) _alloca16( tri->numVerts * sizeof( float ) );
-	side1 = (byte *) _alloca16( tri->numVerts * sizeof( byte ) );
-	side2 = (byte *) _alloca16( tri->numVerts * sizeof( byte ) );
-	SIMDProcessor->Memset( side1, 0, tri->numVerts * sizeof( byte ) );
-	SIMDProcessor->Memset( side2, 0, tri->numVerts * sizeof( byte ) );
-
-	for ( i = 0; i < 6; i++ ) {
-
-		if ( frontBits & (1<<(i+6)) ) {
-			continue;
-		}
-
-		SIMDProcessor->Dot( planeSide, frustum[i], tri->verts, tri->numVerts );
-		SIMDProcessor->CmpLT( side1, i, planeSide, LIGHT_CLIP_EPSILON, tri->numVerts );
-		SIMDProcessor->CmpGT( side2, i, planeSide, -LIGHT_CLIP_EPSILON, tri->numVerts );
-	}
-	for ( i = 0; i < tri->numVerts; i++ ) {
-		pointCull[i] |= side1[i] | (side2[i] << 6);
-	}
+	// classify against all remaining planes in a single pass over the verts
+	SIMDProcessor->ShadowPointCull( pointCull, frontBits, LIGHT_CLIP_EPSILON, frustum, tri->verts, tri->numVerts );
 }
 
 /*
@@ -216,6 +216,7 @@ R_ShutdownTriSurfData
 ===============
 */
 void R_ShutdownTriSurfData( void ) {
+	R_PurgeTurboShadowCache( NULL );
 	R_StaticFree( silEdges );
 	silEdgeHash.Free();
 	srfTrianglesAllocator.Shutdown();
@@ -308,6 +309,8 @@ void R_ShowTriSurfMemory_f( const idCmdArgs &args ) {
 			triDominantTrisAllocator.GetBaseBlockMemory() +
 			triMirroredVertAllocator.GetBaseBlockMemory() +
 			triDupVertAllocator.GetBaseBlockMemory() ) >> 10 );
+
+	R_PrintTurboShadowCacheStats();
 }
 
 /*
@@ -406,6 +409,9 @@ void R_ReallyFreeStaticTriSurf( srfTriangles_t *tri ) {
 		return;
 	}
 
+	// a new surface at this address must not get the cached shadows of this one
+	R_PurgeTurboShadowCache( tri );
+
 	R_FreeStaticTriSurfVertexCaches( tri );
 
 	if ( tri->verts != NULL ) {
@@ -2227,6 +2233,343 @@ void R_CleanupTriangles( srfTriangles_t *tri, bool createNormals, bool identifyS
 	}
 }
 
+/*
+=================
+R_WriteStaticTriSurf
+
+Writes a cleaned up surface with all the data derived by R_CleanupTriangles,
+so R_ReadStaticTriSurf can restore it without running the cleanup again.
+The arrays are written as they are in memory, the reader checks the element
+sizes but the cache is not portable between byte orders.
+=================
+*/
+void R_WriteStaticTriSurf( idFile *f, const srfTriangles_t *tri ) {
+	f->WriteVec3( tri->bounds[0] );
+	f->WriteVec3( tri->bounds[1] );
+
+	f->WriteBool( tri->generateNormals );
+	f->WriteBool( tri->tangentsCalculated );
+	f->WriteBool( tri->facePlanesCalculated );
+	f->WriteBool( tri->perfectHull );
+
+	f->WriteInt( tri->numVerts );
+	f->WriteInt( tri->numIndexes );
+	f->WriteInt( tri->numMirroredVerts );
+	f->WriteInt( tri->numDupVerts );
+	f->WriteInt( tri->numSilEdges );
+	f->WriteBool( tri->silIndexes != NULL );
+	f->WriteBool( tri->facePlanes != NULL );
+	f->WriteBool( tri->dominantTris != NULL );
+
+	f->Write( tri->verts, tri->numVerts * sizeof( tri->verts[0] ) );
+	f->Write( tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) );
+	if ( tri->silIndexes ) {
+		f->Write( tri->silIndexes, tri->numIndexes * sizeof( tri->silIndexes[0] ) );
+	}
+	if ( tri->numMirroredVerts ) {
+		f->Write( tri->mirroredVerts, tri->numMirroredVerts * sizeof( tri->mirroredVerts[0] ) );
+	}
+	if ( tri->numDupVerts ) {
+		f->Write( tri->dupVerts, tri->numDupVerts * 2 * sizeof( tri->dupVerts[0] ) );
+	}
+	if ( tri->numSilEdges ) {
+		f->Write( tri->silEdges, tri->numSilEdges * sizeof( tri->silEdges[0] ) );
+	}
+	if ( tri->facePlanes ) {
+		f->Write( tri->facePlanes, ( tri->numIndexes / 3 ) * sizeof( tri->facePlanes[0] ) );
+	}
+	if ( tri->dominantTris ) {
+		f->Write( tri->dominantTris, tri->numVerts * sizeof( tri->dominantTris[0] ) );
+	}
+}
+
+/*
+=================
+R_IndexesInRange
+
+For the glIndex_t and int index arrays of a surface.
+=================
+*/
+template< class type >
+static bool R_IndexesInRange( const type *indexes, int numIndexes, int max ) {
+	for ( int i = 0 ; i < numIndexes ; i++ ) {
+		if ( indexes[i] < 0 || indexes[i] >= max ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+=================
+R_ReadStaticTriSurf
+
+Returns NULL if the file is truncated or the counts don't make sense.
+=================
+*/
+srfTriangles_t *R_ReadStaticTriSurf( idFile *f ) {
+	srfTriangles_t	*tri;
+	bool			hasSilIndexes, hasFacePlanes, hasDominantTris;
+	int				ok;
+
+	tri = R_AllocStaticTriSurf();
+
+	f->ReadVec3( tri->bounds[0] );
+	f->ReadVec3( tri->bounds[1] );
+
+	f->ReadBool( tri->generateNormals );
+	f->ReadBool( tri->tangentsCalculated );
+	f->ReadBool( tri->facePlanesCalculated );
+	f->ReadBool( tri->perfectHull );
+
+	f->ReadInt( tri->numVerts );
+	f->ReadInt( tri->numIndexes );
+	f->ReadInt( tri->numMirroredVerts );
+	f->ReadInt( tri->numDupVerts );
+	f->ReadInt( tri->numSilEdges );
+	f->ReadBool( hasSilIndexes );
+	f->ReadBool( hasFacePlanes );
+	ok = f->ReadBool( hasDominantTris );
+
+	if ( ok != sizeof( bool ) || tri->numVerts <= 0 || tri->numIndexes <= 0 || ( tri->numIndexes % 3 ) != 0 ||
+			tri->numMirroredVerts < 0 || tri->numMirroredVerts > tri->numVerts ||
+			tri->numDupVerts < 0 || tri->numDupVerts > tri->numVerts || tri->numSilEdges < 0 ) {
+		R_ReallyFreeStaticTriSurf( tri );
+		return NULL;
+	}
+
+	R_AllocStaticTriSurfVerts( tri, tri->numVerts );
+	R_AllocStaticTriSurfIndexes( tri, tri->numIndexes );
+
+	ok = ( f->Read( tri->verts, tri->numVerts * sizeof( tri->verts[0] ) ) == tri->numVerts * (int)sizeof( tri->verts[0] ) );
+	ok &= ( f->Read( tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) ) == tri->numIndexes * (int)sizeof( tri->indexes[0] ) );
+	if ( hasSilIndexes ) {
+		tri->silIndexes = triSilIndexAllocator.Alloc( tri->numIndexes );
+		ok &= ( f->Read( tri->silIndexes, tri->numIndexes * sizeof( tri->silIndexes[0] ) ) == tri->numIndexes * (int)sizeof( tri->silIndexes[0] ) );
+	}
+	if ( tri->numMirroredVerts ) {
+		tri->mirroredVerts = triMirroredVertAllocator.Alloc( tri->numMirroredVerts );
+		ok &= ( f->Read( tri->mirroredVerts, tri->numMirroredVerts * sizeof( tri->mirroredVerts[0] ) ) == tri->numMirroredVerts * (int)sizeof( tri->mirroredVerts[0] ) );
+	}
+	if ( tri->numDupVerts ) {
+		tri->dupVerts = triDupVertAllocator.Alloc( tri->numDupVerts * 2 );
+		ok &= ( f->Read( tri->dupVerts, tri->numDupVerts * 2 * sizeof( tri->dupVerts[0] ) ) == tri->numDupVerts * 2 * (int)sizeof( tri->dupVerts[0] ) );
+	}
+	if ( tri->numSilEdges ) {
+		tri->silEdges = triSilEdgeAllocator.Alloc( tri->numSilEdges );
+		ok &= ( f->Read( tri->silEdges, tri->numSilEdges * sizeof( tri->silEdges[0] ) ) == tri->numSilEdges * (int)sizeof( tri->silEdges[0] ) );
+	}
+	if ( hasFacePlanes ) {
+		R_AllocStaticTriSurfPlanes( tri, tri->numIndexes );
+		ok &= ( f->Read( tri->facePlanes, ( tri->numIndexes / 3 ) * sizeof( tri->facePlanes[0] ) ) == ( tri->numIndexes / 3 ) * (int)sizeof( tri->facePlanes[0] ) );
+	}
+	if ( hasDominantTris ) {
+		tri->dominantTris = triDominantTrisAllocator.Alloc( tri->numVerts );
+		ok &= ( f->Read( tri->dominantTris, tri->numVerts * sizeof( tri->dominantTris[0] ) ) == tri->numVerts * (int)sizeof( tri->dominantTris[0] ) );
+	}
+
+	// a damaged cache must not index outside the vertexes and planes
+	ok = ok && R_IndexesInRange( tri->indexes, tri->numIndexes, tri->numVerts );
+	if ( ok && tri->silIndexes ) {
+		ok = R_IndexesInRange( tri->silIndexes, tri->numIndexes, tri->numVerts );
+	}
+	if ( ok && tri->mirroredVerts ) {
+		ok = R_IndexesInRange( tri->mirroredVerts, tri->numMirroredVerts, tri->numVerts );
+	}
+	if ( ok && tri->dupVerts ) {
+		ok = R_IndexesInRange( tri->dupVerts, tri->numDupVerts * 2, tri->numVerts );
+	}
+	for ( int i = 0 ; ok && i < tri->numSilEdges ; i++ ) {
+		const silEdge_t &edge = tri->silEdges[i];
+		// p2 is numIndexes / 3 for edges with only one triangle
+		ok = ( edge.v1 >= 0 && edge.v1 < tri->numVerts && edge.v2 >= 0 && edge.v2 < tri->numVerts &&
+				edge.p1 >= 0 && edge.p1 <= tri->numIndexes / 3 && edge.p2 >= 0 && edge.p2 <= tri->numIndexes / 3 );
+	}
+	for ( int i = 0 ; ok && tri->dominantTris && i < tri->numVerts ; i++ ) {
+		const dominantTri_t &dt = tri->dominantTris[i];
+		ok = ( dt.v2 >= 0 && dt.v2 < tri->numVerts && dt.v3 >= 0 && dt.v3 < tri->numVerts );
+	}
+
+	if ( !ok ) {
+		R_ReallyFreeStaticTriSurf( tri );
+		return NULL;
+	}
+
+	return tri;
+}
+
+typedef enum {
+	TANGENTS_SMOOTHED,
+	TANGENTS_UNSMOOTHED,
+	TANGENTS_FACE,
+	TANGENTS_MIKKTSPACE
+} benchmarkTangents_t;
+
+/*
+=================
+R_BenchmarkTangentPass
+
+Times one tangent derivation over all the surfaces, in msec per iteration.
+=================
+*/
+static double R_BenchmarkTangentPass( const idList<srfTriangles_t *> &tris, benchmarkTangents_t pass, int iterations ) {
+	// small meshes take well under a msec per iteration, so time in usec
+	const int64_t start = frameProfiler->Microseconds();
+
+	for ( int i = 0 ; i < iterations ; i++ ) {
+		for ( int j = 0 ; j < tris.Num() ; j++ ) {
+			srfTriangles_t *tri = tris[j];
+
+			tri->tangentsCalculated = false;
+
+			switch( pass ) {
+				case TANGENTS_SMOOTHED:
+					R_DeriveTangents( tri );
+					break;
+				case TANGENTS_UNSMOOTHED:
+					R_DeriveUnsmoothedTangents( tri );
+					break;
+				case TANGENTS_FACE:
+					R_DeriveTangentsWithoutNormals( tri, false );
+					break;
+				case TANGENTS_MIKKTSPACE:
+					R_DeriveMikktspaceTangents( tri );
+					break;
+			}
+		}
+	}
+
+	const int64_t usec = frameProfiler->Microseconds() - start;
+
+	return usec * 0.001 / iterations;
+}
+
+/*
+=================
+R_BenchmarkTangents_f
+
+Times the tangent space derivation of a model with the active and the
+generic SIMD processor, and the load time legacy and Mikktspace paths.
+md5 models are measured in their default pose.
+
+benchmarkTangents <model> [iterations]
+=================
+*/
+void R_BenchmarkTangents_f( const idCmdArgs &args ) {
+	idList<srfTriangles_t *>	smoothTris;
+	idList<srfTriangles_t *>	unsmoothedTris;
+	idRenderModel *				model;
+	idRenderModel *				instance;
+	renderEntity_t				ent;
+	int							iterations;
+	int							numVerts, numIndexes;
+	int							i;
+
+	if ( args.Argc() < 2 ) {
+		common->Printf( "usage: benchmarkTangents <model> [iterations]\n" );
+		return;
+	}
+
+	iterations = 100;
+	if ( args.Argc() > 2 ) {
+		iterations = Max( atoi( args.Argv( 2 ) ), 1 );
+	}
+
+	model = renderModelManager->CheckModel( args.Argv( 1 ) );
+	if ( !model || model->IsDefaultModel() ) {
+		common->Printf( "Couldn't load model '%s'\n", args.Argv( 1 ) );
+		return;
+	}
+
+	memset( &ent, 0, sizeof( ent ) );
+	instance = NULL;
+
+	if ( model->IsDynamicModel() != DM_STATIC ) {
+		if ( model->NumJoints() <= 0 ) {
+			common->Printf( "'%s' is a dynamic model without joints\n", model->Name() );
+			return;
+		}
+
+		// set up the default pose like idDeclModelDef::SetupJoints
+		const idMD5Joint *joints = model->GetJoints();
+		int *jointParents = (int *)_alloca16( model->NumJoints() * sizeof( jointParents[0] ) );
+		for ( i = 0 ; i < model->NumJoints() ; i++ ) {
+			jointParents[i] = joints[i].parent ? joints[i].parent - joints : -1;
+		}
+
+		ent.hModel = model;
+		ent.numJoints = model->NumJoints();
+		ent.joints = (idJointMat *)Mem_Alloc16( ent.numJoints * sizeof( ent.joints[0] ) );
+		SIMDProcessor->ConvertJointQuatsToJointMats( ent.joints, model->GetDefaultPose(), ent.numJoints );
+		SIMDProcessor->TransformJoints( ent.joints, jointParents, 1, ent.numJoints - 1 );
+
+		instance = model->InstantiateDynamicModel( &ent, NULL, NULL );
+		if ( !instance ) {
+			Mem_Free16( ent.joints );
+			return;
+		}
+	}
+
+	const idRenderModel *source = instance ? instance : model;
+
+	numVerts = 0;
+	numIndexes = 0;
+	for ( i = 0 ; i < source->NumSurfaces() ; i++ ) {
+		const srfTriangles_t *tri = source->Surface( i )->geometry;
+
+		if ( !tri || !tri->numIndexes || !tri->verts ) {
+			continue;
+		}
+
+		smoothTris.Append( R_CopyStaticTriSurf( tri ) );
+
+		srfTriangles_t *unsmoothed = R_CopyStaticTriSurf( tri );
+		R_BuildDominantTris( unsmoothed );
+		unsmoothedTris.Append( unsmoothed );
+
+		numVerts += tri->numVerts;
+		numIndexes += tri->numIndexes;
+	}
+
+	if ( smoothTris.Num() ) {
+		double smoothMsec[2], unsmoothedMsec[2], faceMsec, mikktspaceMsec;
+
+		// the first pass allocates the face planes and derives the normals the other passes need
+		R_BenchmarkTangentPass( smoothTris, TANGENTS_SMOOTHED, 1 );
+
+		smoothMsec[0] = R_BenchmarkTangentPass( smoothTris, TANGENTS_SMOOTHED, iterations );
+		unsmoothedMsec[0] = R_BenchmarkTangentPass( unsmoothedTris, TANGENTS_UNSMOOTHED, iterations );
+		const char *processorName = SIMDProcessor->GetName();
+
+		idSIMD::InitProcessor( "benchmarkTangents", true );
+		smoothMsec[1] = R_BenchmarkTangentPass( smoothTris, TANGENTS_SMOOTHED, iterations );
+		unsmoothedMsec[1] = R_BenchmarkTangentPass( unsmoothedTris, TANGENTS_UNSMOOTHED, iterations );
+		idSIMD::InitProcessor( "benchmarkTangents", cvarSystem->GetCVarBool( "com_forceGenericSIMD" ) );
+
+		faceMsec = R_BenchmarkTangentPass( smoothTris, TANGENTS_FACE, iterations );
+		mikktspaceMsec = R_BenchmarkTangentPass( smoothTris, TANGENTS_MIKKTSPACE, iterations );
+
+		common->Printf( "%s: %i surfaces, %i verts, %i tris, %i iterations\n", model->Name(), smoothTris.Num(), numVerts, numIndexes / 3, iterations );
+		common->Printf( "msec per iteration     %-12s generic\n", processorName );
+		common->Printf( "smoothed tangents      %-12.4f %.4f\n", smoothMsec[0], smoothMsec[1] );
+		common->Printf( "unsmoothed tangents    %-12.4f %.4f\n", unsmoothedMsec[0], unsmoothedMsec[1] );
+		common->Printf( "legacy face tangents   %.4f\n", faceMsec );
+		common->Printf( "mikktspace tangents    %.4f\n", mikktspaceMsec );
+	} else {
+		common->Printf( "'%s' has no surfaces\n", model->Name() );
+	}
+
+	for ( i = 0 ; i < smoothTris.Num() ; i++ ) {
+		R_FreeStaticTriSurf( smoothTris[i] );
+		R_FreeStaticTriSurf( unsmoothedTris[i] );
+	}
+
+	delete instance;
+	if ( ent.joints ) {
+		Mem_Free16( ent.joints );
+	}
+}
+
 /*
 ===================================================================================
 
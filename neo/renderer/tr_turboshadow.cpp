@@ -31,6 +31,12 @@ If you have questions concerning this license or the applicable additional terms
 
 #include "tr_local.h"
 
+// the shadow volumes are built in over-allocated arrays that are shrunk with
+// R_ResizeStaticTriSurf*, which only works with the tri data allocator
+#ifndef USE_TRI_DATA_ALLOCATOR
+#error "tr_turboshadow.cpp requires USE_TRI_DATA_ALLOCATOR"
+#endif
+
 int	c_turboUsedVerts;
 int c_turboUnusedVerts;
 
@@ -43,9 +49,12 @@ Determines which triangles of the surface are facing towards the light origin.
 The facing array should be allocated with one extra index than
 the number of surface triangles, which will be used to handle dangling
 edge silhouettes.
+
+If facing is given it is used instead of allocating the array,
+so this can be called from a parallel job.
 ================
 */
-void R_CalcInteractionFacing( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo ) {
+void R_CalcInteractionFacing( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo, byte *facing ) {
 	if ( cullInfo.facing != NULL ) {
 		return;
 	}
@@ -54,7 +63,11 @@ void R_CalcInteractionFacing( const idRenderEntityLocal *ent, const srfTriangles
 	R_GlobalPointToLocal( ent->modelMatrix, light->globalLightOrigin, localLightOrigin );
 
 	const int numFaces = tri->numIndexes / 3;
-	cullInfo.facing = (byte *) R_StaticAlloc( ( numFaces + 1 ) * sizeof( cullInfo.facing[0] ) );
+	if ( facing ) {
+		cullInfo.facing = facing;
+	} else {
+		cullInfo.facing = (byte *) R_StaticAlloc( ( numFaces + 1 ) * sizeof( cullInfo.facing[0] ) );
+	}
 
 	// exact geometric cull against face
 	for ( int i = 0, face = 0; i < tri->numIndexes; i += 3, face++ ) {
@@ -72,31 +85,21 @@ void R_CalcInteractionFacing( const idRenderEntityLocal *ent, const srfTriangles
 
 /*
 =====================
-R_CreateVertexProgramTurboShadowVolume
+R_CountTurboShadowingFaces
 
-are dangling edges that are outside the light frustum still making planes?
+Returns the number of triangles that will cast a shadow.
+Triangles that are completely outside the light frustum are
+made "facing" when projected culling is used.
 =====================
 */
-srfTriangles_t *R_CreateVertexProgramTurboShadowVolume( const idRenderEntityLocal *ent,
-														const srfTriangles_t *tri, const idRenderLightLocal *light,
-														srfCullInfo_t &cullInfo ) {
+static int R_CountTurboShadowingFaces( const srfTriangles_t *tri, srfCullInfo_t &cullInfo, bool projectedCull ) {
 	int		i, j;
-	srfTriangles_t	*newTri;
-	silEdge_t	*sil;
-	const glIndex_t *indexes;
-	const byte *facing;
-
-	R_CalcInteractionFacing( ent, tri, light, cullInfo );
-	if ( r_useShadowProjectedCull.GetBool() ) {
-		R_CalcInteractionCullBits( ent, tri, light, cullInfo );
-	}
-
-	int numFaces = tri->numIndexes / 3;
-	int	numShadowingFaces = 0;
-	facing = cullInfo.facing;
+	int		numFaces = tri->numIndexes / 3;
+	int		numShadowingFaces = 0;
+	const byte *facing = cullInfo.facing;
 
 	// if all the triangles are inside the light frustum
-	if ( cullInfo.cullBits == LIGHT_CULL_ALL_FRONT || !r_useShadowProjectedCull.GetBool() ) {
+	if ( cullInfo.cullBits == LIGHT_CULL_ALL_FRONT || !projectedCull ) {
 
 		// count the number of shadowing faces
 		for ( i = 0; i < numFaces; i++ ) {
@@ -107,7 +110,7 @@ srfTriangles_t *R_CreateVertexProgramTurboShadowVolume( const idRenderEntityLoca
 	} else {
 
 		// make all triangles that are outside the light frustum "facing", so they won't cast shadows
-		indexes = tri->indexes;
+		const glIndex_t *indexes = tri->indexes;
 		byte *modifyFacing = cullInfo.facing;
 		const byte *cullBits = cullInfo.cullBits;
 		for ( j = i = 0; i < tri->numIndexes; i += 3, j++ ) {
@@ -124,25 +127,26 @@ srfTriangles_t *R_CreateVertexProgramTurboShadowVolume( const idRenderEntityLoca
 		}
 	}
 
-	if ( !numShadowingFaces ) {
-		// no faces are inside the light frustum and still facing the right way
-		return NULL;
-	}
+	return numShadowingFaces;
+}
 
-	// shadowVerts will be NULL on these surfaces, so the shadowVerts will be taken from the ambient surface
-	newTri = R_AllocStaticTriSurf();
+/*
+=====================
+R_BuildVertexProgramTurboShadowVolume
+
+Fills in the indexes of a shadow volume that takes its vertexes from the ambient surface.
+newTri->indexes must have room for ( numShadowingFaces + tri->numSilEdges ) * 6 indexes.
+=====================
+*/
+static void R_BuildVertexProgramTurboShadowVolume( const srfTriangles_t *tri, const byte *facing, srfTriangles_t *newTri ) {
+	int		i, j;
+	silEdge_t	*sil;
+	const glIndex_t *indexes;
 
 	newTri->numVerts = tri->numVerts * 2;
 
-	// alloc the max possible size
-#ifdef USE_TRI_DATA_ALLOCATOR
-	R_AllocStaticTriSurfIndexes( newTri, ( numShadowingFaces + tri->numSilEdges ) * 6 );
 	glIndex_t *tempIndexes = newTri->indexes;
 	glIndex_t *shadowIndexes = newTri->indexes;
-#else
-	glIndex_t *tempIndexes = (glIndex_t *)_alloca16( tri->numSilEdges * 6 * sizeof( tempIndexes[0] ) );
-	glIndex_t *shadowIndexes = tempIndexes;
-#endif
 
 	// create new triangles along sil planes
 	for ( sil = tri->silEdges, i = tri->numSilEdges; i > 0; i--, sil++ ) {
@@ -172,27 +176,8 @@ srfTriangles_t *R_CreateVertexProgramTurboShadowVolume( const idRenderEntityLoca
 
 	int	numShadowIndexes = shadowIndexes - tempIndexes;
 
-	// we aren't bothering to separate front and back caps on these
-	newTri->numIndexes = newTri->numShadowIndexesNoFrontCaps = numShadowIndexes + numShadowingFaces * 6;
-	newTri->numShadowIndexesNoCaps = numShadowIndexes;
-	newTri->shadowCapPlaneBits = SHADOW_CAP_INFINITE;
-
-#ifdef USE_TRI_DATA_ALLOCATOR
-	// decrease the size of the memory block to only store the used indexes
-	R_ResizeStaticTriSurfIndexes( newTri, newTri->numIndexes );
-#else
-	// allocate memory for the indexes
-	R_AllocStaticTriSurfIndexes( newTri, newTri->numIndexes );
-	// copy the indexes we created for the sil planes
-	SIMDProcessor->Memcpy( newTri->indexes, tempIndexes, numShadowIndexes * sizeof( tempIndexes[0] ) );
-#endif
-
-	// these have no effect, because they extend to infinity
-	newTri->bounds.Clear();
-
 	// put some faces on the model and some on the distant projection
 	indexes = tri->indexes;
-	shadowIndexes = newTri->indexes + numShadowIndexes;
 	for ( i = 0, j = 0; i < tri->numIndexes; i += 3, j++ ) {
 		if ( facing[j] ) {
 			continue;
@@ -211,75 +196,32 @@ srfTriangles_t *R_CreateVertexProgramTurboShadowVolume( const idRenderEntityLoca
 		shadowIndexes += 6;
 	}
 
-	return newTri;
+	// we aren't bothering to separate front and back caps on these
+	newTri->numIndexes = newTri->numShadowIndexesNoFrontCaps = shadowIndexes - tempIndexes;
+	newTri->numShadowIndexesNoCaps = numShadowIndexes;
+	newTri->shadowCapPlaneBits = SHADOW_CAP_INFINITE;
+
+	// these have no effect, because they extend to infinity
+	newTri->bounds.Clear();
 }
 
 /*
 =====================
-R_CreateTurboShadowVolume
+R_BuildTurboShadowVolume
+
+Fills in the vertexes and indexes of a shadow volume with its own shadow vertexes.
+newTri->shadowVertexes must have room for tri->numVerts * 2 vertexes and newTri->indexes
+for ( numShadowingFaces + tri->numSilEdges ) * 6 indexes.
 =====================
 */
-srfTriangles_t *R_CreateTurboShadowVolume( const idRenderEntityLocal *ent,
-											const srfTriangles_t *tri, const idRenderLightLocal *light,
-											srfCullInfo_t &cullInfo ) {
+static void R_BuildTurboShadowVolume( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light,
+										const byte *facing, srfTriangles_t *newTri ) {
 	int		i, j;
 	idVec3	localLightOrigin;
-	srfTriangles_t	*newTri;
 	silEdge_t	*sil;
 	const glIndex_t *indexes;
-	const byte *facing;
-
-	R_CalcInteractionFacing( ent, tri, light, cullInfo );
-	if ( r_useShadowProjectedCull.GetBool() ) {
-		R_CalcInteractionCullBits( ent, tri, light, cullInfo );
-	}
-
-	int numFaces = tri->numIndexes / 3;
-	int	numShadowingFaces = 0;
-	facing = cullInfo.facing;
-
-	// if all the triangles are inside the light frustum
-	if ( cullInfo.cullBits == LIGHT_CULL_ALL_FRONT || !r_useShadowProjectedCull.GetBool() ) {
-
-		// count the number of shadowing faces
-		for ( i = 0; i < numFaces; i++ ) {
-			numShadowingFaces += facing[i];
-		}
-		numShadowingFaces = numFaces - numShadowingFaces;
-
-	} else {
-
-		// make all triangles that are outside the light frustum "facing", so they won't cast shadows
-		indexes = tri->indexes;
-		byte *modifyFacing = cullInfo.facing;
-		const byte *cullBits = cullInfo.cullBits;
-		for ( j = i = 0; i < tri->numIndexes; i += 3, j++ ) {
-			if ( !modifyFacing[j] ) {
-				int	i1 = indexes[i+0];
-				int	i2 = indexes[i+1];
-				int	i3 = indexes[i+2];
-				if ( cullBits[i1] & cullBits[i2] & cullBits[i3] ) {
-					modifyFacing[j] = 1;
-				} else {
-					numShadowingFaces++;
-				}
-			}
-		}
-	}
 
-	if ( !numShadowingFaces ) {
-		// no faces are inside the light frustum and still facing the right way
-		return NULL;
-	}
-
-	newTri = R_AllocStaticTriSurf();
-
-#ifdef USE_TRI_DATA_ALLOCATOR
-	R_AllocStaticTriSurfShadowVerts( newTri, tri->numVerts * 2 );
 	shadowCache_t *shadowVerts = newTri->shadowVertexes;
-#else
-	shadowCache_t *shadowVerts = (shadowCache_t *)_alloca16( tri->numVerts * 2 * sizeof( shadowVerts[0] ) );
-#endif
 
 	R_GlobalPointToLocal( ent->modelMatrix, light->globalLightOrigin, localLightOrigin );
 
@@ -300,25 +242,8 @@ srfTriangles_t *R_CreateTurboShadowVolume( const idRenderEntityLocal *ent,
 
 	newTri->numVerts = SIMDProcessor->CreateShadowCache( &shadowVerts->xyz, vertRemap, localLightOrigin, tri->verts, tri->numVerts );
 
-	c_turboUsedVerts += newTri->numVerts;
-	c_turboUnusedVerts += tri->numVerts * 2 - newTri->numVerts;
-
-#ifdef USE_TRI_DATA_ALLOCATOR
-	R_ResizeStaticTriSurfShadowVerts( newTri, newTri->numVerts );
-#else
-	R_AllocStaticTriSurfShadowVerts( newTri, newTri->numVerts );
-	SIMDProcessor->Memcpy( newTri->shadowVertexes, shadowVerts, newTri->numVerts * sizeof( shadowVerts[0] ) );
-#endif
-
-	// alloc the max possible size
-#ifdef USE_TRI_DATA_ALLOCATOR
-	R_AllocStaticTriSurfIndexes( newTri, ( numShadowingFaces + tri->numSilEdges ) * 6 );
 	glIndex_t *tempIndexes = newTri->indexes;
 	glIndex_t *shadowIndexes = newTri->indexes;
-#else
-	glIndex_t *tempIndexes = (glIndex_t *)_alloca16( tri->numSilEdges * 6 * sizeof( tempIndexes[0] ) );
-	glIndex_t *shadowIndexes = tempIndexes;
-#endif
 
 	// create new triangles along sil planes
 	for ( sil = tri->silEdges, i = tri->numSilEdges; i > 0; i--, sil++ ) {
@@ -348,27 +273,8 @@ srfTriangles_t *R_CreateTurboShadowVolume( const idRenderEntityLocal *ent,
 
 	int numShadowIndexes = shadowIndexes - tempIndexes;
 
-	// we aren't bothering to separate front and back caps on these
-	newTri->numIndexes = newTri->numShadowIndexesNoFrontCaps = numShadowIndexes + numShadowingFaces * 6;
-	newTri->numShadowIndexesNoCaps = numShadowIndexes;
-	newTri->shadowCapPlaneBits = SHADOW_CAP_INFINITE;
-
-#ifdef USE_TRI_DATA_ALLOCATOR
-	// decrease the size of the memory block to only store the used indexes
-	R_ResizeStaticTriSurfIndexes( newTri, newTri->numIndexes );
-#else
-	// allocate memory for the indexes
-	R_AllocStaticTriSurfIndexes( newTri, newTri->numIndexes );
-	// copy the indexes we created for the sil planes
-	SIMDProcessor->Memcpy( newTri->indexes, tempIndexes, numShadowIndexes * sizeof( tempIndexes[0] ) );
-#endif
-
-	// these have no effect, because they extend to infinity
-	newTri->bounds.Clear();
-
 	// put some faces on the model and some on the distant projection
 	indexes = tri->silIndexes;
-	shadowIndexes = newTri->indexes + numShadowIndexes;
 	for ( i = 0, j = 0; i < tri->numIndexes; i += 3, j++ ) {
 		if ( facing[j] ) {
 			continue;
@@ -387,5 +293,547 @@ srfTriangles_t *R_CreateTurboShadowVolume( const idRenderEntityLocal *ent,
 		shadowIndexes += 6;
 	}
 
+	// we aren't bothering to separate front and back caps on these
+	newTri->numIndexes = newTri->numShadowIndexesNoFrontCaps = shadowIndexes - tempIndexes;
+	newTri->numShadowIndexesNoCaps = numShadowIndexes;
+	newTri->shadowCapPlaneBits = SHADOW_CAP_INFINITE;
+
+	// these have no effect, because they extend to infinity
+	newTri->bounds.Clear();
+}
+
+/*
+===============================================================================
+
+	Turbo shadow cache
+
+	The shadow volume of a static model surface only depends on the surface
+	itself, the light origin in model space and, with projected culling, the
+	light frustum in model space.  When an interaction is torn down and
+	re-created, for instance when a light is toggled, the shadow volume is
+	copied out of this cache instead of being rebuilt.
+
+	The cache keeps its own copies of the indexes and shadow vertexes, so it
+	survives interaction and vertex cache purges.  Entries are dropped when
+	their source surface is freed, and the least recently used entries are
+	evicted when the cache grows over r_turboShadowCacheMegs.
+
+===============================================================================
+*/
+
+// lights and entities that moved within this many frames are not cached
+const int TURBO_SHADOW_CACHE_MOVING_FRAMES = 8;
+
+typedef struct {
+	const srfTriangles_t *	tri;
+	idVec3					localLightOrigin;
+	idPlane					localClipPlanes[6];		// only valid with projectedCull
+	bool					vertexProgram;
+	bool					projectedCull;
+} turboShadowCacheKey_t;
+
+typedef struct turboShadowCacheEntry_s {
+	turboShadowCacheKey_t	key;
+	int						numVerts;
+	int						numIndexes;
+	int						numShadowIndexesNoCaps;
+	int						numShadowIndexesNoFrontCaps;
+	shadowCache_t *			shadowVertexes;			// NULL for vertex program shadows
+	glIndex_t *				indexes;				// NULL if the surface doesn't cast a shadow
+	int						size;
+	int						listIndex;
+	idLinkList<struct turboShadowCacheEntry_s>	lruNode;
+} turboShadowCacheEntry_t;
+
+static idList<turboShadowCacheEntry_t *>	turboShadowCache;
+static idHashIndex							turboShadowCacheHash;
+static idLinkList<turboShadowCacheEntry_t>	turboShadowCacheLRU;		// least recently used first
+static int									turboShadowCacheSize;
+static int									turboShadowCacheHits;
+static int									turboShadowCacheMisses;
+
+/*
+=====================
+R_TurboShadowCacheHashKey
+=====================
+*/
+static ID_INLINE int R_TurboShadowCacheHashKey( const srfTriangles_t *tri ) {
+	return (int)( ( (ptrdiff_t)tri ) >> 4 );
+}
+
+/*
+=====================
+R_TurboShadowCacheKey
+
+Returns false if the shadow volume of the surface can't be cached.
+=====================
+*/
+static bool R_TurboShadowCacheKey( turboShadowCacheKey_t &key, const idRenderEntityLocal *ent, const srfTriangles_t *tri,
+									const idRenderLightLocal *light, bool vertexProgram, bool projectedCull ) {
+	if ( !r_useTurboShadowCache.GetBool() ) {
+		return false;
+	}
+
+	// dynamic models may update their surfaces in place
+	if ( ent->parms.hModel == NULL || ent->parms.hModel->IsDynamicModel() != DM_STATIC ) {
+		return false;
+	}
+
+	// a moving light or entity would only fill the cache with shadows that are never used again
+	if ( tr.frameCount - light->lastMovedFrameNum < TURBO_SHADOW_CACHE_MOVING_FRAMES ||
+			tr.frameCount - ent->lastMovedFrameNum < TURBO_SHADOW_CACHE_MOVING_FRAMES ) {
+		return false;
+	}
+
+	key.tri = tri;
+	key.vertexProgram = vertexProgram;
+	key.projectedCull = projectedCull;
+	R_GlobalPointToLocal( ent->modelMatrix, light->globalLightOrigin, key.localLightOrigin );
+	if ( projectedCull ) {
+		// same planes as R_CalcInteractionCullBits
+		for ( int i = 0; i < 6; i++ ) {
+			R_GlobalPlaneToLocal( ent->modelMatrix, -light->frustum[i], key.localClipPlanes[i] );
+		}
+	}
+	return true;
+}
+
+/*
+=====================
+R_CompareTurboShadowCacheKeys
+=====================
+*/
+static bool R_CompareTurboShadowCacheKeys( const turboShadowCacheKey_t &a, const turboShadowCacheKey_t &b ) {
+	if ( a.tri != b.tri || a.vertexProgram != b.vertexProgram || a.projectedCull != b.projectedCull ) {
+		return false;
+	}
+	if ( a.localLightOrigin != b.localLightOrigin ) {
+		return false;
+	}
+	if ( a.projectedCull ) {
+		for ( int i = 0; i < 6; i++ ) {
+			if ( a.localClipPlanes[i] != b.localClipPlanes[i] ) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/*
+=====================
+R_FindTurboShadowCacheEntry
+=====================
+*/
+static turboShadowCacheEntry_t *R_FindTurboShadowCacheEntry( const turboShadowCacheKey_t &key ) {
+	int hash = R_TurboShadowCacheHashKey( key.tri );
+	for ( int i = turboShadowCacheHash.First( hash ); i != -1; i = turboShadowCacheHash.Next( i ) ) {
+		if ( R_CompareTurboShadowCacheKeys( turboShadowCache[i]->key, key ) ) {
+			return turboShadowCache[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+=====================
+R_FreeTurboShadowCacheEntry
+=====================
+*/
+static void R_FreeTurboShadowCacheEntry( turboShadowCacheEntry_t *entry ) {
+	int index = entry->listIndex;
+	int last = turboShadowCache.Num() - 1;
+
+	turboShadowCacheHash.Remove( R_TurboShadowCacheHashKey( entry->key.tri ), index );
+	if ( index != last ) {
+		// move the last entry into the free slot
+		turboShadowCacheEntry_t *moved = turboShadowCache[last];
+		turboShadowCacheHash.Remove( R_TurboShadowCacheHashKey( moved->key.tri ), last );
+		turboShadowCacheHash.Add( R_TurboShadowCacheHashKey( moved->key.tri ), index );
+		turboShadowCache[index] = moved;
+		moved->listIndex = index;
+	}
+	turboShadowCache.SetNum( last, false );
+
+	turboShadowCacheSize -= entry->size;
+	entry->lruNode.Remove();
+	Mem_Free16( entry->shadowVertexes );
+	Mem_Free( entry->indexes );
+	delete entry;
+}
+
+/*
+=====================
+R_FindCachedTurboShadowVolume
+
+Returns true if the shadow volume was found in the cache.  newTri will be
+a copy of the cached shadow volume, or NULL if the surface doesn't cast a shadow.
+=====================
+*/
+static bool R_FindCachedTurboShadowVolume( const turboShadowCacheKey_t &key, srfTriangles_t *&newTri ) {
+	turboShadowCacheEntry_t *entry = R_FindTurboShadowCacheEntry( key );
+	if ( !entry ) {
+		turboShadowCacheMisses++;
+		return false;
+	}
+	turboShadowCacheHits++;
+
+	// move to the most recently used end
+	entry->lruNode.AddToEnd( turboShadowCacheLRU );
+
+	newTri = NULL;
+	if ( !entry->numIndexes ) {
+		return true;
+	}
+
+	newTri = R_AllocStaticTriSurf();
+	if ( entry->shadowVertexes ) {
+		R_AllocStaticTriSurfShadowVerts( newTri, entry->numVerts );
+		SIMDProcessor->Memcpy( newTri->shadowVertexes, entry->shadowVertexes, entry->numVerts * sizeof( newTri->shadowVertexes[0] ) );
+	}
+	R_AllocStaticTriSurfIndexes( newTri, entry->numIndexes );
+	SIMDProcessor->Memcpy( newTri->indexes, entry->indexes, entry->numIndexes * sizeof( newTri->indexes[0] ) );
+
+	newTri->numVerts = entry->numVerts;
+	newTri->numIndexes = entry->numIndexes;
+	newTri->numShadowIndexesNoCaps = entry->numShadowIndexesNoCaps;
+	newTri->numShadowIndexesNoFrontCaps = entry->numShadowIndexesNoFrontCaps;
+	newTri->shadowCapPlaneBits = SHADOW_CAP_INFINITE;
+	newTri->bounds.Clear();
+
+	return true;
+}
+
+/*
+=====================
+R_AddTurboShadowVolumeToCache
+
+newTri may be NULL if the surface doesn't cast a shadow.
+=====================
+*/
+static void R_AddTurboShadowVolumeToCache( const turboShadowCacheKey_t &key, const srfTriangles_t *newTri ) {
+	if ( R_FindTurboShadowCacheEntry( key ) ) {
+		return;
+	}
+
+	turboShadowCacheEntry_t *entry = new turboShadowCacheEntry_t;
+	entry->key = key;
+	entry->numVerts = 0;
+	entry->numIndexes = 0;
+	entry->numShadowIndexesNoCaps = 0;
+	entry->numShadowIndexesNoFrontCaps = 0;
+	entry->shadowVertexes = NULL;
+	entry->indexes = NULL;
+	entry->size = sizeof( *entry );
+	entry->lruNode.SetOwner( entry );
+
+	if ( newTri ) {
+		entry->numVerts = newTri->numVerts;
+		entry->numIndexes = newTri->numIndexes;
+		entry->numShadowIndexesNoCaps = newTri->numShadowIndexesNoCaps;
+		entry->numShadowIndexesNoFrontCaps = newTri->numShadowIndexesNoFrontCaps;
+		if ( newTri->shadowVertexes ) {
+			entry->shadowVertexes = (shadowCache_t *)Mem_Alloc16( newTri->numVerts * sizeof( entry->shadowVertexes[0] ) );
+			SIMDProcessor->Memcpy( entry->shadowVertexes, newTri->shadowVertexes, newTri->numVerts * sizeof( entry->shadowVertexes[0] ) );
+			entry->size += newTri->numVerts * sizeof( entry->shadowVertexes[0] );
+		}
+		entry->indexes = (glIndex_t *)Mem_Alloc( newTri->numIndexes * sizeof( entry->indexes[0] ) );
+		SIMDProcessor->Memcpy( entry->indexes, newTri->indexes, newTri->numIndexes * sizeof( entry->indexes[0] ) );
+		entry->size += newTri->numIndexes * sizeof( entry->indexes[0] );
+	}
+
+	entry->listIndex = turboShadowCache.Append( entry );
+	turboShadowCacheHash.Add( R_TurboShadowCacheHashKey( key.tri ), entry->listIndex );
+	entry->lruNode.AddToEnd( turboShadowCacheLRU );
+	turboShadowCacheSize += entry->size;
+
+	// evict the least recently used entries, but never the new one
+	const int maxSize = r_turboShadowCacheMegs.GetInteger() * 1024 * 1024;
+	while ( turboShadowCacheSize > maxSize && turboShadowCacheLRU.Next() != entry ) {
+		R_FreeTurboShadowCacheEntry( turboShadowCacheLRU.Next() );
+	}
+}
+
+/*
+=====================
+R_PurgeTurboShadowCache
+
+Removes all shadow volumes of the given surface, or all shadow volumes if tri is NULL.
+Called when a surface is really freed, so a new surface at the same address
+can't pick up the shadows of the old one.
+=====================
+*/
+void R_PurgeTurboShadowCache( const srfTriangles_t *tri ) {
+	if ( tri == NULL ) {
+		while ( turboShadowCache.Num() ) {
+			R_FreeTurboShadowCacheEntry( turboShadowCache[turboShadowCache.Num() - 1] );
+		}
+		turboShadowCache.Clear();
+		turboShadowCacheHash.Free();
+		return;
+	}
+
+	int hash = R_TurboShadowCacheHashKey( tri );
+	for ( int i = turboShadowCacheHash.First( hash ); i != -1; ) {
+		if ( turboShadowCache[i]->key.tri == tri ) {
+			R_FreeTurboShadowCacheEntry( turboShadowCache[i] );
+			// the hash chain changed
+			i = turboShadowCacheHash.First( hash );
+		} else {
+			i = turboShadowCacheHash.Next( i );
+		}
+	}
+}
+
+/*
+=====================
+R_PrintTurboShadowCacheStats
+=====================
+*/
+void R_PrintTurboShadowCacheStats( void ) {
+	common->Printf( "%6d kB turbo shadow cache in %d entries (%d hits, %d misses)\n",
+		turboShadowCacheSize >> 10, turboShadowCache.Num(), turboShadowCacheHits, turboShadowCacheMisses );
+}
+
+/*
+=====================
+R_CreateVertexProgramTurboShadowVolume
+
+are dangling edges that are outside the light frustum still making planes?
+=====================
+*/
+srfTriangles_t *R_CreateVertexProgramTurboShadowVolume( const idRenderEntityLocal *ent,
+														const srfTriangles_t *tri, const idRenderLightLocal *light,
+														srfCullInfo_t &cullInfo ) {
+	srfTriangles_t	*newTri;
+	turboShadowCacheKey_t key;
+
+	bool cache = R_TurboShadowCacheKey( key, ent, tri, light, true, r_useShadowProjectedCull.GetBool() );
+	if ( cache && R_FindCachedTurboShadowVolume( key, newTri ) ) {
+		return newTri;
+	}
+
+	R_CalcInteractionFacing( ent, tri, light, cullInfo );
+	if ( r_useShadowProjectedCull.GetBool() ) {
+		R_CalcInteractionCullBits( ent, tri, light, cullInfo );
+	}
+
+	int	numShadowingFaces = R_CountTurboShadowingFaces( tri, cullInfo, r_useShadowProjectedCull.GetBool() );
+	if ( !numShadowingFaces ) {
+		// no faces are inside the light frustum and still facing the right way
+		if ( cache ) {
+			R_AddTurboShadowVolumeToCache( key, NULL );
+		}
+		return NULL;
+	}
+
+	// shadowVerts will be NULL on these surfaces, so the shadowVerts will be taken from the ambient surface
+	newTri = R_AllocStaticTriSurf();
+
+	// alloc the max possible size
+	R_AllocStaticTriSurfIndexes( newTri, ( numShadowingFaces + tri->numSilEdges ) * 6 );
+
+	R_BuildVertexProgramTurboShadowVolume( tri, cullInfo.facing, newTri );
+
+	// decrease the size of the memory block to only store the used indexes
+	R_ResizeStaticTriSurfIndexes( newTri, newTri->numIndexes );
+
+	if ( cache ) {
+		R_AddTurboShadowVolumeToCache( key, newTri );
+	}
+
+	return newTri;
+}
+
+/*
+=====================
+R_CreateTurboShadowVolume
+=====================
+*/
+srfTriangles_t *R_CreateTurboShadowVolume( const idRenderEntityLocal *ent,
+											const srfTriangles_t *tri, const idRenderLightLocal *light,
+											srfCullInfo_t &cullInfo ) {
+	srfTriangles_t	*newTri;
+	turboShadowCacheKey_t key;
+
+	bool cache = R_TurboShadowCacheKey( key, ent, tri, light, false, r_useShadowProjectedCull.GetBool() );
+	if ( cache && R_FindCachedTurboShadowVolume( key, newTri ) ) {
+		return newTri;
+	}
+
+	R_CalcInteractionFacing( ent, tri, light, cullInfo );
+	if ( r_useShadowProjectedCull.GetBool() ) {
+		R_CalcInteractionCullBits( ent, tri, light, cullInfo );
+	}
+
+	int	numShadowingFaces = R_CountTurboShadowingFaces( tri, cullInfo, r_useShadowProjectedCull.GetBool() );
+	if ( !numShadowingFaces ) {
+		// no faces are inside the light frustum and still facing the right way
+		if ( cache ) {
+			R_AddTurboShadowVolumeToCache( key, NULL );
+		}
+		return NULL;
+	}
+
+	newTri = R_AllocStaticTriSurf();
+
+	// alloc the max possible size
+	R_AllocStaticTriSurfShadowVerts( newTri, tri->numVerts * 2 );
+	R_AllocStaticTriSurfIndexes( newTri, ( numShadowingFaces + tri->numSilEdges ) * 6 );
+
+	R_BuildTurboShadowVolume( ent, tri, light, cullInfo.facing, newTri );
+
+	c_turboUsedVerts += newTri->numVerts;
+	c_turboUnusedVerts += tri->numVerts * 2 - newTri->numVerts;
+
+	// decrease the size of the memory blocks to only store the used vertexes and indexes
+	R_ResizeStaticTriSurfShadowVerts( newTri, newTri->numVerts );
+	R_ResizeStaticTriSurfIndexes( newTri, newTri->numIndexes );
+
+	if ( cache ) {
+		R_AddTurboShadowVolumeToCache( key, newTri );
+	}
+
+	return newTri;
+}
+
+/*
+===============================================================================
+
+	Parallel turbo shadow volumes
+
+	R_AllocTurboShadowVolume does all the allocations on the main thread,
+	sized for the worst case, so R_BuildTurboShadowVolume can run in a
+	parallel job.  R_FinishTurboShadowVolume then trims the memory back
+	on the main thread and returns the shadow volume.
+
+===============================================================================
+*/
+
+/*
+=====================
+R_AllocTurboShadowVolume
+
+Returns false if the shadow volume can't be created with the turbo shadow
+path or is already in the turbo shadow cache, R_CreateShadowVolume should
+be used instead.
+=====================
+*/
+bool R_AllocTurboShadowVolume( turboShadowVolume_t &sv, const idRenderEntityLocal *ent, const srfTriangles_t *tri,
+								const idRenderLightLocal *light, shadowGen_t optimize, srfCullInfo_t &cullInfo ) {
+	if ( optimize != SG_DYNAMIC || !r_useTurboShadow.GetBool() || !r_shadows.GetBool() ) {
+		return false;
+	}
+
+	if ( tri->numSilEdges <= 0 || tri->numIndexes <= 0 || tri->numVerts <= 0 ) {
+		return false;
+	}
+
+	// copying a cached shadow volume is cheaper than a job
+	turboShadowCacheKey_t key;
+	if ( R_TurboShadowCacheKey( key, ent, tri, light, r_useShadowVertexProgram.GetBool(), r_useShadowProjectedCull.GetBool() ) ) {
+		if ( R_FindTurboShadowCacheEntry( key ) ) {
+			return false;
+		}
+	}
+
+	tr.pc.c_createShadowVolumes++;
+
+	sv.ent = ent;
+	sv.tri = tri;
+	sv.light = light;
+	sv.cullInfo = &cullInfo;
+	sv.vertexProgram = r_useShadowVertexProgram.GetBool();
+	sv.projectedCull = r_useShadowProjectedCull.GetBool();
+	sv.numShadowingFaces = 0;
+
+	sv.facing = NULL;
+	if ( cullInfo.facing == NULL ) {
+		sv.facing = (byte *) R_StaticAlloc( ( tri->numIndexes / 3 + 1 ) * sizeof( sv.facing[0] ) );
+	}
+	sv.cullBits = NULL;
+	if ( sv.projectedCull && cullInfo.cullBits == NULL ) {
+		sv.cullBits = (byte *) R_StaticAlloc( tri->numVerts * sizeof( sv.cullBits[0] ) );
+	}
+
+	sv.newTri = R_AllocStaticTriSurf();
+	if ( !sv.vertexProgram ) {
+		R_AllocStaticTriSurfShadowVerts( sv.newTri, tri->numVerts * 2 );
+	}
+	R_AllocStaticTriSurfIndexes( sv.newTri, ( tri->numIndexes / 3 + tri->numSilEdges ) * 6 );
+
+	return true;
+}
+
+/*
+=====================
+R_BuildTurboShadowVolume
+
+Only writes to memory allocated by R_AllocTurboShadowVolume, so this can run in a parallel job
+=====================
+*/
+void R_BuildTurboShadowVolume( turboShadowVolume_t &sv ) {
+	R_CalcInteractionFacing( sv.ent, sv.tri, sv.light, *sv.cullInfo, sv.facing );
+	if ( sv.projectedCull ) {
+		R_CalcInteractionCullBits( sv.ent, sv.tri, sv.light, *sv.cullInfo, sv.cullBits );
+	}
+
+	sv.numShadowingFaces = R_CountTurboShadowingFaces( sv.tri, *sv.cullInfo, sv.projectedCull );
+	if ( !sv.numShadowingFaces ) {
+		return;
+	}
+
+	if ( sv.vertexProgram ) {
+		R_BuildVertexProgramTurboShadowVolume( sv.tri, sv.cullInfo->facing, sv.newTri );
+	} else {
+		R_BuildTurboShadowVolume( sv.ent, sv.tri, sv.light, sv.cullInfo->facing, sv.newTri );
+	}
+}
+
+/*
+=====================
+R_FinishTurboShadowVolume
+
+Returns the shadow volume built by R_BuildTurboShadowVolume, or NULL if nothing casts a shadow
+=====================
+*/
+srfTriangles_t *R_FinishTurboShadowVolume( turboShadowVolume_t &sv ) {
+	// the cull bits are not used when the surface is completely inside the light
+	if ( sv.cullBits && sv.cullInfo->cullBits != sv.cullBits ) {
+		R_StaticFree( sv.cullBits );
+	}
+	sv.cullBits = NULL;
+	sv.facing = NULL;
+
+	srfTriangles_t *newTri = sv.newTri;
+	sv.newTri = NULL;
+
+	turboShadowCacheKey_t key;
+	bool cache = R_TurboShadowCacheKey( key, sv.ent, sv.tri, sv.light, sv.vertexProgram, sv.projectedCull );
+	if ( cache ) {
+		turboShadowCacheMisses++;
+	}
+
+	if ( !sv.numShadowingFaces ) {
+		// no faces are inside the light frustum and still facing the right way
+		R_FreeStaticTriSurf( newTri );
+		if ( cache ) {
+			R_AddTurboShadowVolumeToCache( key, NULL );
+		}
+		return NULL;
+	}
+
+	if ( !sv.vertexProgram ) {
+		c_turboUsedVerts += newTri->numVerts;
+		c_turboUnusedVerts += sv.tri->numVerts * 2 - newTri->numVerts;
+
+		R_ResizeStaticTriSurfShadowVerts( newTri, newTri->numVerts );
+	}
+	R_ResizeStaticTriSurfIndexes( newTri, newTri->numIndexes );
+
+	if ( cache ) {
+		R_AddTurboShadowVolumeToCache( key, newTri );
+	}
+
 	return newTri;
 }
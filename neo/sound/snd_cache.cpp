@@ -579,6 +579,9 @@ idSoundSample::PurgeSoundSample
 void idSoundSample::PurgeSoundSample() {
 	purged = true;
 
+	// make sure the stream decode thread is done with nonCacheData
+	soundSystemLocal.soundStreams.ReleaseSample( this );
+
 	alGetError();
 	alDeleteBuffers( 1, &openalBuffer );
 	if ( alGetError() != AL_NO_ERROR ) {
@@ -307,6 +307,7 @@ private:
 	idSoundSample *			lastSample;			// last sample being decoded
 	int						lastSampleOffset;	// last offset into the decoded sample
 	int						lastDecodeTime;		// last time decoding sound
+	bool					shared;				// used by more than one thread, decode under CRITICAL_SECTION_ONE
 
 	stb_vorbis*				stbv;				// stb_vorbis (Ogg) handle, using lastSample->nonCacheData
 };
@@ -342,6 +343,22 @@ idSampleDecoder::Alloc
 idSampleDecoder *idSampleDecoder::Alloc( void ) {
 	idSampleDecoderLocal *decoder = sampleDecoderAllocator.Alloc();
 	decoder->Clear();
+	decoder->shared = true;
+	return decoder;
+}
+
+/*
+====================
+idSampleDecoder::AllocPrivate
+
+The decoder doesn't take CRITICAL_SECTION_ONE, so it can decode without
+stalling the decoders of the mixer.
+====================
+*/
+idSampleDecoder *idSampleDecoder::AllocPrivate( void ) {
+	idSampleDecoderLocal *decoder = sampleDecoderAllocator.Alloc();
+	decoder->Clear();
+	decoder->shared = false;
 	return decoder;
 }
 
@@ -394,7 +411,9 @@ idSampleDecoderLocal::ClearDecoder
 ====================
 */
 void idSampleDecoderLocal::ClearDecoder( void ) {
-	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+	if ( shared ) {
+		Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+	}
 
 	switch( lastFormat ) {
 		case WAVE_FORMAT_TAG_PCM: {
@@ -409,7 +428,9 @@ void idSampleDecoderLocal::ClearDecoder( void ) {
 
 	Clear();
 
-	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+	if ( shared ) {
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+	}
 }
 
 /*
@@ -450,7 +471,9 @@ void idSampleDecoderLocal::Decode( idSoundSample *sample, int sampleOffset44k, i
 	}
 
 	// samples can be decoded both from the sound thread and the main thread for shakes
-	Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+	if ( shared ) {
+		Sys_EnterCriticalSection( CRITICAL_SECTION_ONE );
+	}
 
 	switch( sample->objectInfo.wFormatTag ) {
 		case WAVE_FORMAT_TAG_PCM: {
@@ -467,7 +490,9 @@ void idSampleDecoderLocal::Decode( idSoundSample *sample, int sampleOffset44k, i
 		}
 	}
 
-	Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+	if ( shared ) {
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_ONE );
+	}
 
 	if ( readSamples44k < sampleCount44k ) {
 		memset( dest + readSamples44k, 0, ( sampleCount44k - readSamples44k ) * sizeof( dest[0] ) );
@@ -151,6 +151,7 @@ idSoundChannel::idSoundChannel
 */
 idSoundChannel::idSoundChannel( void ) {
 	decoder = NULL;
+	stream = NULL;
 	Clear();
 }
 
@@ -187,6 +188,9 @@ void idSoundChannel::Clear( void ) {
 
 	triggered = false;
 	paused = false;
+	voiceScore = 0.0f;
+	virtualVoice = false;
+	seekOnTrigger = false;
 	openalSource = 0;
 	openalStreamingOffset = 0;
 	openalStreamingBuffer[0] = openalStreamingBuffer[1] = openalStreamingBuffer[2] = 0;
@@ -200,6 +204,8 @@ idSoundChannel::Start
 */
 void idSoundChannel::Start( void ) {
 	triggerState = true;
+	virtualVoice = false;
+	seekOnTrigger = false;
 	if ( decoder == NULL ) {
 		decoder = idSampleDecoder::Alloc();
 	}
@@ -225,6 +231,8 @@ idSoundChannel::ALStop
 ===================
 */
 void idSoundChannel::ALStop( void ) {
+	soundSystemLocal.soundStreams.Release( this );
+
 	if ( alIsSource( openalSource ) ) {
 		alSourceStop( openalSource );
 		alSourcei( openalSource, AL_BUFFER, 0 );
@@ -251,6 +259,119 @@ void idSoundChannel::ALStop( void ) {
 	}
 }
 
+/*
+===================
+idSoundCommandQueue::idSoundCommandQueue
+===================
+*/
+idSoundCommandQueue::idSoundCommandQueue( void ) {
+	memset( commands, 0, sizeof( commands ) );
+	head = 0;
+	tail = 0;
+	numOverflows = 0;
+}
+
+/*
+===================
+idSoundCommandQueue::Push
+===================
+*/
+void idSoundCommandQueue::Push( soundCommandType_t type, idSoundEmitterLocal *emitter, int channel ) {
+	int t = tail.load( std::memory_order_relaxed );
+
+	if ( t - head.load( std::memory_order_acquire ) >= SOUND_COMMAND_QUEUE_SIZE ) {
+		// the async update is stalled or not running at all, run the commands here
+		numOverflows++;
+		Drain();
+	}
+
+	soundCommand_t &cmd = commands[t & ( SOUND_COMMAND_QUEUE_SIZE - 1 )];
+	cmd.type = type;
+	cmd.emitter = emitter;
+	cmd.channel = channel;
+
+	tail.store( t + 1, std::memory_order_release );
+}
+
+/*
+===================
+idSoundCommandQueue::Drain
+
+the commands are executed under the lock the mixer holds, so they never run in the
+middle of a mix.  Pushing commands never takes it.
+===================
+*/
+void idSoundCommandQueue::Drain( void ) {
+	if ( head.load( std::memory_order_relaxed ) == tail.load( std::memory_order_acquire ) ) {
+		return;
+	}
+
+	Sys_EnterCriticalSection();
+
+	int h = head.load( std::memory_order_relaxed );
+	int t = tail.load( std::memory_order_acquire );
+	for ( ; h != t; h++ ) {
+		Execute( commands[h & ( SOUND_COMMAND_QUEUE_SIZE - 1 )] );
+	}
+	head.store( h, std::memory_order_release );
+
+	Sys_LeaveCriticalSection();
+}
+
+/*
+===================
+idSoundCommandQueue::Execute
+===================
+*/
+void idSoundCommandQueue::Execute( const soundCommand_t &cmd ) {
+	idSoundEmitterLocal *emitter = cmd.emitter;
+
+	switch( cmd.type ) {
+		case SOUND_COMMAND_STOP: {
+			idSoundChannel *chan = &emitter->channels[cmd.channel];
+			// if the channel was restarted in the meantime, the new trigger reuses the source
+			if ( !chan->triggerState ) {
+				chan->ALStop();
+			}
+			break;
+		}
+		case SOUND_COMMAND_PAUSE: {
+			for ( int i = 0; i < SOUND_MAX_CHANNELS; i++ ) {
+				idSoundChannel *chan = &emitter->channels[i];
+				if ( chan->triggerState && alIsSource( chan->openalSource ) ) {
+					alSourcePause( chan->openalSource );
+					chan->paused = true;
+				}
+			}
+			break;
+		}
+		case SOUND_COMMAND_UNPAUSE: {
+			for ( int i = 0; i < SOUND_MAX_CHANNELS; i++ ) {
+				idSoundChannel *chan = &emitter->channels[i];
+				if ( chan->triggerState && chan->paused && alIsSource( chan->openalSource ) ) {
+					alSourcePlay( chan->openalSource );
+					chan->paused = false;
+				}
+			}
+			break;
+		}
+	}
+}
+
+/*
+===================
+idSoundChannel::GetLoopSample
+
+The sample played after the leadin, NULL if the channel doesn't loop
+===================
+*/
+idSoundSample *idSoundChannel::GetLoopSample( void ) const {
+	if ( !soundShader || !( parms.soundShaderFlags & SSF_LOOPING ) ) {
+		return NULL;
+	}
+	return soundShader->entries[0];
+}
+
 /*
 ===================
 idSoundChannel::GatherChannelSamples
@@ -261,11 +382,23 @@ samples and leadins
 ===================
 */
 void idSoundChannel::GatherChannelSamples( int sampleOffset44k, int sampleCount44k, float *dest ) const {
+//Sys_DebugPrintf( "msec:%i sample:%i : %i : %i\n", Sys_Milliseconds(), soundSystemLocal.GetCurrent44kHzTime(), sampleOffset44k, sampleCount44k );	//!@#
+
+	GatherSamples( decoder, leadinSample, GetLoopSample(), sampleOffset44k, sampleCount44k, dest );
+}
+
+/*
+===================
+idSoundChannel::GatherSamples
+
+Does the work of GatherChannelSamples with any decoder, the stream decode thread
+uses it with a decoder of its own
+===================
+*/
+void idSoundChannel::GatherSamples( idSampleDecoder *decoder, idSoundSample *leadin, idSoundSample *loop, int sampleOffset44k, int sampleCount44k, float *dest ) {
 	float	*dest_p = dest;
 	int		len;
 
-//Sys_DebugPrintf( "msec:%i sample:%i : %i : %i\n", Sys_Milliseconds(), soundSystemLocal.GetCurrent44kHzTime(), sampleOffset44k, sampleCount44k );	//!@#
-
 	// negative offset times will just zero fill
 	if ( sampleOffset44k < 0 ) {
 		len = -sampleOffset44k;
@@ -279,7 +412,6 @@ void idSoundChannel::GatherChannelSamples( int sampleOffset44k, int sampleCount4
 	}
 
 	// grab part of the leadin sample
-	idSoundSample *leadin = leadinSample;
 	if ( !leadin || sampleOffset44k < 0 || sampleCount44k <= 0 ) {
 		memset( dest_p, 0, sampleCount44k * sizeof( dest_p[0] ) );
 		return;
@@ -300,14 +432,6 @@ void idSoundChannel::GatherChannelSamples( int sampleOffset44k, int sampleCount4
 	}
 
 	// if not looping, zero fill any remaining spots
-	if ( !soundShader || !( parms.soundShaderFlags & SSF_LOOPING ) ) {
-		memset( dest_p, 0, sampleCount44k * sizeof( dest_p[0] ) );
-		return;
-	}
-
-	// fill the remainder with looped samples
-	idSoundSample *loop = soundShader->entries[0];
-
 	if ( !loop ) {
 		memset( dest_p, 0, sampleCount44k * sizeof( dest_p[0] ) );
 		return;
@@ -345,6 +469,7 @@ idSoundEmitterLocal::idSoundEmitterLocal
 */
 idSoundEmitterLocal::idSoundEmitterLocal( void ) {
 	soundWorld = NULL;
+	areaBucket = -1;
 	Clear();
 }
 
@@ -373,7 +498,12 @@ void idSoundEmitterLocal::Clear( void ) {
 	removeStatus = REMOVE_STATUS_SAMPLEFINISHED;
 	distance = 0.0f;
 
+	if ( soundWorld ) {
+		soundWorld->UnlinkEmitter( this );
+	}
 	lastValidPortalArea = -1;
+	outOfReach = false;
+	portalPath.stamp = 0;
 
 	playing = false;
 	hasShakes = false;
@@ -439,6 +569,9 @@ void idSoundEmitterLocal::CheckForCompletion( int current44kHzTime ) {
 	hasActive = false;
 	hasShakes = false;
 
+	// stopping channels and freeing decoders changes what the mixer reads
+	Sys_EnterCriticalSection();
+
 	if ( playing ) {
 		for ( i = 0; i < SOUND_MAX_CHANNELS; i++ ) {
 			idSoundChannel	*chan = &channels[i];
@@ -471,12 +604,13 @@ void idSoundEmitterLocal::CheckForCompletion( int current44kHzTime ) {
 				} else if ( ( chan->trigger44kHzTime + chan->leadinSample->LengthIn44kHzSamples() < current44kHzTime ) || ( chan->stopped ) ) {
 					chan->Stop();
 
-					// free hardware resources
-					chan->ALStop();
-
 					// if this was an onDemand sound, purge the sample now
 					if ( chan->leadinSample->onDemand ) {
+						chan->ALStop();
 						chan->leadinSample->PurgeSoundSample();
+					} else {
+						// free hardware resources
+						soundSystemLocal.soundCommands.Push( SOUND_COMMAND_STOP, this, i );
 					}
 				}
 			}
@@ -502,6 +636,8 @@ void idSoundEmitterLocal::CheckForCompletion( int current44kHzTime ) {
 			removeStatus = REMOVE_STATUS_SAMPLEFINISHED;
 		}
 	}
+
+	Sys_LeaveCriticalSection();
 }
 
 /*
@@ -568,7 +704,13 @@ void idSoundEmitterLocal::Spatialize( idVec3 listenerPos, int listenerArea, idRe
 			return;
 		}
 
-		soundWorld->ResolveOrigin( 0, NULL, soundInArea, 0.0f, origin, this );
+		if ( !soundWorld->IsAreaReachable( soundInArea ) ) {
+			// more portals away than ResolveOrigin traces, it won't find a path either
+			distance = maxDistance;
+			return;
+		}
+
+		soundWorld->ResolveCachedOrigin( soundInArea, origin, this );
 		distance /= METERS_TO_DOOM;
 	} else {
 		// no portals available
@@ -577,6 +719,33 @@ void idSoundEmitterLocal::Spatialize( idVec3 listenerPos, int listenerArea, idRe
 	}
 }
 
+/*
+===================
+idSoundEmitterLocal::IgnoresPortals
+
+true if any playing channel is heard regardless of the portal distance to the listener
+===================
+*/
+bool idSoundEmitterLocal::IgnoresPortals( void ) const {
+	if ( !idSoundSystemLocal::s_useOcclusion.GetBool() ) {
+		return true;
+	}
+
+	// sounds from the listener itself are played as global
+	if ( listenerId == soundWorld->listenerPrivateId ) {
+		return true;
+	}
+
+	for ( int i = 0; i < SOUND_MAX_CHANNELS; i++ ) {
+		const idSoundChannel *chan = &channels[i];
+
+		if ( chan->triggerState && ( chan->parms.soundShaderFlags & ( SSF_GLOBAL | SSF_NO_OCCLUSION ) ) ) {
+			return true;
+		}
+	}
+	return false;
+}
+
 /*
 ===========================================================================================
 
@@ -612,6 +781,10 @@ void idSoundEmitterLocal::UpdateEmitter( const idVec3 &origin, int listenerId, c
 	this->listenerId = listenerId;
 	this->parms = *parms;
 
+	if ( soundWorld ) {
+		soundWorld->LinkEmitter( this );
+	}
+
 	// FIXME: change values on all channels?
 }
 
@@ -948,16 +1121,14 @@ void idSoundEmitterLocal::StopSound( const s_channelType channel ) {
 		// stop it
 		chan->Stop();
 
-		// free hardware resources
-		chan->ALStop();
-
 		// if this was an onDemand sound, purge the sample now
 		if ( chan->leadinSample->onDemand ) {
+			chan->ALStop();
 			chan->leadinSample->PurgeSoundSample();
+		} else {
+			// free hardware resources in the async update
+			soundSystemLocal.soundCommands.Push( SOUND_COMMAND_STOP, this, i );
 		}
-
-		chan->leadinSample = NULL;
-		chan->soundShader = NULL;
 	}
 
 	Sys_LeaveCriticalSection();
@@ -965,45 +1136,13 @@ void idSoundEmitterLocal::StopSound( const s_channelType channel ) {
 
 // DG: to pause active OpenAL sources when entering menu etc
 void idSoundEmitterLocal::PauseAll( void ) {
-
-	Sys_EnterCriticalSection();
-
-	for( int i = 0; i < SOUND_MAX_CHANNELS; i++ ) {
-		idSoundChannel	*chan = &channels[i];
-
-		if ( !chan->triggerState ) {
-			continue;
-		}
-
-		if ( alIsSource( chan->openalSource ) ) {
-			alSourcePause( chan->openalSource );
-			chan->paused = true;
-		}
-	}
-
-	Sys_LeaveCriticalSection();
+	soundSystemLocal.soundCommands.Push( SOUND_COMMAND_PAUSE, this, 0 );
 }
 
 
 // DG: to resume active OpenAL sources when leaving menu etc
 void idSoundEmitterLocal::UnPauseAll( void ) {
-
-	Sys_EnterCriticalSection();
-
-	for( int i = 0; i < SOUND_MAX_CHANNELS; i++ ) {
-		idSoundChannel	*chan = &channels[i];
-
-		if ( !chan->triggerState ) {
-			continue;
-		}
-
-		if ( alIsSource( chan->openalSource ) && chan->paused ) {
-			alSourcePlay( chan->openalSource );
-			chan->paused = false;
-		}
-	}
-
-	Sys_LeaveCriticalSection();
+	soundSystemLocal.soundCommands.Push( SOUND_COMMAND_UNPAUSE, this, 0 );
 }
 
 /*
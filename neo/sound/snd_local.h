@@ -40,6 +40,9 @@ If you have questions concerning this license or the applicable additional terms
 #include <AL/alc.h>
 #include <AL/alext.h>
 
+#include <mutex>
+#include <condition_variable>
+
 // DG: make this code build with older OpenAL headers that don't know about ALC_SOFT_HRTF
 //     which provides LPALCRESETDEVICESOFT for idSoundSystemLocal::alcResetDeviceSOFT()
 #ifndef ALC_SOFT_HRTF
@@ -96,6 +99,7 @@ typedef enum {
 } soundDemoCommand_t;
 
 const int SOUND_MAX_CHANNELS		= 8;
+const int SOUND_MAX_REAL_VOICES	= 256;		// channels mixed with an OpenAL source at the same time
 const int SOUND_DECODER_FREE_DELAY	= 1000 * MIXBUFFER_SAMPLES / USERCMD_MSEC;		// four seconds
 
 const int PRIMARYFREQ				= 44100;			// samples per second
@@ -361,6 +365,7 @@ enum {
 };
 
 class idSoundChannel;
+struct soundStream_s;
 
 class idSlowChannel {
 	bool					active;
@@ -404,6 +409,10 @@ public:
 	void				GatherChannelSamples( int sampleOffset44k, int sampleCount44k, float *dest ) const;
 	void				ALStop( void );			// free OpenAL resources if any
 
+						// decodes the leadin followed by the loop sample, loop may be NULL
+	static void			GatherSamples( idSampleDecoder *decoder, idSoundSample *leadin, idSoundSample *loop, int sampleOffset44k, int sampleCount44k, float *dest );
+	idSoundSample *		GetLoopSample( void ) const;
+
 	bool				triggerState;
 	int					trigger44kHzTime;		// hardware time sample the channel started
 	int					triggerGame44kHzTime;	// game time sample time the channel started
@@ -412,6 +421,7 @@ public:
 	s_channelType		triggerChannel;
 	const idSoundShader *soundShader;
 	idSampleDecoder *	decoder;
+	soundStream_s *		stream;					// read-ahead of a streamed channel, owned by soundSystemLocal.soundStreams
 	float				diversity;
 	float				lastVolume;				// last calculated volume based on distance
 	float				lastV[6];				// last calculated volume for each speaker, so we can smoothly fade
@@ -427,8 +437,35 @@ public:
 
 	bool				disallowSlow;
 
+	// set by the mixer: when more channels play than s_maxVoices allows, the least important
+	// ones lose their OpenAL source and keep advancing in time until they are audible again
+	float				voiceScore;				// estimated loudness times priority, from the last mix
+	bool				virtualVoice;			// currently played without an OpenAL source
+	bool				seekOnTrigger;			// start the source at the current play position
+
 };
 
+typedef struct soundPortalTrace_s {
+	int		portalArea;
+	int		portal;				// index of the portal out of portalArea that is being followed
+	const struct soundPortalTrace_s	*prevStack;
+} soundPortalTrace_t;
+
+const int MAX_PORTAL_TRACE_DEPTH = 10;	// ResolveOrigin doesn't look through more portals than this
+const float PORTAL_PATH_MOVE_DISTANCE = 16.0f;	// the chain is searched again once the emitter or listener moves this far
+
+// the shortest chain of portals from an emitter to the listener area
+typedef struct {
+	int		stamp;				// only valid while equal to idSoundWorldLocal::portalPathStamp
+	int		soundArea;
+	idVec3	soundOrigin;		// where the emitter and the listener were when the chain was searched
+	idVec3	listenerQU;
+	float	searchDistance;		// chains longer than this weren't looked at
+	int		numHops;			// -1 if no chain shorter than searchDistance exists
+	int		areas[MAX_PORTAL_TRACE_DEPTH];
+	int		portals[MAX_PORTAL_TRACE_DEPTH];
+} soundPortalPath_t;
+
 class idSoundEmitterLocal : public idSoundEmitter {
 public:
 
@@ -473,6 +510,7 @@ public:
 	void				OverrideParms( const soundShaderParms_t *base, const soundShaderParms_t *over, soundShaderParms_t *out );
 	void				CheckForCompletion( int current44kHzTime );
 	void				Spatialize( idVec3 listenerPos, int listenerArea, idRenderWorld *rw );
+	bool				IgnoresPortals( void ) const;
 
 	idSoundWorldLocal *	soundWorld;				// the world that holds this emitter
 
@@ -487,6 +525,9 @@ public:
 	// the following are calculated in UpdateEmitter, and don't need to be archived
 	float				maxDistance;				// greatest of all playing channel distances
 	int					lastValidPortalArea;		// so an emitter that slides out of the world continues playing
+	int					areaBucket;					// index in soundWorld->areaEmitters, -1 if not linked
+	bool				outOfReach;					// no portal chain to the listener is short enough, the mixer skips it
+	soundPortalPath_t	portalPath;					// last chain found by ResolveCachedOrigin
 	bool				playing;					// if false, no channel is active
 	bool				hasShakes;
 	idVec3				spatializedOrigin;			// the virtual sound origin, either the real sound origin,
@@ -514,6 +555,137 @@ public:
 };
 
 
+/*
+===================================================================================
+
+idSoundCommandQueue
+
+Single producer, single consumer ring that hands the OpenAL side of emitter channel
+operations from the game thread to the async sound update.  The game thread still
+changes the channel bookkeeping (triggerState, samples, parms) itself, under the
+critical section the mixer holds while it mixes, but freeing, pausing and resuming
+OpenAL sources is queued here and executed by the async update right before it
+mixes, so the game thread only holds the lock for the bookkeeping.
+
+===================================================================================
+*/
+
+typedef enum {
+	SOUND_COMMAND_STOP,				// free the OpenAL resources of a stopped channel
+	SOUND_COMMAND_PAUSE,			// pause all OpenAL sources of the emitter
+	SOUND_COMMAND_UNPAUSE			// resume the paused OpenAL sources of the emitter
+} soundCommandType_t;
+
+typedef struct {
+	soundCommandType_t		type;
+	idSoundEmitterLocal *	emitter;
+	int						channel;	// index in emitter->channels, unused for (un)pause
+} soundCommand_t;
+
+const int SOUND_COMMAND_QUEUE_SIZE	= 1024;		// must be a power of two
+
+class idSoundCommandQueue {
+public:
+							idSoundCommandQueue( void );
+
+							// only called from the game thread, executes the queued commands
+							// itself if the async update doesn't keep up
+	void					Push( soundCommandType_t type, idSoundEmitterLocal *emitter, int channel );
+							// executes all queued commands, called from the async update and
+							// from the game thread before emitters are cleared or deleted
+	void					Drain( void );
+
+	int						GetNumOverflows( void ) const { return numOverflows; }
+
+private:
+	soundCommand_t			commands[SOUND_COMMAND_QUEUE_SIZE];
+	std::atomic<int>		head;			// next command to execute, only advanced by the consumer
+	std::atomic<int>		tail;			// next free slot, only advanced by the producer
+	int						numOverflows;
+
+	static void				Execute( const soundCommand_t &cmd );
+};
+
+
+/*
+===================================================================================
+
+idSoundStreamManager
+
+Read-ahead for the channels that are streamed into OpenAL buffers, which are the
+samples longer than s_decompressionLimit and looping sounds with a leadin.  A decode
+thread keeps the next s_streamReadAhead mix blocks of every stream decoded with its
+own decoders, so the async update only copies them instead of decoding inside the
+mix.  A block the decode thread didn't get to yet is decoded by the mixer as before.
+
+===================================================================================
+*/
+
+const int SOUND_MAX_STREAMS				= 16;
+const int SOUND_STREAM_BLOCKS			= 8;						// upper bound of s_streamReadAhead
+const int SOUND_STREAM_BLOCK_FLOATS		= MIXBUFFER_SAMPLES * 2;	// one mix block of a stereo sample
+
+typedef struct soundStream_s {
+	idSoundChannel *		owner;				// NULL if the stream is free
+	idSoundSample *			leadin;
+	idSoundSample *			loop;				// NULL if the channel doesn't loop
+	idSampleDecoder *		decoder;			// only used by the decode thread
+	int						blockSize;			// floats per block
+	int						startOffset;		// block offsets are startOffset plus a multiple of blockSize
+	int						readOffset;			// next offset the mixer will ask for
+	int						nextOffset;			// next offset the decode thread will decode
+	int						generation;			// changes whenever blocks in flight have to be dropped
+	bool					decoding;			// the decode thread is filling a block without the lock
+	idSoundSample *			decodingLeadin;		// the samples of that block, Restart may have changed leadin and loop
+	idSoundSample *			decodingLoop;
+	int						blockOffsets[SOUND_STREAM_BLOCKS];
+	bool					blockReady[SOUND_STREAM_BLOCKS];
+	float *					blocks;				// SOUND_STREAM_BLOCKS * SOUND_STREAM_BLOCK_FLOATS
+} soundStream_t;
+
+class idSoundStreamManager {
+public:
+							idSoundStreamManager( void );
+							~idSoundStreamManager( void );
+
+	void					Init( void );
+	void					Shutdown( void );
+
+							// called by the mixer for the next block of a streamed channel, returns false
+							// if the block isn't decoded yet and the caller has to decode it itself
+	bool					Read( idSoundChannel *chan, int sampleOffset44k, int sampleCount44k, float *dest );
+							// detaches the stream of a channel, called from ALStop
+	void					Release( idSoundChannel *chan );
+							// called before the data of a sample is freed
+	void					ReleaseSample( const idSoundSample *sample );
+
+	int						GetNumStreams( void ) const;
+	int						GetNumHits( void ) const { return numHits; }
+	int						GetNumMisses( void ) const { return numMisses; }
+
+private:
+	soundStream_t			streams[SOUND_MAX_STREAMS];
+	float *					blockMemory;
+	int						numHits;
+	int						numMisses;
+
+	std::thread				thread;
+	bool					threadRunning;
+	mutable std::mutex		mutex;
+	std::condition_variable	wakeUp;				// signaled when the decode thread may have work
+	std::condition_variable	blockDone;			// signaled when the decode thread finished a block
+	bool					quit;
+	int						nextStream;			// round robin start for the decode thread
+
+	soundStream_t *			Acquire( idSoundChannel *chan );
+	void					Restart( soundStream_t *stream, idSoundChannel *chan, int sampleOffset44k, int sampleCount44k );
+	void					WaitForDecode( soundStream_t *stream, std::unique_lock<std::mutex> &lock );
+	soundStream_t *			FindWork( int readAhead );
+	void					DecodeLoop( void );
+	static void				DecodeThread( idSoundStreamManager *manager );
+};
+
+
 /*
 ===================================================================================
 
@@ -540,11 +712,6 @@ public:
 	int		activeSounds;
 };
 
-typedef struct soundPortalTrace_s {
-	int		portalArea;
-	const struct soundPortalTrace_s	*prevStack;
-} soundPortalTrace_t;
-
 class idSoundWorldLocal : public idSoundWorld {
 public:
 	virtual					~idSoundWorldLocal( void );
@@ -618,10 +785,19 @@ public:
 	void					AddChannelContribution( idSoundEmitterLocal *sound, idSoundChannel *chan,
 												int current44kHz, int numSpeakers, float *finalMixBuffer );
 	void					MixLoop( int current44kHz, int numSpeakers, float *finalMixBuffer );
+	float					VoiceScore( idSoundEmitterLocal *sound, idSoundChannel *chan, int current44kHz );
+	float					FindVoiceThreshold( int maxVoices, int current44kHz, int &numAbove );
 	void					AVIUpdate( void );
-	void					ResolveOrigin( const int stackDepth, const soundPortalTrace_t *prevStack, const int soundArea, const float dist, const idVec3& soundOrigin, idSoundEmitterLocal *def );
+	void					ResolveOrigin( const int stackDepth, const soundPortalTrace_t *prevStack, const int soundArea, const float dist, const idVec3& soundOrigin, idSoundEmitterLocal *def, soundPortalPath_t *path = NULL );
+	void					ResolveCachedOrigin( const int soundArea, const idVec3& soundOrigin, idSoundEmitterLocal *def );
 	float					FindAmplitude( idSoundEmitterLocal *sound, const int localTime, const idVec3 *listenerPosition, const s_channelType channel, bool shakesOnly );
 
+	void					LinkEmitter( idSoundEmitterLocal *def );
+	void					UnlinkEmitter( idSoundEmitterLocal *def );
+	void					RelinkAllEmitters( void );
+	void					FindReachableAreas( void );
+	bool					IsAreaReachable( int area ) const;
+
 	//============================================
 
 	idRenderWorld *			rw;				// for portals and debug drawing
@@ -646,6 +822,19 @@ public:
 
 	idList<idSoundEmitterLocal *>emitters;
 
+	// emitters bucketed by the portal area of their origin, the first bucket holds the ones
+	// outside the world.  Only the game thread touches these.
+	idList< idList<idSoundEmitterLocal *> > areaEmitters;
+	idList<int>				areaReachCount;		// equals reachCount for the areas the listener can reach
+	idList<int>				reachableAreas;		// areas reached by the last FindReachableAreas
+	int						reachCount;
+
+	// bumped to throw away the portal chains of all emitters when the listener changes
+	// area, a portal changes state or the map changes
+	int						portalPathStamp;
+	int						portalPathListenerArea;
+	int						portalPathStateCount;		// rw->GetPortalStateCount() when the chains were found
+
 	idSoundFade				soundClassFade[SOUND_MAX_CLASSES];	// for global sound fading
 
 	// avi stuff
@@ -757,6 +946,9 @@ public:
 
 	idSoundWorldLocal *		currentSoundWorld;	// the one to mix each async tic
 
+	idSoundCommandQueue		soundCommands;		// emitter operations waiting for the async tic
+	idSoundStreamManager	soundStreams;		// read-ahead decoding of streamed channels
+
 	int						olddwCurrentWritePos;	// statistics
 	int						buffers;				// statistics
 	int						CurrentSoundTime;		// set by the async thread and only used by the main thread
@@ -843,6 +1035,9 @@ public:
 	static idCVar			s_globalFraction;
 	static idCVar			s_doorDistanceAdd;
 	static idCVar			s_singleEmitter;
+	static idCVar			s_maxVoices;
+	static idCVar			s_cachePortalPaths;
+	static idCVar			s_streamReadAhead;
 	static idCVar			s_numberOfSpeakers;
 	static idCVar			s_force22kHz;
 	static idCVar			s_clipVolumes;
@@ -926,6 +1121,7 @@ public:
 	static void				Init( void );
 	static void				Shutdown( void );
 	static idSampleDecoder *Alloc( void );
+	static idSampleDecoder *AllocPrivate( void );	// for decoders only one thread ever uses
 	static void				Free( idSampleDecoder *decoder );
 	static int				GetNumUsedBlocks( void );
 	static int				GetUsedBlockMemory( void );
@@ -0,0 +1,384 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code ("Doom 3 Source Code").
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "precompiled.h"
+#pragma hdrstop
+
+#include "snd_local.h"
+
+/*
+===================
+idSoundStreamManager::idSoundStreamManager
+===================
+*/
+idSoundStreamManager::idSoundStreamManager( void ) {
+	memset( streams, 0, sizeof( streams ) );
+	blockMemory = NULL;
+	numHits = 0;
+	numMisses = 0;
+	threadRunning = false;
+	quit = false;
+	nextStream = 0;
+}
+
+/*
+===================
+idSoundStreamManager::~idSoundStreamManager
+
+Exiting through an error doesn't call Shutdown(), and destroying
+a running std::thread would terminate the process.
+===================
+*/
+idSoundStreamManager::~idSoundStreamManager( void ) {
+	if ( threadRunning ) {
+		thread.detach();
+	}
+}
+
+/*
+===================
+idSoundStreamManager::Init
+===================
+*/
+void idSoundStreamManager::Init( void ) {
+	blockMemory = (float *)Mem_Alloc16( SOUND_MAX_STREAMS * SOUND_STREAM_BLOCKS * SOUND_STREAM_BLOCK_FLOATS * sizeof( float ) );
+
+	for ( int i = 0; i < SOUND_MAX_STREAMS; i++ ) {
+		soundStream_t *stream = &streams[i];
+		memset( stream, 0, sizeof( *stream ) );
+		stream->decoder = idSampleDecoder::AllocPrivate();
+		stream->blocks = blockMemory + i * SOUND_STREAM_BLOCKS * SOUND_STREAM_BLOCK_FLOATS;
+	}
+
+	numHits = 0;
+	numMisses = 0;
+	quit = false;
+	nextStream = 0;
+	thread = std::thread( DecodeThread, this );
+	threadRunning = true;
+}
+
+/*
+===================
+idSoundStreamManager::Shutdown
+===================
+*/
+void idSoundStreamManager::Shutdown( void ) {
+	if ( !threadRunning ) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		quit = true;
+	}
+	wakeUp.notify_all();
+	thread.join();
+	threadRunning = false;
+
+	for ( int i = 0; i < SOUND_MAX_STREAMS; i++ ) {
+		soundStream_t *stream = &streams[i];
+		if ( stream->owner ) {
+			stream->owner->stream = NULL;
+		}
+		idSampleDecoder::Free( stream->decoder );
+		memset( stream, 0, sizeof( *stream ) );
+	}
+
+	Mem_Free16( blockMemory );
+	blockMemory = NULL;
+}
+
+/*
+===================
+idSoundStreamManager::Acquire
+
+The mutex must be held.
+===================
+*/
+soundStream_t *idSoundStreamManager::Acquire( idSoundChannel *chan ) {
+	for ( int i = 0; i < SOUND_MAX_STREAMS; i++ ) {
+		soundStream_t *stream = &streams[i];
+		if ( stream->owner == NULL && !stream->decoding ) {
+			stream->owner = chan;
+			stream->leadin = NULL;
+			stream->loop = NULL;
+			chan->stream = stream;
+			return stream;
+		}
+	}
+	return NULL;
+}
+
+/*
+===================
+idSoundStreamManager::Restart
+
+Drop everything decoded so far and continue decoding at the given offset.
+The mutex must be held.
+===================
+*/
+void idSoundStreamManager::Restart( soundStream_t *stream, idSoundChannel *chan, int sampleOffset44k, int sampleCount44k ) {
+	stream->leadin = chan->leadinSample;
+	stream->loop = chan->GetLoopSample();
+	stream->blockSize = sampleCount44k;
+	stream->startOffset = sampleOffset44k;
+	stream->readOffset = sampleOffset44k;
+	stream->nextOffset = sampleOffset44k;
+	stream->generation++;
+	memset( stream->blockReady, 0, sizeof( stream->blockReady ) );
+}
+
+/*
+===================
+idSoundStreamManager::Read
+===================
+*/
+bool idSoundStreamManager::Read( idSoundChannel *chan, int sampleOffset44k, int sampleCount44k, float *dest ) {
+	if ( !threadRunning || idSoundSystemLocal::s_streamReadAhead.GetInteger() <= 0 ) {
+		return false;
+	}
+	if ( chan->leadinSample == NULL || sampleCount44k <= 0 || sampleCount44k > SOUND_STREAM_BLOCK_FLOATS ) {
+		return false;
+	}
+
+	std::unique_lock<std::mutex> lock( mutex );
+
+	soundStream_t *stream = chan->stream;
+	if ( stream == NULL ) {
+		stream = Acquire( chan );
+		if ( stream == NULL ) {
+			// all streams are in use, the mixer decodes this channel itself
+			return false;
+		}
+	}
+
+	// a new sound on the channel, a seek, or a block size the stream wasn't set up for
+	if ( stream->leadin != chan->leadinSample || stream->loop != chan->GetLoopSample()
+			|| stream->blockSize != sampleCount44k || sampleOffset44k != stream->readOffset ) {
+		// the caller decodes this block, read ahead from the one after it
+		Restart( stream, chan, sampleOffset44k + sampleCount44k, sampleCount44k );
+		numMisses++;
+		lock.unlock();
+		wakeUp.notify_one();
+		return false;
+	}
+
+	int slot = ( ( sampleOffset44k - stream->startOffset ) / stream->blockSize ) % SOUND_STREAM_BLOCKS;
+	stream->readOffset += sampleCount44k;
+
+	if ( !stream->blockReady[slot] || stream->blockOffsets[slot] != sampleOffset44k ) {
+		// the decode thread fell behind, skip the block it didn't get to
+		if ( stream->nextOffset < stream->readOffset ) {
+			stream->nextOffset = stream->readOffset;
+		}
+		numMisses++;
+		lock.unlock();
+		wakeUp.notify_one();
+		return false;
+	}
+
+	memcpy( dest, stream->blocks + slot * SOUND_STREAM_BLOCK_FLOATS, sampleCount44k * sizeof( dest[0] ) );
+	stream->blockReady[slot] = false;
+	numHits++;
+	lock.unlock();
+	wakeUp.notify_one();
+	return true;
+}
+
+/*
+===================
+idSoundStreamManager::WaitForDecode
+
+The lock must be held on the mutex.
+===================
+*/
+void idSoundStreamManager::WaitForDecode( soundStream_t *stream, std::unique_lock<std::mutex> &lock ) {
+	while ( stream->decoding ) {
+		blockDone.wait( lock );
+	}
+}
+
+/*
+===================
+idSoundStreamManager::Release
+
+Called from ALStop, which the mixer also uses for culled channels, so it doesn't block.
+===================
+*/
+void idSoundStreamManager::Release( idSoundChannel *chan ) {
+	std::unique_lock<std::mutex> lock( mutex );
+
+	soundStream_t *stream = chan->stream;
+	if ( stream == NULL ) {
+		return;
+	}
+	chan->stream = NULL;
+	if ( stream->owner != chan ) {
+		return;
+	}
+
+	// the mixer doesn't wait for a block in flight, the decode thread drops it and clears
+	// the decoder itself
+	stream->owner = NULL;
+	stream->generation++;
+	if ( !stream->decoding ) {
+		// don't keep the stb_vorbis state of the sample around
+		stream->decoder->ClearDecoder();
+	}
+}
+
+/*
+===================
+idSoundStreamManager::ReleaseSample
+
+Streams of the sample start over with the next Read, and the decode thread
+won't touch the sample data anymore once this returns.
+===================
+*/
+void idSoundStreamManager::ReleaseSample( const idSoundSample *sample ) {
+	std::unique_lock<std::mutex> lock( mutex );
+
+	for ( int i = 0; i < SOUND_MAX_STREAMS; i++ ) {
+		soundStream_t *stream = &streams[i];
+		if ( stream->leadin == sample || stream->loop == sample ) {
+			stream->leadin = NULL;
+			stream->loop = NULL;
+			stream->generation++;
+		}
+		if ( stream->decoding && ( stream->decodingLeadin == sample || stream->decodingLoop == sample ) ) {
+			WaitForDecode( stream, lock );
+		}
+		// the stb_vorbis state points into the sample data
+		if ( !stream->decoding && stream->decoder != NULL && stream->decoder->GetSample() == sample ) {
+			stream->decoder->ClearDecoder();
+		}
+	}
+}
+
+/*
+===================
+idSoundStreamManager::GetNumStreams
+===================
+*/
+int idSoundStreamManager::GetNumStreams( void ) const {
+	std::lock_guard<std::mutex> lock( mutex );
+
+	int num = 0;
+	for ( int i = 0; i < SOUND_MAX_STREAMS; i++ ) {
+		if ( streams[i].owner != NULL ) {
+			num++;
+		}
+	}
+	return num;
+}
+
+/*
+===================
+idSoundStreamManager::FindWork
+
+Round robin over the streams that are less than readAhead blocks ahead of the mixer,
+so one stream can't starve the others.  The mutex must be held.
+===================
+*/
+soundStream_t *idSoundStreamManager::FindWork( int readAhead ) {
+	for ( int i = 0; i < SOUND_MAX_STREAMS; i++ ) {
+		soundStream_t *stream = &streams[( nextStream + i ) % SOUND_MAX_STREAMS];
+		if ( stream->owner == NULL || stream->leadin == NULL || stream->decoding ) {
+			continue;
+		}
+		if ( stream->nextOffset - stream->readOffset >= readAhead * stream->blockSize ) {
+			continue;
+		}
+		nextStream = ( nextStream + i + 1 ) % SOUND_MAX_STREAMS;
+		return stream;
+	}
+	return NULL;
+}
+
+/*
+===================
+idSoundStreamManager::DecodeLoop
+===================
+*/
+void idSoundStreamManager::DecodeLoop( void ) {
+	std::unique_lock<std::mutex> lock( mutex );
+
+	while ( 1 ) {
+		soundStream_t *stream;
+		int readAhead = idMath::ClampInt( 0, SOUND_STREAM_BLOCKS, idSoundSystemLocal::s_streamReadAhead.GetInteger() );
+		while ( !quit && ( stream = FindWork( readAhead ) ) == NULL ) {
+			wakeUp.wait( lock );
+			readAhead = idMath::ClampInt( 0, SOUND_STREAM_BLOCKS, idSoundSystemLocal::s_streamReadAhead.GetInteger() );
+		}
+		if ( quit ) {
+			return;
+		}
+
+		int offset = stream->nextOffset;
+		int count = stream->blockSize;
+		int generation = stream->generation;
+		int slot = ( ( offset - stream->startOffset ) / count ) % SOUND_STREAM_BLOCKS;
+		idSoundSample *leadin = stream->leadin;
+		idSoundSample *loop = stream->loop;
+		float *block = stream->blocks + slot * SOUND_STREAM_BLOCK_FLOATS;
+
+		stream->nextOffset += count;
+		stream->blockReady[slot] = false;
+		stream->decoding = true;
+		stream->decodingLeadin = leadin;
+		stream->decodingLoop = loop;
+
+		// ReleaseSample() waits for decoding to be cleared, so the samples
+		// can't be purged while they are decoded without the lock
+		lock.unlock();
+		idSoundChannel::GatherSamples( stream->decoder, leadin, loop, offset, count, block );
+		lock.lock();
+
+		stream->decoding = false;
+		stream->decodingLeadin = NULL;
+		stream->decodingLoop = NULL;
+		if ( stream->owner == NULL ) {
+			// released while decoding
+			stream->decoder->ClearDecoder();
+		} else if ( stream->generation == generation && offset >= stream->readOffset ) {
+			stream->blockOffsets[slot] = offset;
+			stream->blockReady[slot] = true;
+		}
+		blockDone.notify_all();
+	}
+}
+
+/*
+===================
+idSoundStreamManager::DecodeThread
+===================
+*/
+void idSoundStreamManager::DecodeThread( idSoundStreamManager *manager ) {
+	manager->DecodeLoop();
+}
@@ -58,6 +58,9 @@ idCVar idSoundSystemLocal::s_subFraction( "s_subFraction", "0.75", CVAR_SOUND |
 idCVar idSoundSystemLocal::s_globalFraction( "s_globalFraction", "0.8", CVAR_SOUND | CVAR_ARCHIVE | CVAR_FLOAT, "volume to all speakers when not spatialized" );
 idCVar idSoundSystemLocal::s_doorDistanceAdd( "s_doorDistanceAdd", "150", CVAR_SOUND | CVAR_ARCHIVE | CVAR_FLOAT, "reduce sound volume with this distance when going through a door" );
 idCVar idSoundSystemLocal::s_singleEmitter( "s_singleEmitter", "0", CVAR_SOUND | CVAR_INTEGER, "mute all sounds but this emitter" );
+idCVar idSoundSystemLocal::s_cachePortalPaths( "s_cachePortalPaths", "1", CVAR_SOUND | CVAR_BOOL, "reuse the portal chain of an emitter to the listener area until either moves, the listener changes area or a door opens or closes" );
+idCVar idSoundSystemLocal::s_streamReadAhead( "s_streamReadAhead", "4", CVAR_SOUND | CVAR_INTEGER | CVAR_ARCHIVE, "number of mix blocks the decode thread keeps decoded ahead of streamed sounds, 0 = decode them in the mixer", 0, SOUND_STREAM_BLOCKS );
+idCVar idSoundSystemLocal::s_maxVoices( "s_maxVoices", "64", CVAR_SOUND | CVAR_INTEGER | CVAR_ARCHIVE, "number of channels mixed with an OpenAL source, quieter and less important channels play virtually. 0 = no limit", 0, SOUND_MAX_REAL_VOICES );
 idCVar idSoundSystemLocal::s_numberOfSpeakers( "s_numberOfSpeakers", "2", CVAR_SOUND | CVAR_ARCHIVE, "number of speakers" );
 idCVar idSoundSystemLocal::s_force22kHz( "s_force22kHz", "0", CVAR_SOUND | CVAR_BOOL, ""  );
 idCVar idSoundSystemLocal::s_clipVolumes( "s_clipVolumes", "1", CVAR_SOUND | CVAR_BOOL, ""  );
@@ -287,6 +290,9 @@ void ListSoundDecoders_f( const idCmdArgs &args ) {
 	common->Printf( "%d waiting decoders\n", numWaitingDecoders );
 	common->Printf( "%d active decoders\n", numActiveDecoders );
 	common->Printf( "%d kB decoder memory in %d blocks\n", idSampleDecoder::GetUsedBlockMemory() >> 10, idSampleDecoder::GetNumUsedBlocks() );
+	common->Printf( "%d read-ahead streams, %d blocks decoded ahead, %d decoded in the mixer\n", soundSystemLocal.soundStreams.GetNumStreams(),
+					soundSystemLocal.soundStreams.GetNumHits(), soundSystemLocal.soundStreams.GetNumMisses() );
+	common->Printf( "%d times the sound command queue was full and drained on the game thread\n", soundSystemLocal.soundCommands.GetNumOverflows() );
 }
 
 /*
@@ -463,6 +469,7 @@ void idSoundSystemLocal::Init() {
 	if ( openalContext != NULL )
 	{
 		idSampleDecoder::Init();
+		soundStreams.Init();
 		soundCache = new idSoundCache();
 
 		alcMakeContextCurrent( openalContext );
@@ -592,6 +599,9 @@ void idSoundSystemLocal::Shutdown() {
 		openalSources[i].looping = false;
 	}
 
+	// the decode thread may still read sample data
+	soundStreams.Shutdown();
+
 	// destroy all the sounds (hardware buffers as well)
 	delete soundCache;
 	soundCache = NULL;
@@ -787,11 +797,19 @@ int idSoundSystemLocal::AsyncMix( int soundTime, float *mixBuffer ) {
 	inTime = Sys_Milliseconds();
 	numSpeakers = s_numberOfSpeakers.GetInteger();
 
+	// the game thread changes channels under the same lock
+	Sys_EnterCriticalSection();
+
+	// run the emitter operations the game thread queued since the last tic
+	soundCommands.Drain();
+
 	// let the active sound world mix all the channels in unless muted or avi demo recording
 	if ( !muted && currentSoundWorld && !currentSoundWorld->fpa[0] ) {
 		currentSoundWorld->MixLoop( soundTime, numSpeakers, mixBuffer );
 	}
 
+	Sys_LeaveCriticalSection();
+
 	CurrentSoundTime = soundTime;
 
 	return Sys_Milliseconds() - inTime;
@@ -862,11 +880,19 @@ int idSoundSystemLocal::AsyncUpdate( int inTime ) {
 	// enable audio hardware caching
 	alcSuspendContext( openalContext );
 
+	// the game thread changes channels under the same lock
+	Sys_EnterCriticalSection();
+
+	// run the emitter operations the game thread queued since the last tic
+	soundCommands.Drain();
+
 	// let the active sound world mix all the channels in unless muted or avi demo recording
 	if ( !muted && currentSoundWorld && !currentSoundWorld->fpa[0] ) {
 		currentSoundWorld->MixLoop( newSoundTime, numSpeakers, finalMixBuffer );
 	}
 
+	Sys_LeaveCriticalSection();
+
 	// disable audio hardware caching (this updates ALL settings since last alcSuspendContext)
 	alcProcessContext( openalContext );
 
@@ -912,11 +938,19 @@ int idSoundSystemLocal::AsyncUpdateWrite( int inTime ) {
 	// enable audio hardware caching
 	alcSuspendContext( openalContext );
 
+	// the game thread changes channels under the same lock
+	Sys_EnterCriticalSection();
+
+	// run the emitter operations the game thread queued since the last tic
+	soundCommands.Drain();
+
 	// let the active sound world mix all the channels in unless muted or avi demo recording
 	if ( !muted && currentSoundWorld && !currentSoundWorld->fpa[0] ) {
 		currentSoundWorld->MixLoop( sampleTime, numSpeakers, finalMixBuffer );
 	}
 
+	Sys_LeaveCriticalSection();
+
 	// disable audio hardware caching (this updates ALL settings since last alcSuspendContext)
 	alcProcessContext( openalContext );
 
@@ -110,6 +110,15 @@ void idSoundWorldLocal::Init( idRenderWorld *renderWorld ) {
 	idSoundEmitterLocal	*placeHolder = new idSoundEmitterLocal;
 	emitters.Append( placeHolder );
 
+	areaEmitters.Clear();
+	areaReachCount.Clear();
+	reachableAreas.Clear();
+	reachCount = 0;
+
+	portalPathStamp = 1;
+	portalPathListenerArea = -1;
+	portalPathStateCount = 0;
+
 	fpa[0] = fpa[1] = fpa[2] = fpa[3] = fpa[4] = fpa[5] = NULL;
 
 	aviDemoPath = "";
@@ -157,6 +166,9 @@ void idSoundWorldLocal::Shutdown() {
 		soundSystemLocal.currentSoundWorld = NULL;
 	}
 
+	// queued commands must not outlive the emitters they point to
+	soundSystemLocal.soundCommands.Drain();
+
 	AVIClose();
 
 	// delete emitters before deletign the listenerSlot, so their sources aren't
@@ -167,6 +179,7 @@ void idSoundWorldLocal::Shutdown() {
 			emitters[i] = NULL;
 		}
 	}
+	areaEmitters.Clear();
 
 	if (idSoundSystemLocal::useEFXReverb) {
 		if (soundSystemLocal.alIsAuxiliaryEffectSlot(listenerSlot)) {
@@ -200,6 +213,8 @@ void idSoundWorldLocal::ClearAllSoundEmitters() {
 
 	Sys_EnterCriticalSection();
 
+	soundSystemLocal.soundCommands.Drain();
+
 	AVIClose();
 
 	for ( i = 0; i < emitters.Num(); i++ ) {
@@ -208,6 +223,11 @@ void idSoundWorldLocal::ClearAllSoundEmitters() {
 	}
 	localSound = NULL;
 
+	// this is called on every map change, the render world may have been loaded
+	// with a different map that happens to have the same number of areas
+	RelinkAllEmitters();
+	portalPathListenerArea = -1;
+
 	Sys_LeaveCriticalSection();
 }
 
@@ -255,6 +275,7 @@ idSoundEmitterLocal *idSoundWorldLocal::AllocLocalSoundEmitter() {
 	def->index = index;
 	def->removeStatus = REMOVE_STATUS_ALIVE;
 	def->soundWorld = this;
+	LinkEmitter( def );
 
 	return def;
 }
@@ -585,6 +606,15 @@ void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *final
 		return;
 	}
 
+	// only the most important channels get an OpenAL source, the others play virtually
+	int maxVoices = idSoundSystemLocal::s_maxVoices.GetInteger();
+	int numAbove = 0;
+	float voiceThreshold = -1.0f;
+	if ( maxVoices > 0 ) {
+		voiceThreshold = FindVoiceThreshold( maxVoices, current44kHz, numAbove );
+	}
+	int tiesLeft = maxVoices - numAbove;
+
 	for ( i = 1; i < emitters.Num(); i++ ) {
 		sound = emitters[i];
 
@@ -605,6 +635,38 @@ void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *final
 				continue;
 			}
 
+			// too many portals away to be heard, play it virtually
+			if ( sound->outOfReach ) {
+				if ( !chan->virtualVoice ) {
+					chan->ALStop();
+					chan->virtualVoice = true;
+				}
+				continue;
+			}
+
+			if ( voiceThreshold >= 0.0f ) {
+				bool real = ( chan->voiceScore > voiceThreshold );
+				if ( !real && chan->voiceScore == voiceThreshold && tiesLeft > 0 ) {
+					tiesLeft--;
+					real = true;
+				}
+				if ( !real ) {
+					// give up the source, the play position keeps advancing with the sound time
+					if ( !chan->virtualVoice ) {
+						chan->ALStop();
+						chan->virtualVoice = true;
+					}
+					continue;
+				}
+			}
+
+			if ( chan->virtualVoice ) {
+				// audible again, restart the source where the sound would be by now
+				chan->virtualVoice = false;
+				chan->seekOnTrigger = true;
+				chan->triggered = true;
+			}
+
 			AddChannelContribution( sound, chan, current44kHz, numSpeakers, finalMixBuffer );
 		}
 	}
@@ -615,6 +677,115 @@ void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *final
 	}
 }
 
+/*
+===================
+idSoundWorldLocal::VoiceScore
+
+Rough estimate of how loud the channel is at the listener, weighted by how much the
+player would miss it.  Only used to rank channels when there are more than s_maxVoices.
+===================
+*/
+static const float VOICE_PRIORITY_LISTENER	= 4.0f;		// the player's own weapons, footsteps and voice
+static const float VOICE_PRIORITY_GLOBAL	= 2.0f;		// music, announcements and other unspatialized sounds
+static const float VOICE_KEEP_BIAS			= 1.25f;	// so channels near the cut don't flip every mix
+
+float idSoundWorldLocal::VoiceScore( idSoundEmitterLocal *sound, idSoundChannel *chan, int current44kHz ) {
+	const soundShaderParms_t *parms = &chan->parms;
+	bool fromListener = ( sound->listenerId == listenerPrivateId );
+
+	if ( ( parms->soundShaderFlags & SSF_PRIVATE_SOUND ) && !fromListener ) {
+		return 0.0f;
+	}
+	if ( ( parms->soundShaderFlags & SSF_ANTI_PRIVATE_SOUND ) && fromListener ) {
+		return 0.0f;
+	}
+
+	float volume = soundSystemLocal.dB2Scale( parms->volume );
+	volume *= soundSystemLocal.dB2Scale( chan->channelFade.FadeDbAt44kHz( current44kHz ) );
+	volume *= soundSystemLocal.dB2Scale( soundClassFade[parms->soundClass].FadeDbAt44kHz( current44kHz ) );
+
+	if ( fromListener ) {
+		volume *= VOICE_PRIORITY_LISTENER;
+	} else if ( parms->soundShaderFlags & SSF_GLOBAL ) {
+		volume *= VOICE_PRIORITY_GLOBAL;
+	} else {
+		// same linear falloff as AddChannelContribution, which is good enough for ranking
+		bool noOcclusion = ( parms->soundShaderFlags & SSF_NO_OCCLUSION ) || !idSoundSystemLocal::s_useOcclusion.GetBool();
+		float dlen = noOcclusion ? sound->realDistance : sound->distance;
+		float mind = parms->minDistance;
+		float maxd = parms->maxDistance;
+
+		if ( dlen >= maxd ) {
+			return 0.0f;
+		}
+		if ( dlen > mind ) {
+			volume *= 1.0f - ( dlen - mind ) / ( maxd - mind );
+		}
+	}
+
+	if ( !chan->virtualVoice ) {
+		volume *= VOICE_KEEP_BIAS;
+	}
+
+	return volume;
+}
+
+/*
+===================
+idSoundWorldLocal::FindVoiceThreshold
+
+Scores all triggered channels and returns the score of the maxVoices-th best one,
+or -1 if there are no more channels than voices.  numAbove is set to the number of
+channels that score strictly better than the threshold.
+===================
+*/
+float idSoundWorldLocal::FindVoiceThreshold( int maxVoices, int current44kHz, int &numAbove ) {
+	float best[SOUND_MAX_REAL_VOICES];
+	int numBest = 0;
+
+	maxVoices = Min( maxVoices, SOUND_MAX_REAL_VOICES );
+	numAbove = 0;
+
+	for ( int i = 1; i < emitters.Num(); i++ ) {
+		idSoundEmitterLocal *sound = emitters[i];
+
+		if ( !sound || !sound->playing || sound->outOfReach ) {
+			continue;
+		}
+		for ( int j = 0; j < SOUND_MAX_CHANNELS; j++ ) {
+			idSoundChannel *chan = &sound->channels[j];
+
+			if ( !chan->triggerState ) {
+				continue;
+			}
+
+			float score = VoiceScore( sound, chan, current44kHz );
+			chan->voiceScore = score;
+
+			if ( numBest == maxVoices && score <= best[numBest - 1] ) {
+				continue;
+			}
+
+			// insertion into the sorted list, best first
+			int k = ( numBest < maxVoices ) ? numBest++ : numBest - 1;
+			for ( ; k > 0 && best[k - 1] < score; k-- ) {
+				best[k] = best[k - 1];
+			}
+			best[k] = score;
+		}
+	}
+
+	if ( numBest < maxVoices ) {
+		return -1.0f;
+	}
+
+	float threshold = best[maxVoices - 1];
+	while ( numAbove < maxVoices && best[numAbove] > threshold ) {
+		numAbove++;
+	}
+	return threshold;
+}
+
 //==============================================================================
 
 /*
@@ -668,7 +839,11 @@ void idSoundWorldLocal::AVIUpdate() {
 
 	SIMDProcessor->Memset( mix_p, 0, MIXBUFFER_SAMPLES*sizeof(float)*numSpeakers );
 
+	// the async update doesn't mix while recording, run the queued commands here
+	Sys_EnterCriticalSection();
+	soundSystemLocal.soundCommands.Drain();
 	MixLoop( lastAVI44kHz, numSpeakers, mix_p );
+	Sys_LeaveCriticalSection();
 
 	for ( int i = 0; i < numSpeakers; i++ ) {
 		short outD[MIXBUFFER_SAMPLES];
@@ -790,6 +965,103 @@ void idSoundWorldLocal::AVIClose( void ) {
 //==============================================================================
 
 
+/*
+===================
+PortalSoundOrigin
+
+Pick a point on the portal to serve as the virtual sound origin
+===================
+*/
+static idVec3 PortalSoundOrigin( const exitPortal_t &re, const idVec3 &soundOrigin, const idVec3 &listenerQU ) {
+#if 1
+	idVec3	source;
+
+	idPlane	pl;
+	re.w->GetPlane( pl );
+
+	float	scale;
+	idVec3	dir = listenerQU - soundOrigin;
+	if ( !pl.RayIntersection( soundOrigin, dir, scale ) ) {
+		source = re.w->GetCenter();
+	} else {
+		source = soundOrigin + scale * dir;
+
+		// if this point isn't inside the portal edges, slide it in
+		for ( int i = 0 ; i < re.w->GetNumPoints() ; i++ ) {
+			int j = ( i + 1 ) % re.w->GetNumPoints();
+			idVec3	edgeDir = (*(re.w))[j].ToVec3() - (*(re.w))[i].ToVec3();
+			idVec3	edgeNormal;
+
+			edgeNormal.Cross( pl.Normal(), edgeDir );
+
+			idVec3	fromVert = source - (*(re.w))[j].ToVec3();
+
+			float	d = edgeNormal * fromVert;
+			if ( d > 0 ) {
+				// move it in
+				float div = edgeNormal.Normalize();
+				d /= div;
+
+				source -= d * edgeNormal;
+			}
+		}
+	}
+#else
+	// clip the ray from the listener to the center of the portal by
+	// all the portal edge planes, then project that point (or the original if not clipped)
+	// onto the portal plane to get the spatialized origin
+
+	idVec3	start = listenerQU;
+	idVec3	mid = re.w->GetCenter();
+	bool	wasClipped = false;
+
+	for ( int i = 0 ; i < re.w->GetNumPoints() ; i++ ) {
+		int j = ( i + 1 ) % re.w->GetNumPoints();
+		idVec3	v1 = (*(re.w))[j].ToVec3() - soundOrigin;
+		idVec3	v2 = (*(re.w))[i].ToVec3() - soundOrigin;
+
+		v1.Normalize();
+		v2.Normalize();
+
+		idVec3	edgeNormal;
+
+		edgeNormal.Cross( v1, v2 );
+
+		idVec3	fromVert = start - soundOrigin;
+		float	d1 = edgeNormal * fromVert;
+
+		if ( d1 > 0.0f ) {
+			fromVert = mid - (*(re.w))[j].ToVec3();
+			float d2 = edgeNormal * fromVert;
+
+			// move it in
+			float	f = d1 / ( d1 - d2 );
+
+			idVec3	clipped = start * ( 1.0f - f ) + mid * f;
+			start = clipped;
+			wasClipped = true;
+		}
+	}
+
+	idVec3	source;
+	if ( wasClipped ) {
+		// now project it onto the portal plane
+		idPlane	pl;
+		re.w->GetPlane( pl );
+
+		float	f1 = pl.Distance( start );
+		float	f2 = pl.Distance( soundOrigin );
+
+		float	f = f1 / ( f1 - f2 );
+		source = start * ( 1.0f - f ) + soundOrigin * f;
+	} else {
+		source = soundOrigin;
+	}
+#endif
+
+	return source;
+}
+
 /*
 ===================
 idSoundWorldLocal::ResolveOrigin
@@ -803,11 +1075,11 @@ def->distance is the distance we are trying to reduce.
 
 If there is no path through open portals from the sound to the listener, def->distance will remain
 set at maxDistance
+
+If path is given, the chain of portals that gave the shortest distance is stored in it
 ===================
 */
-static const int MAX_PORTAL_TRACE_DEPTH = 10;
-
-void idSoundWorldLocal::ResolveOrigin( const int stackDepth, const soundPortalTrace_t *prevStack, const int soundArea, const float dist, const idVec3& soundOrigin, idSoundEmitterLocal *def ) {
+void idSoundWorldLocal::ResolveOrigin( const int stackDepth, const soundPortalTrace_t *prevStack, const int soundArea, const float dist, const idVec3& soundOrigin, idSoundEmitterLocal *def, soundPortalPath_t *path ) {
 
 	if ( dist >= def->distance ) {
 		// we can't possibly hear the sound through this chain of portals
@@ -819,6 +1091,16 @@ void idSoundWorldLocal::ResolveOrigin( const int stackDepth, const soundPortalTr
 		if ( fullDist < def->distance ) {
 			def->distance = fullDist;
 			def->spatializedOrigin = soundOrigin;
+			if ( path ) {
+				// the stack runs from the listener back to the sound
+				path->numHops = stackDepth;
+				int hop = stackDepth;
+				for ( const soundPortalTrace_t *trace = prevStack; trace; trace = trace->prevStack ) {
+					hop--;
+					path->areas[hop] = trace->portalArea;
+					path->portals[hop] = trace->portal;
+				}
+			}
 		}
 		return;
 	}
@@ -835,6 +1117,7 @@ void idSoundWorldLocal::ResolveOrigin( const int stackDepth, const soundPortalTr
 	int numPortals = rw->NumPortalsInArea( soundArea );
 	for( int p = 0; p < numPortals; p++ ) {
 		exitPortal_t re = rw->GetPortal( soundArea, p );
+		newStack.portal = p;
 
 		float	occlusionDistance = 0;
 
@@ -863,99 +1146,214 @@ void idSoundWorldLocal::ResolveOrigin( const int stackDepth, const soundPortalTr
 		}
 
 		// pick a point on the portal to serve as our virtual sound origin
-#if 1
-		idVec3	source;
+		idVec3	source = PortalSoundOrigin( re, soundOrigin, listenerQU );
 
-		idPlane	pl;
-		re.w->GetPlane( pl );
+		idVec3 tlen = source - soundOrigin;
+		float tlenLength = tlen.LengthFast();
 
-		float	scale;
-		idVec3	dir = listenerQU - soundOrigin;
-		if ( !pl.RayIntersection( soundOrigin, dir, scale ) ) {
-			source = re.w->GetCenter();
-		} else {
-			source = soundOrigin + scale * dir;
+		ResolveOrigin( stackDepth+1, &newStack, otherArea, dist+tlenLength+occlusionDistance, source, def, path );
+	}
+}
+
+/*
+===================
+idSoundWorldLocal::ResolveCachedOrigin
 
-			// if this point isn't inside the portal edges, slide it in
-			for ( int i = 0 ; i < re.w->GetNumPoints() ; i++ ) {
-				int j = ( i + 1 ) % re.w->GetNumPoints();
-				idVec3	edgeDir = (*(re.w))[j].ToVec3() - (*(re.w))[i].ToVec3();
-				idVec3	edgeNormal;
+ResolveOrigin from the sound area, but the portal chain it finds is kept in the emitter.
+Until the listener changes area, a portal changes state, the map changes or the emitter
+or listener moves more than PORTAL_PATH_MOVE_DISTANCE, later calls only walk the cached
+chain with the current sound and listener positions, which is what static emitters spend
+most of their time doing.
+  this is called by the main thread
+===================
+*/
+void idSoundWorldLocal::ResolveCachedOrigin( const int soundArea, const idVec3& soundOrigin, idSoundEmitterLocal *def ) {
+	if ( !idSoundSystemLocal::s_cachePortalPaths.GetBool() ) {
+		ResolveOrigin( 0, NULL, soundArea, 0.0f, soundOrigin, def );
+		return;
+	}
 
-				edgeNormal.Cross( pl.Normal(), edgeDir );
+	int stateCount = rw->GetPortalStateCount();
+	if ( listenerArea != portalPathListenerArea || stateCount != portalPathStateCount ) {
+		portalPathStamp++;
+		portalPathListenerArea = listenerArea;
+		portalPathStateCount = stateCount;
+	}
+
+	soundPortalPath_t &path = def->portalPath;
+
+	// the shortest chain depends on where in their areas the sound and listener are,
+	// and one that wasn't found within a shorter maxDistance may exist now
+	if ( path.stamp != portalPathStamp || path.soundArea != soundArea
+			|| ( soundOrigin - path.soundOrigin ).LengthSqr() > Square( PORTAL_PATH_MOVE_DISTANCE )
+			|| ( listenerQU - path.listenerQU ).LengthSqr() > Square( PORTAL_PATH_MOVE_DISTANCE )
+			|| ( path.numHops < 0 && def->distance > path.searchDistance ) ) {
+		path.stamp = portalPathStamp;
+		path.soundArea = soundArea;
+		path.soundOrigin = soundOrigin;
+		path.listenerQU = listenerQU;
+		path.searchDistance = def->distance;
+		path.numHops = -1;
+		ResolveOrigin( 0, NULL, soundArea, 0.0f, soundOrigin, def, &path );
+		return;
+	}
 
-				idVec3	fromVert = source - (*(re.w))[j].ToVec3();
+	if ( path.numHops < 0 ) {
+		// def->distance stays at maxDistance
+		return;
+	}
 
-				float	d = edgeNormal * fromVert;
-				if ( d > 0 ) {
-					// move it in
-					float div = edgeNormal.Normalize();
-					d /= div;
+	idVec3	origin = soundOrigin;
+	float	dist = 0.0f;
+	for ( int hop = 0; hop < path.numHops; hop++ ) {
+		exitPortal_t re = rw->GetPortal( path.areas[hop], path.portals[hop] );
 
-					source -= d * edgeNormal;
-				}
-			}
+		if ( re.blockingBits & ( PS_BLOCK_VIEW | PS_BLOCK_AIR ) ) {
+			dist += idSoundSystemLocal::s_doorDistanceAdd.GetFloat();
 		}
-#else
-		// clip the ray from the listener to the center of the portal by
-		// all the portal edge planes, then project that point (or the original if not clipped)
-		// onto the portal plane to get the spatialized origin
 
-		idVec3	start = listenerQU;
-		idVec3	mid = re.w->GetCenter();
-		bool	wasClipped = false;
+		idVec3	source = PortalSoundOrigin( re, origin, listenerQU );
+		dist += ( source - origin ).LengthFast();
+		origin = source;
+	}
 
-		for ( int i = 0 ; i < re.w->GetNumPoints() ; i++ ) {
-			int j = ( i + 1 ) % re.w->GetNumPoints();
-			idVec3	v1 = (*(re.w))[j].ToVec3() - soundOrigin;
-			idVec3	v2 = (*(re.w))[i].ToVec3() - soundOrigin;
+	float	fullDist = dist + ( origin - listenerQU ).LengthFast();
+	if ( fullDist < def->distance ) {
+		def->distance = fullDist;
+		def->spatializedOrigin = origin;
+	}
+}
 
-			v1.Normalize();
-			v2.Normalize();
 
-			idVec3	edgeNormal;
+/*
+===================
+idSoundWorldLocal::LinkEmitter
 
-			edgeNormal.Cross( v1, v2 );
+puts the emitter into the bucket of the area its origin is in, called whenever the origin changes
+===================
+*/
+void idSoundWorldLocal::LinkEmitter( idSoundEmitterLocal *def ) {
+	int area = -1;
 
-			idVec3	fromVert = start - soundOrigin;
-			float	d1 = edgeNormal * fromVert;
+	if ( rw ) {
+		area = rw->PointInArea( def->origin );
+		if ( area == -1 ) {
+			// slid out of the world, Spatialize keeps using the last valid area
+			area = def->lastValidPortalArea;
+		}
+	}
 
-			if ( d1 > 0.0f ) {
-				fromVert = mid - (*(re.w))[j].ToVec3();
-				float d2 = edgeNormal * fromVert;
+	int bucket = area + 1;
+	if ( bucket >= areaEmitters.Num() ) {
+		// the buckets are rebuilt on the next ForegroundUpdate
+		bucket = 0;
+	}
+	if ( bucket == def->areaBucket ) {
+		return;
+	}
 
-				// move it in
-				float	f = d1 / ( d1 - d2 );
+	UnlinkEmitter( def );
 
-				idVec3	clipped = start * ( 1.0f - f ) + mid * f;
-				start = clipped;
-				wasClipped = true;
-			}
-		}
+	if ( bucket < areaEmitters.Num() ) {
+		areaEmitters[bucket].Append( def );
+		def->areaBucket = bucket;
+	}
+}
 
-		idVec3	source;
-		if ( wasClipped ) {
-			// now project it onto the portal plane
-			idPlane	pl;
-			re.w->GetPlane( pl );
+/*
+===================
+idSoundWorldLocal::UnlinkEmitter
+===================
+*/
+void idSoundWorldLocal::UnlinkEmitter( idSoundEmitterLocal *def ) {
+	if ( def->areaBucket >= 0 && def->areaBucket < areaEmitters.Num() ) {
+		areaEmitters[def->areaBucket].Remove( def );
+	}
+	def->areaBucket = -1;
+}
 
-			float	f1 = pl.Distance( start );
-			float	f2 = pl.Distance( soundOrigin );
+/*
+===================
+idSoundWorldLocal::RelinkAllEmitters
 
-			float	f = f1 / ( f1 - f2 );
-			source = start * ( 1.0f - f ) + soundOrigin * f;
-		} else {
-			source = soundOrigin;
+sizes the buckets for the areas of the current render world and links all live emitters
+===================
+*/
+void idSoundWorldLocal::RelinkAllEmitters( void ) {
+	int numAreas = rw ? rw->NumAreas() : 0;
+
+	areaEmitters.Clear();
+	areaEmitters.SetNum( numAreas + 1 );
+	areaReachCount.AssureSize( numAreas, 0 );
+	areaReachCount.SetNum( numAreas, false );
+	reachableAreas.SetNum( 0, false );
+
+	// the area numbers may belong to a different map now
+	portalPathStamp++;
+
+	for ( int i = 1; i < emitters.Num(); i++ ) {
+		idSoundEmitterLocal *def = emitters[i];
+
+		def->areaBucket = -1;
+		if ( def->removeStatus < REMOVE_STATUS_SAMPLEFINISHED ) {
+			LinkEmitter( def );
 		}
-#endif
+	}
+}
 
-		idVec3 tlen = source - soundOrigin;
-		float tlenLength = tlen.LengthFast();
+/*
+===================
+idSoundWorldLocal::FindReachableAreas
+
+Breadth first walk from the listener area through all portals, open or closed, as deep
+as ResolveOrigin traces.  Emitters in any other area can't be heard through portals.
+===================
+*/
+void idSoundWorldLocal::FindReachableAreas( void ) {
+	reachCount++;
+	reachableAreas.SetNum( 0, false );
 
-		ResolveOrigin( stackDepth+1, &newStack, otherArea, dist+tlenLength+occlusionDistance, source, def );
+	if ( !rw || listenerArea < 0 || listenerArea >= areaReachCount.Num() ) {
+		return;
+	}
+
+	areaReachCount[listenerArea] = reachCount;
+	reachableAreas.Append( listenerArea );
+
+	int first = 0;
+	for ( int depth = 0; depth < MAX_PORTAL_TRACE_DEPTH && first < reachableAreas.Num(); depth++ ) {
+		int last = reachableAreas.Num();
+
+		for ( ; first < last; first++ ) {
+			int area = reachableAreas[first];
+			int numPortals = rw->NumPortalsInArea( area );
+
+			for ( int p = 0; p < numPortals; p++ ) {
+				exitPortal_t re = rw->GetPortal( area, p );
+				int otherArea = ( re.areas[0] == area ) ? re.areas[1] : re.areas[0];
+
+				if ( areaReachCount[otherArea] != reachCount ) {
+					areaReachCount[otherArea] = reachCount;
+					reachableAreas.Append( otherArea );
+				}
+			}
+		}
 	}
 }
 
+/*
+===================
+idSoundWorldLocal::IsAreaReachable
+
+areas the last FindReachableAreas didn't know about are assumed reachable
+===================
+*/
+bool idSoundWorldLocal::IsAreaReachable( int area ) const {
+	if ( area < 0 || area >= areaReachCount.Num() ) {
+		return true;
+	}
+	return areaReachCount[area] == reachCount;
+}
 
 /*
 ===================
@@ -1040,18 +1438,23 @@ void idSoundWorldLocal::ForegroundUpdate( int current44kHzTime ) {
 		return;
 	}
 
-	Sys_EnterCriticalSection();
+	// CheckForCompletion takes the lock the mixer holds itself, the OpenAL side of
+	// finished channels is handed to the async update through soundSystemLocal.soundCommands
 
 	// if we are recording an AVI demo, don't use hardware time
 	if ( fpa[0] ) {
 		current44kHzTime = lastAVI44kHz;
 	}
 
+	if ( areaEmitters.Num() != ( rw ? rw->NumAreas() : 0 ) + 1 ) {
+		// first update or a new map in the render world
+		RelinkAllEmitters();
+	}
+	FindReachableAreas();
+
 	//
-	// check to see if each sound is visible or not
-	// speed up by checking maxdistance to origin
-	// although the sound may still need to play if it has
-	// just become occluded so it can ramp down to 0
+	// completion checks are cheap and have to run for every emitter, so one
+	// shot sounds far away still free their channels in time
 	//
 	for ( j = 1; j < emitters.Num(); j++ ) {
 		def = emitters[j];
@@ -1063,60 +1466,86 @@ void idSoundWorldLocal::ForegroundUpdate( int current44kHzTime ) {
 		// see if our last channel just finished
 		def->CheckForCompletion( current44kHzTime );
 
+		def->outOfReach = false;
 		if ( !def->playing ) {
 			continue;
 		}
 
-		// update virtual origin / distance, etc
-		def->Spatialize( listenerPos, listenerArea, rw );
+		// emitters in areas the listener can't reach through portals are only heard
+		// if they have channels that don't care about portals
+		if ( def->areaBucket > 0 && !IsAreaReachable( def->areaBucket - 1 ) ) {
+			def->outOfReach = !def->IgnoresPortals();
+			if ( !def->outOfReach ) {
+				def->Spatialize( listenerPos, listenerArea, rw );
+			}
+		}
+	}
+
+	//
+	// check to see if each sound in a reachable area is visible or not
+	// speed up by checking maxdistance to origin
+	// although the sound may still need to play if it has
+	// just become occluded so it can ramp down to 0
+	//
+	for ( int a = -1; a < reachableAreas.Num(); a++ ) {
+		const idList<idSoundEmitterLocal *> &bucket = areaEmitters[ ( a < 0 ) ? 0 : reachableAreas[a] + 1 ];
 
-		// per-sound debug options
-		if ( idSoundSystemLocal::s_drawSounds.GetInteger() && rw ) {
-			if ( def->distance < def->maxDistance || idSoundSystemLocal::s_drawSounds.GetInteger() > 1 ) {
-				idBounds ref;
-				ref.Clear();
-				ref.AddPoint( idVec3( -10, -10, -10 ) );
-				ref.AddPoint( idVec3(  10,  10,  10 ) );
-				float vis = (1.0f - (def->distance / def->maxDistance));
+		for ( int b = 0; b < bucket.Num(); b++ ) {
+			def = bucket[b];
 
-				// draw a box
-				rw->DebugBounds( idVec4( vis, 0.25f, vis, vis ), ref, def->origin );
+			if ( def->removeStatus >= REMOVE_STATUS_SAMPLEFINISHED || !def->playing ) {
+				continue;
+			}
 
-				// draw an arrow to the audible position, possible a portal center
-				if ( def->origin != def->spatializedOrigin ) {
-					rw->DebugArrow( colorRed, def->origin, def->spatializedOrigin, 4 );
-				}
+			// update virtual origin / distance, etc
+			def->Spatialize( listenerPos, listenerArea, rw );
 
-				// draw the index
-				idVec3	textPos = def->origin;
-				textPos[2] -= 8;
-				rw->DrawText( va("%i", def->index), textPos, 0.1f, idVec4(1,0,0,1), listenerAxis );
-				textPos[2] += 8;
+			// per-sound debug options
+			if ( idSoundSystemLocal::s_drawSounds.GetInteger() && rw ) {
+				if ( def->distance < def->maxDistance || idSoundSystemLocal::s_drawSounds.GetInteger() > 1 ) {
+					idBounds ref;
+					ref.Clear();
+					ref.AddPoint( idVec3( -10, -10, -10 ) );
+					ref.AddPoint( idVec3(  10,  10,  10 ) );
+					float vis = (1.0f - (def->distance / def->maxDistance));
 
-				// run through all the channels
-				for ( k = 0; k < SOUND_MAX_CHANNELS ; k++ ) {
-					idSoundChannel	*chan = &def->channels[k];
+					// draw a box
+					rw->DebugBounds( idVec4( vis, 0.25f, vis, vis ), ref, def->origin );
 
-					// see if we have a sound triggered on this channel
-					if ( !chan->triggerState ) {
-						continue;
+					// draw an arrow to the audible position, possible a portal center
+					if ( def->origin != def->spatializedOrigin ) {
+						rw->DebugArrow( colorRed, def->origin, def->spatializedOrigin, 4 );
 					}
 
-					char	text[1024];
-					float	min = chan->parms.minDistance;
-					float	max = chan->parms.maxDistance;
-					const char	*defaulted = chan->leadinSample->defaultSound ? "(DEFAULTED)" : "";
-					sprintf( text, "%s (%i/%i %i/%i)%s", chan->soundShader->GetName(), (int)def->distance,
-						(int)def->realDistance, (int)min, (int)max, defaulted );
-					rw->DrawText( text, textPos, 0.1f, idVec4(1,0,0,1), listenerAxis );
+					// draw the index
+					idVec3	textPos = def->origin;
+					textPos[2] -= 8;
+					rw->DrawText( va("%i", def->index), textPos, 0.1f, idVec4(1,0,0,1), listenerAxis );
 					textPos[2] += 8;
+
+					// run through all the channels
+					for ( k = 0; k < SOUND_MAX_CHANNELS ; k++ ) {
+						idSoundChannel	*chan = &def->channels[k];
+
+						// see if we have a sound triggered on this channel
+						if ( !chan->triggerState ) {
+							continue;
+						}
+
+						char	text[1024];
+						float	min = chan->parms.minDistance;
+						float	max = chan->parms.maxDistance;
+						const char	*defaulted = chan->leadinSample->defaultSound ? "(DEFAULTED)" : "";
+						sprintf( text, "%s (%i/%i %i/%i)%s", chan->soundShader->GetName(), (int)def->distance,
+							(int)def->realDistance, (int)min, (int)max, defaulted );
+						rw->DrawText( text, textPos, 0.1f, idVec4(1,0,0,1), listenerAxis );
+						textPos[2] += 8;
+					}
 				}
 			}
 		}
 	}
 
-	Sys_LeaveCriticalSection();
-
 	//
 	// the sound meter
 	//
@@ -1419,6 +1848,9 @@ void idSoundWorldLocal::ReadFromSaveGame( idFile *savefile ) {
 		slowmoSpeed			= 0;
 		enviroSuitActive	= false;
 	}
+
+	// the origins were read directly
+	RelinkAllEmitters();
 }
 
 /*
@@ -1841,6 +2273,16 @@ void idSoundWorldLocal::AddChannelContribution( idSoundEmitterLocal *sound, idSo
 	float inputSamples[MIXBUFFER_SAMPLES*2+16];
 	float *alignedInputSamples = (float *) ( ( ( (intptr_t)inputSamples ) + 15 ) & ~15 );
 
+	// a channel that was virtual continues at the position it has reached by now
+	int seekOffset = 0;
+	if ( chan->seekOnTrigger && chan->triggered ) {
+		chan->seekOnTrigger = false;
+		if ( offset > 0 ) {
+			seekOffset = offset & ~7;		// whole frames for the 22kHz and 11kHz expansions
+		}
+		chan->openalStreamingOffset = seekOffset;
+	}
+
 	//
 	// allocate and initialize hardware source
 	//
@@ -1893,7 +2335,21 @@ void idSoundWorldLocal::AddChannelContribution( idSoundEmitterLocal *sound, idSo
 				// DG: ... that have no leadin (with leadin we still need to switch to another sound,
 				//     just use streaming code for that) - see https://github.com/dhewm/dhewm3/issues/291
 				if ( chan->triggered ) {
-					alSourcei( chan->openalSource, AL_BUFFER, looping ? chan->soundShader->entries[0]->openalBuffer : chan->leadinSample->openalBuffer );
+					idSoundSample *hwSample = looping ? chan->soundShader->entries[0] : chan->leadinSample;
+					alSourcei( chan->openalSource, AL_BUFFER, hwSample->openalBuffer );
+					if ( seekOffset > 0 ) {
+						int frames = hwSample->objectSize / hwSample->objectInfo.nChannels;
+						int seek = idMath::FtoiFast( seekOffset * ( hwSample->objectInfo.nSamplesPerSec / (float)PRIMARYFREQ ) );
+						if ( looping && frames > 0 ) {
+							seek %= frames;
+						}
+						if ( seek < frames ) {
+							alSourcei( chan->openalSource, AL_SAMPLE_OFFSET, seek );
+						} else {
+							// it ended while virtual, CheckForCompletion will stop the channel
+							chan->triggered = false;
+						}
+					}
 				}
 			} else {
 				ALint finishedbuffers;
@@ -1920,7 +2376,11 @@ void idSoundWorldLocal::AddChannelContribution( idSoundEmitterLocal *sound, idSo
 				}
 
 				for ( j = 0; j < finishedbuffers; j++ ) {
-					chan->GatherChannelSamples( chan->openalStreamingOffset * sample->objectInfo.nChannels, MIXBUFFER_SAMPLES * sample->objectInfo.nChannels, alignedInputSamples );
+					int streamOffset = chan->openalStreamingOffset * sample->objectInfo.nChannels;
+					int streamCount = MIXBUFFER_SAMPLES * sample->objectInfo.nChannels;
+					if ( !soundSystemLocal.soundStreams.Read( chan, streamOffset, streamCount, alignedInputSamples ) ) {
+						chan->GatherChannelSamples( streamOffset, streamCount, alignedInputSamples );
+					}
 					for ( int i = 0; i < ( MIXBUFFER_SAMPLES * sample->objectInfo.nChannels ); i++ ) {
 						if ( alignedInputSamples[i] < -32768.0f )
 							((short *)alignedInputSamples)[i] = -32768;
@@ -79,27 +79,46 @@ static inline void CPUid(int index, int *a, int *b, int *c, int *d) {
 		"xchg %%" REG_b ", %%" REG_S
 		:	"=a" (*a), "=S" (*b),
 			"=c" (*c), "=d" (*d)
-		: "0" (index));
+		: "0" (index), "2" (0));
+}
+
+static inline unsigned int GetXCR0() {
+	unsigned int a, d;
+
+	__asm__ volatile ( "xgetbv" : "=a" (a), "=d" (d) : "c" (0) );
+
+	return a;
 }
 #elif defined(_MSC_VER)
 #include <intrin.h>
 static inline void CPUid(int index, int *a, int *b, int *c, int *d) {
 	int info[4] = { };
 
-	// VS2005 and up
-	__cpuid(info, index);
+	// VS2008 SP1 and up, sub-leaf 0 for the extended feature leaf
+	__cpuidex(info, index, 0);
 
 	*a = info[0];
 	*b = info[1];
 	*c = info[2];
 	*d = info[3];
 }
+
+static inline unsigned int GetXCR0() {
+	// VS2010 SP1 and up
+	return (unsigned int)_xgetbv(0);
+}
 #else
 #error unsupported compiler
 #endif
 
 #define c_SSE3		(1 << 0)
+#define c_FMA		(1 << 12)
+#define c_OSXSAVE	(1 << 27)
+#define c_AVX		(1 << 28)
+#define b_AVX2		(1 << 5)
 #define d_FXSAVE	(1 << 24)
+#define xcr0_SSE	(1 << 1)
+#define xcr0_AVX	(1 << 2)
 
 static inline bool HasDAZ() {
 	int a, b, c, d;
@@ -125,6 +144,27 @@ static inline bool HasSSE3() {
 	return (c & c_SSE3) == c_SSE3;
 }
 
+static inline bool HasAVX2() {
+	int a, b, c, d;
+
+	CPUid(0, &a, &b, &c, &d);
+	if (a < 7)
+		return false;
+
+	CPUid(1, &a, &b, &c, &d);
+
+	if ((c & (c_FMA | c_OSXSAVE | c_AVX)) != (c_FMA | c_OSXSAVE | c_AVX))
+		return false;
+
+	// the OS has to save the upper halves of the ymm registers
+	if ((GetXCR0() & (xcr0_SSE | xcr0_AVX)) != (xcr0_SSE | xcr0_AVX))
+		return false;
+
+	CPUid(7, &a, &b, &c, &d);
+
+	return (b & b_AVX2) == b_AVX2;
+}
+
 #define MXCSR_DAZ	(1 << 6)
 #define MXCSR_FTZ	(1 << 15)
 
@@ -211,6 +251,9 @@ int Sys_GetProcessorId( void ) {
 	// there is no SDL_HasSSE3() in SDL 1.2
 	if (HasSSE3())
 		flags |= CPUID_SSE3;
+
+	if (HasAVX2())
+		flags |= CPUID_AVX2;
 #endif
 
 	return flags;
@@ -276,6 +276,7 @@ bulk of the codebase, so it is the best place for analyze pragmas.
 #include <limits>
 #include <chrono>
 #include <thread>
+#include <atomic>
 #include <algorithm>
 
 #ifdef _WIN32
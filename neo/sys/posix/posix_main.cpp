@@ -376,6 +376,25 @@ ID_TIME_T Sys_FileTimeStamp(FILE * fp) {
 	return st.st_mtime;
 }
 
+const void *Sys_MapFile(FILE *fp, int length) {
+	static long pageSize = sysconf(_SC_PAGESIZE);
+
+	// the rest of the last page reads as zeros, but a page past the end can't be read at all
+	if (length <= 0 || pageSize <= 0 || (length % pageSize) == 0) {
+		return NULL;
+	}
+
+	void *buffer = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+	if (buffer == MAP_FAILED) {
+		return NULL;
+	}
+	return buffer;
+}
+
+void Sys_UnmapFile(const void *buffer, int length) {
+	munmap(const_cast<void *>(buffer), length);
+}
+
 char *Sys_GetClipboardData(void) {
 #if SDL_VERSION_ATLEAST(2, 0, 0)
 	return SDL_GetClipboardText();
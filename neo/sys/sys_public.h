@@ -39,6 +39,7 @@ typedef enum {
 	CPUID_SSE							= 0x00040,	// Streaming SIMD Extensions
 	CPUID_SSE2							= 0x00080,	// Streaming SIMD Extensions 2
 	CPUID_SSE3							= 0x00100,	// Streaming SIMD Extentions 3 aka Prescott's New Instructions
+	CPUID_AVX2							= 0x00200,	// Advanced Vector Extensions 2 with Fused Multiply-Add, enabled by the OS
 } cpuidSimd_t;
 
 typedef enum {
@@ -262,6 +263,10 @@ void			Sys_ShowConsole( int visLevel, bool quitOnClose );
 
 void			Sys_Mkdir( const char *path );
 ID_TIME_T			Sys_FileTimeStamp( FILE *fp );
+// maps length bytes of a file read-only, returns NULL if the file can't be mapped or
+// ends on a page boundary, so the byte after the mapped file is always a readable 0
+const void *	Sys_MapFile( FILE *fp, int length );
+void			Sys_UnmapFile( const void *buffer, int length );
 // NOTE: do we need to guarantee the same output on all platforms?
 const char *	Sys_TimeStampToStr( ID_TIME_T timeStamp );
 
@@ -311,6 +311,42 @@ ID_TIME_T Sys_FileTimeStamp( FILE *fp ) {
 	return (long) st.st_mtime;
 }
 
+/*
+=================
+Sys_MapFile
+=================
+*/
+const void *Sys_MapFile( FILE *fp, int length ) {
+	SYSTEM_INFO info;
+
+	GetSystemInfo( &info );
+
+	// the rest of the last page reads as zeros, but a page past the end can't be read at all
+	if ( length <= 0 || ( length % info.dwPageSize ) == 0 ) {
+		return NULL;
+	}
+
+	HANDLE mapping = CreateFileMapping( (HANDLE)_get_osfhandle( _fileno( fp ) ), NULL, PAGE_READONLY, 0, 0, NULL );
+	if ( mapping == NULL ) {
+		return NULL;
+	}
+
+	// the view keeps the mapping alive
+	const void *buffer = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, length );
+	CloseHandle( mapping );
+
+	return buffer;
+}
+
+/*
+=================
+Sys_UnmapFile
+=================
+*/
+void Sys_UnmapFile( const void *buffer, int length ) {
+	UnmapViewOfFile( buffer );
+}
+
 /*
 =================
 Sys_IsFile